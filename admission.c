@@ -0,0 +1,103 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <limits.h>
+// User-defined header files
+#include "admission.h"
+#include "types.h"
+
+// Budgets of the current process, no budget until --max-mem / --max-bytes
+AdmissionInfo admission;
+
+/* Function Definitions */
+
+// Function to read a budget: bytes, optionally with K, M or G
+Status parse_admission_size(const char *arg, long *value)
+{
+    char *end;
+    int shift = 0;
+    errno = 0;
+    long size = strtol(arg, &end, 10);
+
+    if(end == arg || size < 0 || errno == ERANGE)
+    {
+        return e_failure;
+    }
+    switch(*end)
+    {
+        case 'G': shift += 10; /* fall through */
+        case 'M': shift += 10; /* fall through */
+        case 'K': shift += 10; end++; break;
+        case '\0': break;
+        default: return e_failure;
+    }
+    // The suffix must end the value, and the bytes must fit a long
+    if(*end != '\0' || size > (LONG_MAX >> shift))
+    {
+        return e_failure;
+    }
+    *value = size << shift;
+    return e_success;
+}
+
+// Function to find the image bytes between the current position and the end of the image
+long get_remaining_image_bytes(FILE *fptr_image)
+{
+    long pos = ftell(fptr_image);
+    fseek(fptr_image, 0, SEEK_END);
+    long remaining = ftell(fptr_image) - pos;
+    fseek(fptr_image, pos, SEEK_SET);
+    return remaining < 0 ? 0 : remaining;
+}
+
+// Function to check an extension size, right after it was decoded
+Status admit_extn_size(long extn_size, FILE *fptr_image)
+{
+    // Extension bytes and the 32 image bytes of the size field must still be in the image
+    if(extn_size <= 0 || extn_size > MAX_DECODE_EXTN_SIZE || extn_size * 8 + 32 > get_remaining_image_bytes(fptr_image))
+    {
+        printf("INFO: The extension size %ld is corrupted!\n\n", extn_size);
+        return e_failure;
+    }
+    return e_success;
+}
+
+// Function to check a secret size, right after it was decoded
+Status admit_secret_size(long size, FILE *fptr_image)
+{
+    if(size < 0 || size > get_remaining_image_bytes(fptr_image) / 8)
+    {
+        printf("INFO: The secret size %ld does not fit the image!\n\n", size);
+        return e_failure;
+    }
+    return e_success;
+}
+
+// Function to check the secret bytes to be decoded against the byte budget
+Status admit_output_bytes(long size)
+{
+    if(admission.max_bytes && size > admission.max_bytes)
+    {
+        printf("INFO: %ld secret bytes exceed the budget of %ld (--max-bytes)!\n\n", size, admission.max_bytes);
+        return e_failure;
+    }
+    return e_success;
+}
+
+// Function to count a header driven allocation against the memory budget
+Status admit_allocation(long size)
+{
+    if(admission.max_mem && admission.mem_used + size > admission.max_mem)
+    {
+        printf("INFO: Allocating %ld bytes exceeds the budget of %ld (--max-mem)!\n\n", size, admission.max_mem);
+        return e_failure;
+    }
+    admission.mem_used += size;
+    return e_success;
+}
+
+// Function to start the budgets of a new job
+void reset_admission(void)
+{
+    admission.mem_used = 0;
+}
@@ -0,0 +1,53 @@
+#ifndef ADMISSION_H
+#define ADMISSION_H
+
+#include <stdio.h>
+#include "types.h" // Contains user defined types
+
+/*
+ * Admission control for header fields decoded from untrusted images
+ *
+ * Every field is checked against fixed limits and the image bytes left
+ * in the carrier before anything is allocated or any output is created.
+ * --max-mem and --max-bytes add per job budgets on header driven
+ * allocations and on decoded secret bytes (0 means no budget)
+ */
+
+#define MAX_DECODE_EXTN_SIZE 32         // Longest extension accepted from an image
+
+typedef struct _AdmissionInfo
+{
+    long max_mem;               // Bytes a job may allocate from header fields (--max-mem)
+    long max_bytes;             // Secret bytes a job may decode (--max-bytes)
+    long mem_used;              // Bytes allocated from header fields so far
+
+} AdmissionInfo;  // Datatype of the structure
+
+/* Budgets of the current process, set once from the command line */
+extern AdmissionInfo admission;
+
+
+/* Admission function prototype */
+
+/* Read a budget: bytes, optionally with K, M or G */
+Status parse_admission_size(const char *arg, long *value);
+
+/* Image bytes between the current position and the end of the image */
+long get_remaining_image_bytes(FILE *fptr_image);
+
+/* Extension size must be 1 to MAX_DECODE_EXTN_SIZE, and its bytes and the size field must fit the image */
+Status admit_extn_size(long extn_size, FILE *fptr_image);
+
+/* Secret size must fit the image bytes left */
+Status admit_secret_size(long size, FILE *fptr_image);
+
+/* Decoding this many secret bytes must fit the byte budget */
+Status admit_output_bytes(long size);
+
+/* Allocating this many bytes for a header field must fit the memory budget */
+Status admit_allocation(long size);
+
+/* Start the budgets of a new job */
+void reset_admission(void);
+
+#endif
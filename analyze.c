@@ -0,0 +1,252 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <pthread.h>
+// User-defined header files
+#include "analyze.h"
+#include "encode.h"
+#include "types.h"
+
+/* Function Definitions */
+
+// Function to read and validate command line arguments entered by user after -s
+Status read_and_validate_analyze_args(int argc, char *argv[], AnalyzeInfo *anaInfo)
+{
+    int first = 2;
+
+    // STEP1: Optional --threads N before the images, default one per image up to the limit
+    anaInfo->threads = 0;
+    if(argc > 3 && strcmp(argv[2], "--threads") == 0)
+    {
+        anaInfo->threads = atoi(argv[3]);
+        if(anaInfo->threads <= 0 || anaInfo->threads > ANALYZE_MAX_THREADS)
+        {
+            return e_failure;
+        }
+        first = 4;
+    }
+
+    // STEP2: Every remaining argument must be a .bmp image
+    anaInfo->image_fnames = argv + first;
+    anaInfo->image_count = argc - first;
+    if(anaInfo->image_count <= 0)
+    {
+        return e_failure;
+    }
+    for(int i = 0; i < anaInfo->image_count; i++)
+    {
+        if(strstr(anaInfo->image_fnames[i], ".bmp") == NULL)
+        {
+            return e_failure;
+        }
+    }
+    if(anaInfo->threads == 0)
+    {
+        anaInfo->threads = anaInfo->image_count < ANALYZE_MAX_THREADS ? anaInfo->image_count : ANALYZE_MAX_THREADS;
+    }
+
+    // STEP3: Allocate one result per image
+    anaInfo->results = calloc(anaInfo->image_count, sizeof(AnalyzeResult));
+    if(!anaInfo->results)
+    {
+        return e_failure;
+    }
+    return e_success;
+}
+
+// Function to add a block of pixel bytes to a histogram
+void add_to_histogram(const unsigned char *pixels, long size, unsigned long long *histogram)
+{
+    // Four sub-histograms, so consecutive equal bytes don't wait on the same counter
+    uint32_t counts[4][256];
+    long i = 0;
+
+    memset(counts, 0, sizeof(counts));
+    while(i < size)
+    {
+        // Flush before 32 bit counters could overflow
+        long end = size - i > 0x7FFFFFFF ? i + 0x7FFFFFFC : size;
+        for(; i + 4 <= end; i += 4)
+        {
+            uint32_t word;
+            memcpy(&word, pixels + i, 4);
+            counts[0][word & 0xFF]++;
+            counts[1][(word >> 8) & 0xFF]++;
+            counts[2][(word >> 16) & 0xFF]++;
+            counts[3][word >> 24]++;
+        }
+        for(; i < end; i++)
+        {
+            counts[0][pixels[i]]++;
+        }
+        for(int value = 0; value < 256; value++)
+        {
+            histogram[value] += (unsigned long long)counts[0][value] + counts[1][value] + counts[2][value] + counts[3][value];
+            counts[0][value] = counts[1][value] = counts[2][value] = counts[3][value] = 0;
+        }
+    }
+}
+
+/*
+ * Pair of values chi-square: LSB embedding of random data equalizes the
+ * counts of 2k and 2k + 1, so chi-square per degree of freedom drops to ~1
+ * Score is 1 / chi-square per degree of freedom, capped at 1
+ */
+double get_chi_square_score(const unsigned long long *histogram, double *chi_square, int *degrees)
+{
+    int pairs = 0;
+
+    *chi_square = 0;
+    for(int k = 0; k < 128; k++)
+    {
+        double expected = (histogram[2 * k] + histogram[2 * k + 1]) / 2.0;
+        if(expected > 0)
+        {
+            double diff = histogram[2 * k] - expected;
+            *chi_square += diff * diff / expected;
+            pairs++;
+        }
+    }
+    *degrees = pairs - 1;
+    if(*degrees <= 0)
+    {
+        return 0;
+    }
+
+    double ratio = *chi_square / *degrees;
+    return ratio <= 1 ? 1 : 1 / ratio;
+}
+
+// Function to analyze one image, reading its pixel array once in large sequential blocks
+Status analyze_image(const char *image_fname, AnalyzeResult *result)
+{
+    unsigned long long head_histogram[256];
+    uint offset;
+
+    // STEP1: Open the image and find the pixel array from the header
+    FILE *fptr_image = fopen(image_fname, "r");
+    if(fptr_image == NULL)
+    {
+        return e_failure;
+    }
+    posix_fadvise(fileno(fptr_image), 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    long pixel_bytes = get_image_size_for_bmp(fptr_image);
+    long file_size = get_file_size(fptr_image);
+    fseek(fptr_image, 10, SEEK_SET);
+    if(fread(&offset, sizeof(offset), 1, fptr_image) != 1 || offset < 54 || offset > file_size)
+    {
+        offset = 54;
+    }
+    if(pixel_bytes > file_size - (long)offset)
+    {
+        pixel_bytes = file_size - offset;
+    }
+    fseek(fptr_image, offset, SEEK_SET);
+
+    // STEP2: Build the histogram block by block, head window separately
+    unsigned char *pixels = malloc(ANALYZE_READ_SIZE);
+    if(!pixels)
+    {
+        fclose(fptr_image);
+        return e_failure;
+    }
+    memset(result->histogram, 0, sizeof(result->histogram));
+    memset(head_histogram, 0, sizeof(head_histogram));
+    result->pixel_bytes = 0;
+    while(result->pixel_bytes < pixel_bytes)
+    {
+        long block = pixel_bytes - result->pixel_bytes < ANALYZE_READ_SIZE ? pixel_bytes - result->pixel_bytes : ANALYZE_READ_SIZE;
+        block = fread(pixels, 1, block, fptr_image);
+        if(block <= 0)
+        {
+            break;
+        }
+        if(result->pixel_bytes < ANALYZE_HEAD_SIZE)
+        {
+            long head = ANALYZE_HEAD_SIZE - result->pixel_bytes;
+            add_to_histogram(pixels, head < block ? head : block, head_histogram);
+        }
+        add_to_histogram(pixels, block, result->histogram);
+        result->pixel_bytes += block;
+    }
+    free(pixels);
+    fclose(fptr_image);
+
+    // STEP3: LSB plane popcount is the sum of the odd values
+    result->lsb_ones = 0;
+    for(int value = 1; value < 256; value += 2)
+    {
+        result->lsb_ones += result->histogram[value];
+    }
+
+    // STEP4: Chi-square over the whole image and the head window
+    double head_chi_square;
+    int head_degrees;
+    result->score = get_chi_square_score(result->histogram, &result->chi_square, &result->degrees);
+    result->head_score = get_chi_square_score(head_histogram, &head_chi_square, &head_degrees);
+    return result->pixel_bytes > 0 ? e_success : e_failure;
+}
+
+// Worker thread, takes the next image until none are left
+static void *analyze_worker(void *arg)
+{
+    AnalyzeInfo *anaInfo = arg;
+    int i;
+
+    while((i = __atomic_fetch_add(&anaInfo->next_image, 1, __ATOMIC_RELAXED)) < anaInfo->image_count)
+    {
+        anaInfo->results[i].status = analyze_image(anaInfo->image_fnames[i], &anaInfo->results[i]);
+    }
+    return NULL;
+}
+
+// Function to analyze all images in parallel and print one line per image
+Status do_analyzing(AnalyzeInfo *anaInfo)
+{
+    pthread_t workers[ANALYZE_MAX_THREADS];
+    int started = 0;
+    Status ret = e_success;
+
+    // STEP1: --threads N counts the main thread, start N - 1 workers and work on the main thread too
+    for(int i = 0; i < anaInfo->threads - 1; i++)
+    {
+        if(pthread_create(&workers[started], NULL, analyze_worker, anaInfo) == 0)
+        {
+            started++;
+        }
+    }
+    analyze_worker(anaInfo);
+    for(int i = 0; i < started; i++)
+    {
+        pthread_join(workers[i], NULL);
+    }
+
+    // STEP2: Print the results in argument order
+    printf("%-32s %12s %7s %12s %6s %6s  %s\n", "IMAGE", "PIXEL_BYTES", "LSB_1%", "CHI2/DF", "SCORE", "HEAD", "VERDICT");
+    for(int i = 0; i < anaInfo->image_count; i++)
+    {
+        AnalyzeResult *result = &anaInfo->results[i];
+        if(result->status == e_failure)
+        {
+            printf("%-32s could not be analyzed!\n", anaInfo->image_fnames[i]);
+            ret = e_failure;
+            continue;
+        }
+        printf("%-32s %12ld %7.2f %12.2f %6.3f %6.3f  %s\n", anaInfo->image_fnames[i], result->pixel_bytes,
+               100.0 * result->lsb_ones / result->pixel_bytes,
+               result->degrees > 0 ? result->chi_square / result->degrees : 0.0,
+               result->score, result->head_score,
+               result->head_score > ANALYZE_SUSPICIOUS_SCORE || result->score > ANALYZE_SUSPICIOUS_SCORE ? "SUSPICIOUS" : "clean");
+    }
+    return ret;
+}
+
+// Function to free analyze results
+void clear_analyze_info(AnalyzeInfo *anaInfo)
+{
+    if(anaInfo->results) free(anaInfo->results);
+}
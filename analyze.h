@@ -0,0 +1,60 @@
+#ifndef ANALYZE_H
+#define ANALYZE_H
+
+#include "types.h" // Contains user defined types
+
+/*
+ * Structures to store information required for
+ * steganalysis of a batch of bmp images: LSB plane popcount,
+ * pair of values histogram and chi-square detection score
+ */
+
+#define ANALYZE_READ_SIZE (1 << 20)     // Pixel bytes read per block
+#define ANALYZE_HEAD_SIZE (1 << 16)     // Pixel bytes in the head window, LSB embedding starts there
+#define ANALYZE_MAX_THREADS 64
+#define ANALYZE_SUSPICIOUS_SCORE 0.5
+
+typedef struct _AnalyzeResult
+{
+    Status status;                      // e_failure if the image could not be read
+    long pixel_bytes;                   // Number of pixel bytes analyzed
+    long lsb_ones;                      // Popcount of the LSB plane
+    unsigned long long histogram[256];  // Histogram of byte values (pairs 2k, 2k + 1)
+    double chi_square;                  // Pair of values chi-square over the whole image
+    int degrees;                        // Degrees of freedom of chi_square
+    double score;                       // Detection score over the whole image, 0 (clean) to 1
+    double head_score;                  // Detection score over the head window
+} AnalyzeResult;
+
+typedef struct _AnalyzeInfo
+{
+    char **image_fnames;        // Images to be analyzed, points into argv
+    int image_count;            // Number of images
+    int threads;                // Number of worker threads, the main thread included (--threads N)
+    int next_image;             // Next image to be taken by a worker
+    AnalyzeResult *results;     // One result per image
+
+} AnalyzeInfo;  // Datatype of the structure
+
+
+/* Analyze function prototype */
+
+/* Read and validate analyze args from argv */
+Status read_and_validate_analyze_args(int argc, char *argv[], AnalyzeInfo *anaInfo);
+
+/* Analyze all images in parallel and print one line per image */
+Status do_analyzing(AnalyzeInfo *anaInfo);
+
+/* Analyze one image */
+Status analyze_image(const char *image_fname, AnalyzeResult *result);
+
+/* Add a block of pixel bytes to a histogram */
+void add_to_histogram(const unsigned char *pixels, long size, unsigned long long *histogram);
+
+/* Pair of values chi-square of a histogram, returns the detection score */
+double get_chi_square_score(const unsigned long long *histogram, double *chi_square, int *degrees);
+
+/* Free analyze results */
+void clear_analyze_info(AnalyzeInfo *anaInfo);
+
+#endif
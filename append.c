@@ -0,0 +1,202 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+// User-defined header files
+#include "append.h"
+#include "encode.h"
+#include "decode.h"
+#include "lsb_kernel.h"
+#include "types.h"
+#include "common.h"
+
+/* Function Definitions */
+
+// Function to read and validate command line arguments entered by user after -a
+Status read_and_validate_append_args(char *argv[], AppendInfo *appInfo)
+{
+    // STEP1: Check argv[2] is .bmp or not
+    if(strstr(argv[2], ".bmp") == NULL)
+    {
+        return e_failure;
+    }
+
+    // STEP2: Store the encoded image and the file to be appended
+    appInfo->stego_image_fname = argv[2];
+    appInfo->secret_fname = argv[3];
+    return e_success;
+}
+
+// Function to decode the existing header and find the size field and data offsets
+Status decode_append_header(AppendInfo *appInfo)
+{
+    char arr[32];
+
+    // STEP1: Find the capacity of the image
+    appInfo->image_capacity = get_image_size_for_bmp(appInfo->fptr_stego_image);
+
+    // STEP2: Magic string must match right after the header
+    if(fseek(appInfo->fptr_stego_image, 54, SEEK_SET) != 0 ||
+       decode_magic_string(MAGIC_STRING, appInfo->fptr_stego_image) == e_failure)
+    {
+        printf("INFO: The magic string does not match!\n\n");
+        return e_failure;
+    }
+
+    // STEP3: Decode the extension size and skip over the extension
+    if(fread(arr, 1, 32, appInfo->fptr_stego_image) != 32)
+    {
+        return e_failure;
+    }
+    decode_size_from_lsb(&appInfo->extn_file_size, arr);
+    if(appInfo->extn_file_size < 0 || (54 + 16 + 32 + appInfo->extn_file_size * 8 + 32) > 54 + (long)appInfo->image_capacity)
+    {
+        printf("INFO: The extension size is corrupted!\n\n");
+        return e_failure;
+    }
+    if(fseek(appInfo->fptr_stego_image, appInfo->extn_file_size * 8, SEEK_CUR) != 0)
+    {
+        return e_failure;
+    }
+
+    // STEP4: Decode the secret size, remember where the field and the data start
+    appInfo->size_field_offset = ftell(appInfo->fptr_stego_image);
+    if(fread(arr, 1, 32, appInfo->fptr_stego_image) != 32)
+    {
+        return e_failure;
+    }
+    decode_size_from_lsb(&appInfo->size_secret_file, arr);
+    appInfo->data_offset = appInfo->size_field_offset + 32;
+    // The size is built in an int, a set bit 31 reads as negative
+    if(appInfo->size_field_offset < 0 || appInfo->size_secret_file < 0 ||
+       appInfo->data_offset + appInfo->size_secret_file * 8 > 54 + (long)appInfo->image_capacity)
+    {
+        printf("INFO: The secret size is corrupted!\n\n");
+        return e_failure;
+    }
+    return e_success;
+}
+
+// Function to encode data into the image in place, MAX_BLOCK_SIZE bytes per read/write
+Status encode_block_in_place(const char *data, long size, FILE *fptr_stego_image)
+{
+    char arr[MAX_BLOCK_SIZE * 8];
+
+    while(size > 0)
+    {
+        long block = size < MAX_BLOCK_SIZE ? size : MAX_BLOCK_SIZE;
+        long pos = ftell(fptr_stego_image);
+
+        // STEP1: Read the image bytes that will carry the block
+        if(fread(arr, 1, block * 8, fptr_stego_image) != (size_t)(block * 8))
+        {
+            return e_failure;
+        }
+
+        // STEP2: Encode the block
+        encode_bytes_to_lsb(data, block, arr);
+
+        // STEP3: Write the block back over the same image bytes
+        if(pos < 0 || fseek(fptr_stego_image, pos, SEEK_SET) != 0 ||
+           fwrite(arr, 1, block * 8, fptr_stego_image) != (size_t)(block * 8))
+        {
+            return e_failure;
+        }
+        // Reposition between a write and the next read
+        if(fseek(fptr_stego_image, 0, SEEK_CUR) != 0)
+        {
+            return e_failure;
+        }
+
+        data += block;
+        size -= block;
+    }
+    return e_success;
+}
+
+// Function to append data to an encoded image without re-encoding the existing payload
+Status do_appending(AppendInfo *appInfo)
+{
+    char data[MAX_BLOCK_SIZE];
+    char arr[32];
+
+    // STEP1: Open the encoded image for update and the file to be appended
+    appInfo->fptr_stego_image = fopen(appInfo->stego_image_fname, "r+");
+    if(appInfo->fptr_stego_image == NULL)
+    {
+        perror("fopen");
+        fprintf(stderr, "ERROR: Unable to open file %s\n", appInfo->stego_image_fname);
+        return e_failure;
+    }
+    appInfo->fptr_secret = fopen(appInfo->secret_fname, "r");
+    if(appInfo->fptr_secret == NULL)
+    {
+        perror("fopen");
+        fprintf(stderr, "ERROR: Unable to open file %s\n", appInfo->secret_fname);
+        return e_failure;
+    }
+
+    // STEP2: Decode the existing header
+    if(decode_append_header(appInfo) == e_failure)
+    {
+        printf("INFO: The existing header could not be decoded!\n\n");
+        return e_failure;
+    }
+    printf("INFO: Existing secret of %ld bytes found.\n\n", appInfo->size_secret_file);
+
+    // STEP3: Check the remaining pixels can hold the new data
+    appInfo->size_append = get_file_size(appInfo->fptr_secret);
+    if(fseek(appInfo->fptr_secret, 0, SEEK_SET) != 0)
+    {
+        fprintf(stderr, "ERROR: Unable to read file %s\n", appInfo->secret_fname);
+        return e_failure;
+    }
+    long long new_size = (long long)appInfo->size_secret_file + appInfo->size_append;
+    if(new_size > 0x7FFFFFFF || appInfo->data_offset + new_size * 8 > 54 + (long long)appInfo->image_capacity)
+    {
+        printf("INFO: Encoded Image does not have enough remaining capacity!\n\n");
+        return e_failure;
+    }
+
+    // STEP4: Encode the new data right after the last byte of the existing payload
+    if(fseek(appInfo->fptr_stego_image, appInfo->data_offset + appInfo->size_secret_file * 8, SEEK_SET) != 0)
+    {
+        printf("INFO: The new data could not be encoded!\n\n");
+        return e_failure;
+    }
+    long remaining = appInfo->size_append;
+    while(remaining > 0)
+    {
+        long block = remaining < MAX_BLOCK_SIZE ? remaining : MAX_BLOCK_SIZE;
+        if(fread(data, 1, block, appInfo->fptr_secret) != (size_t)block ||
+           encode_block_in_place(data, block, appInfo->fptr_stego_image) == e_failure)
+        {
+            printf("INFO: The new data could not be encoded!\n\n");
+            return e_failure;
+        }
+        remaining -= block;
+    }
+
+    // STEP5: Rewrite only the size field, after the data so a failed append keeps the old size
+    if(fseek(appInfo->fptr_stego_image, appInfo->size_field_offset, SEEK_SET) != 0 ||
+       fread(arr, 1, 32, appInfo->fptr_stego_image) != 32)
+    {
+        return e_failure;
+    }
+    encode_size_to_lsb(new_size, arr);
+    if(fseek(appInfo->fptr_stego_image, appInfo->size_field_offset, SEEK_SET) != 0 ||
+       fwrite(arr, 1, 32, appInfo->fptr_stego_image) != 32)
+    {
+        printf("INFO: The secret size could not be updated!\n\n");
+        return e_failure;
+    }
+
+    printf("INFO: Appended %ld bytes, secret is now %lld bytes.\n", appInfo->size_append, new_size);
+    return e_success;
+}
+
+// Function to close append file pointers
+void clear_append_info(AppendInfo *appInfo)
+{
+    if(appInfo->fptr_stego_image) fclose(appInfo->fptr_stego_image);
+    if(appInfo->fptr_secret) fclose(appInfo->fptr_secret);
+}
@@ -0,0 +1,50 @@
+#ifndef APPEND_H
+#define APPEND_H
+
+#include "types.h" // Contains user defined types
+
+/*
+ * Structure to store information required for
+ * appending data to an already encoded Image in place
+ * Only the new data and the secret size field are written
+ */
+
+typedef struct _AppendInfo
+{
+    /* Encoded Image info */
+    char *stego_image_fname;    // Encoded image file name, updated in place
+    FILE *fptr_stego_image;     // File pointer of encoded image
+    uint image_capacity;        // width * height * 3 of the encoded image
+
+    /* Existing payload Info */
+    long extn_file_size;        // Extension size of the existing secret
+    long size_secret_file;      // Existing secret size
+    long size_field_offset;     // Image offset of the 32 byte size field
+    long data_offset;           // Image offset of the first secret data byte
+
+    /* New data Info */
+    char *secret_fname;         // File with the data to be appended
+    FILE *fptr_secret;          // File pointer of that file
+    long size_append;           // Number of bytes to append
+
+} AppendInfo;  // Datatype of the structure
+
+
+/* Append function prototype */
+
+/* Read and validate append args from argv */
+Status read_and_validate_append_args(char *argv[], AppendInfo *appInfo);
+
+/* Perform the append */
+Status do_appending(AppendInfo *appInfo);
+
+/* Decode the existing header and find the size field and data offsets */
+Status decode_append_header(AppendInfo *appInfo);
+
+/* Encode data into the image in place, starting at the current position */
+Status encode_block_in_place(const char *data, long size, FILE *fptr_stego_image);
+
+/* Close append file pointers */
+void clear_append_info(AppendInfo *appInfo);
+
+#endif
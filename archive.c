@@ -0,0 +1,463 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+// User-defined header files
+#include "archive.h"
+#include "encode.h"
+#include "decode.h"
+#include "lsb_kernel.h"
+#include "types.h"
+#include "common.h"
+#include "admission.h"
+
+/* Function Definitions */
+
+// Function to read a 32 bit value back from 4 bytes
+static uint get_archive_uint(const char *buffer)
+{
+    uint value = 0;
+    for(int i = 0; i < 4; i++)
+    {
+        value = value | ((uint)(unsigned char)buffer[i] << (i * 8));
+    }
+    return value;
+}
+
+// Function to find the size of the archive header plus entry table in bytes
+static long get_archive_table_size(uint entry_count)
+{
+    return ARCHIVE_HEADER_SIZE + (long)entry_count * ARCHIVE_ENTRY_SIZE;
+}
+
+// Function to compute the Adler-32 checksum of a block, continuing from a previous value
+uint get_archive_checksum(uint checksum, const char *data, long size)
+{
+    uint a = checksum & 0xFFFF;
+    uint b = (checksum >> 16) & 0xFFFF;
+
+    for(long i = 0; i < size; i++)
+    {
+        a = (a + (unsigned char)data[i]) % 65521;
+        b = (b + a) % 65521;
+    }
+    return (b << 16) | a;
+}
+
+// Function to read and validate command line arguments entered by user after -c
+Status read_and_validate_archive_args(int argc, char *argv[], ArchiveInfo *arcInfo)
+{
+    // STEP1: Check argv[2] and argv[3] are .bmp or not
+    if(strstr(argv[2], ".bmp") == NULL || strstr(argv[3], ".bmp") == NULL)
+    {
+        return e_failure;
+    }
+
+    // STEP2: Check the number of member files
+    arcInfo->entry_count = argc - 4;
+    if(arcInfo->entry_count == 0 || arcInfo->entry_count > MAX_ARCHIVE_ENTRIES)
+    {
+        return e_failure;
+    }
+    arcInfo->src_image_fname = argv[2];
+    arcInfo->stego_image_fname = argv[3];
+    arcInfo->member_fnames = argv + 4;
+
+    // STEP3: Allocate the entry table
+    arcInfo->entries = calloc(arcInfo->entry_count, sizeof(ArchiveEntry));
+    if(!arcInfo->entries)
+    {
+        // If memory allocation fails
+        return e_failure;
+    }
+
+    // STEP4: Entry name is the file name without directories, it must fit in the table
+    for(uint i = 0; i < arcInfo->entry_count; i++)
+    {
+        char *name = strrchr(arcInfo->member_fnames[i], '/');
+        name = name ? name + 1 : arcInfo->member_fnames[i];
+        if(strlen(name) == 0 || strlen(name) >= ARCHIVE_NAME_LEN)
+        {
+            printf("INFO: Entry name '%s' must be 1 to %d characters long!\n\n", name, ARCHIVE_NAME_LEN - 1);
+            return e_failure;
+        }
+        strcpy(arcInfo->entries[i].name, name);
+
+        // STEP5: Entry names must be unique to be extracted by name
+        for(uint j = 0; j < i; j++)
+        {
+            if(strcmp(arcInfo->entries[j].name, name) == 0)
+            {
+                printf("INFO: Entry name '%s' is repeated!\n\n", name);
+                return e_failure;
+            }
+        }
+    }
+    return e_success;
+}
+
+// Function to read and validate command line arguments entered by user after -l or -x
+Status read_and_validate_extract_args(int argc, char *argv[], ArchiveInfo *arcInfo)
+{
+    // STEP1: Check argv[2] is .bmp or not
+    if(strstr(argv[2], ".bmp") == NULL)
+    {
+        return e_failure;
+    }
+    arcInfo->src_image_fname = argv[2];
+
+    // STEP2: For -x store the entry name and output name (defaults to entry name)
+    if(strcmp(argv[1], "-x") == 0)
+    {
+        arcInfo->entry_name = argv[3];
+        arcInfo->output_fname = argc > 4 ? argv[4] : argv[3];
+    }
+    return e_success;
+}
+
+// Function to embed all member files one after another, filling in offsets and checksums
+static Status encode_archive_members(ArchiveInfo *arcInfo)
+{
+    char data[MAX_BLOCK_SIZE];
+
+    for(uint i = 0; i < arcInfo->entry_count; i++)
+    {
+        ArchiveEntry *entry = &arcInfo->entries[i];
+        long remaining = entry->length;
+
+        arcInfo->fptr_member = fopen(arcInfo->member_fnames[i], "r");
+        if(arcInfo->fptr_member == NULL)
+        {
+            perror("fopen");
+            fprintf(stderr, "ERROR: Unable to open file %s\n", arcInfo->member_fnames[i]);
+            return e_failure;
+        }
+
+        // Read, checksum and embed the member one block at a time
+        entry->checksum = 1;
+        while(remaining > 0)
+        {
+            long block = remaining < MAX_BLOCK_SIZE ? remaining : MAX_BLOCK_SIZE;
+            if(fread(data, 1, block, arcInfo->fptr_member) != (size_t)block)
+            {
+                return e_failure;
+            }
+            entry->checksum = get_archive_checksum(entry->checksum, data, block);
+            if(encode_block_to_image(data, block, arcInfo->fptr_src_image, arcInfo->fptr_stego_image) == e_failure)
+            {
+                return e_failure;
+            }
+            remaining -= block;
+        }
+
+        fclose(arcInfo->fptr_member);
+        arcInfo->fptr_member = NULL;
+    }
+    return e_success;
+}
+
+// Function to pack all member files into the source image
+Status do_archiving(ArchiveInfo *arcInfo)
+{
+    // STEP1: Open source and destination images
+    arcInfo->fptr_src_image = fopen(arcInfo->src_image_fname, "r");
+    if(arcInfo->fptr_src_image == NULL)
+    {
+        perror("fopen");
+        fprintf(stderr, "ERROR: Unable to open file %s\n", arcInfo->src_image_fname);
+        return e_failure;
+    }
+    arcInfo->fptr_stego_image = fopen(arcInfo->stego_image_fname, "w");
+    if(arcInfo->fptr_stego_image == NULL)
+    {
+        perror("fopen");
+        fprintf(stderr, "ERROR: Unable to open file %s\n", arcInfo->stego_image_fname);
+        return e_failure;
+    }
+
+    // STEP2: Find the size of every member and lay the payloads out back to back
+    unsigned long long total_size = get_archive_table_size(arcInfo->entry_count);
+    uint offset = 0;
+    for(uint i = 0; i < arcInfo->entry_count; i++)
+    {
+        arcInfo->fptr_member = fopen(arcInfo->member_fnames[i], "r");
+        if(arcInfo->fptr_member == NULL)
+        {
+            perror("fopen");
+            fprintf(stderr, "ERROR: Unable to open file %s\n", arcInfo->member_fnames[i]);
+            return e_failure;
+        }
+        arcInfo->entries[i].offset = offset;
+        arcInfo->entries[i].length = get_file_size(arcInfo->fptr_member);
+        offset += arcInfo->entries[i].length;
+        total_size += arcInfo->entries[i].length;
+        fclose(arcInfo->fptr_member);
+        arcInfo->fptr_member = NULL;
+    }
+
+    // STEP3: Check if the bmp file has enough capacity to hold the table and all payloads
+    if(total_size * 8 > get_image_size_for_bmp(arcInfo->fptr_src_image))
+    {
+        printf("INFO: Source Image does not have enough capacity!\n\n");
+        return e_failure;
+    }
+    printf("INFO: The source image has enough capacity for %u entries.\n\n", arcInfo->entry_count);
+
+    // STEP4: Copy the header
+    if(copy_bmp_header(arcInfo->fptr_src_image, arcInfo->fptr_stego_image) == e_failure)
+    {
+        printf("INFO: The header could not be copied!\n\n");
+        return e_failure;
+    }
+
+    // STEP5: Keep the image bytes of the table aside, checksums are only known after the payloads
+    long table_size = get_archive_table_size(arcInfo->entry_count);
+    char *table_image = malloc(table_size * 8);
+    char *table = malloc(table_size);
+    if(!table_image || !table)
+    {
+        free(table_image);
+        free(table);
+        return e_failure;
+    }
+    if(fread(table_image, 1, table_size * 8, arcInfo->fptr_src_image) != (size_t)(table_size * 8) ||
+       fwrite(table_image, 1, table_size * 8, arcInfo->fptr_stego_image) != (size_t)(table_size * 8))
+    {
+        free(table_image);
+        free(table);
+        return e_failure;
+    }
+
+    // STEP6: Embed the payloads in a single pass
+    if(encode_archive_members(arcInfo) == e_failure)
+    {
+        printf("INFO: The archive entries could not be encoded!\n\n");
+        free(table_image);
+        free(table);
+        return e_failure;
+    }
+    printf("INFO: The archive entries have been successfully encoded.\n\n");
+
+    // STEP7: Copy the remaining image data
+    if(copy_image_blocks(arcInfo->fptr_src_image, arcInfo->fptr_stego_image, NULL, NULL) == e_failure)
+    {
+        printf("INFO: The remaining data could not be copied!\n\n");
+        free(table_image);
+        free(table);
+        return e_failure;
+    }
+
+    // STEP8: Build the table, encode it into the kept image bytes and write it behind the header
+    memcpy(table, ARCHIVE_MAGIC_STRING, 2);
+    put_stream_uint(table + 2, arcInfo->entry_count);
+    for(uint i = 0; i < arcInfo->entry_count; i++)
+    {
+        char *record = table + get_archive_table_size(i);
+        memcpy(record, arcInfo->entries[i].name, ARCHIVE_NAME_LEN);
+        put_stream_uint(record + ARCHIVE_NAME_LEN, arcInfo->entries[i].offset);
+        put_stream_uint(record + ARCHIVE_NAME_LEN + 4, arcInfo->entries[i].length);
+        put_stream_uint(record + ARCHIVE_NAME_LEN + 8, arcInfo->entries[i].checksum);
+    }
+    encode_bytes_to_lsb(table, table_size, table_image);
+    fseek(arcInfo->fptr_stego_image, 54, SEEK_SET);
+    Status ret = fwrite(table_image, 1, table_size * 8, arcInfo->fptr_stego_image) == (size_t)(table_size * 8) ? e_success : e_failure;
+    free(table_image);
+    free(table);
+
+    if(ret == e_success)
+    {
+        printf("INFO: Archive of %u entries created successfully.\n", arcInfo->entry_count);
+    }
+    return ret;
+}
+
+// Function to read and decode the entry table, only the table's image bytes are read
+Status decode_archive_table(ArchiveInfo *arcInfo)
+{
+    char header[ARCHIVE_HEADER_SIZE];
+
+    // STEP1: Decode the magic string and entry count right after the bmp header
+    uint image_capacity = get_image_size_for_bmp(arcInfo->fptr_src_image);
+    fseek(arcInfo->fptr_src_image, 54, SEEK_SET);
+    if(decode_image_to_block(header, ARCHIVE_HEADER_SIZE, arcInfo->fptr_src_image) == e_failure ||
+       memcmp(header, ARCHIVE_MAGIC_STRING, 2) != 0)
+    {
+        printf("INFO: The image is not an archive!\n\n");
+        return e_failure;
+    }
+
+    // STEP2: Entry count must fit both the limit and the image before anything is allocated
+    arcInfo->entry_count = get_archive_uint(header + 2);
+    long table_size = get_archive_table_size(arcInfo->entry_count);
+    if(arcInfo->entry_count > MAX_ARCHIVE_ENTRIES || (unsigned long long)table_size * 8 > image_capacity)
+    {
+        printf("INFO: The archive table is corrupted!\n\n");
+        return e_failure;
+    }
+
+    // STEP3: Decode the entries
+    if(admit_allocation(table_size - ARCHIVE_HEADER_SIZE + 1 + (arcInfo->entry_count + 1L) * sizeof(ArchiveEntry)) == e_failure)
+    {
+        return e_failure;
+    }
+    char *table = malloc(table_size - ARCHIVE_HEADER_SIZE + 1);
+    arcInfo->entries = calloc(arcInfo->entry_count + 1, sizeof(ArchiveEntry));
+    if(!table || !arcInfo->entries)
+    {
+        free(table);
+        return e_failure;
+    }
+    if(decode_image_to_block(table, table_size - ARCHIVE_HEADER_SIZE, arcInfo->fptr_src_image) == e_failure)
+    {
+        free(table);
+        return e_failure;
+    }
+    for(uint i = 0; i < arcInfo->entry_count; i++)
+    {
+        char *record = table + (long)i * ARCHIVE_ENTRY_SIZE;
+        memcpy(arcInfo->entries[i].name, record, ARCHIVE_NAME_LEN);
+        arcInfo->entries[i].name[ARCHIVE_NAME_LEN - 1] = '\0';
+        arcInfo->entries[i].offset = get_archive_uint(record + ARCHIVE_NAME_LEN);
+        arcInfo->entries[i].length = get_archive_uint(record + ARCHIVE_NAME_LEN + 4);
+        arcInfo->entries[i].checksum = get_archive_uint(record + ARCHIVE_NAME_LEN + 8);
+    }
+    free(table);
+    return e_success;
+}
+
+// Function to print the entry table of an archive image
+Status do_listing(ArchiveInfo *arcInfo)
+{
+    arcInfo->fptr_src_image = fopen(arcInfo->src_image_fname, "r");
+    if(arcInfo->fptr_src_image == NULL)
+    {
+        perror("fopen");
+        fprintf(stderr, "ERROR: Unable to open file %s\n", arcInfo->src_image_fname);
+        return e_failure;
+    }
+    if(decode_archive_table(arcInfo) == e_failure)
+    {
+        return e_failure;
+    }
+
+    printf("%-16s %10s %10s %10s\n", "NAME", "OFFSET", "LENGTH", "CHECKSUM");
+    for(uint i = 0; i < arcInfo->entry_count; i++)
+    {
+        printf("%-16s %10u %10u   %08x\n", arcInfo->entries[i].name, arcInfo->entries[i].offset,
+               arcInfo->entries[i].length, arcInfo->entries[i].checksum);
+    }
+    return e_success;
+}
+
+// Function to extract a single entry, seeking straight to its first image byte
+Status do_extracting(ArchiveInfo *arcInfo)
+{
+    char data[MAX_BLOCK_SIZE];
+
+    // STEP1: Open the archive image and decode the table
+    arcInfo->fptr_src_image = fopen(arcInfo->src_image_fname, "r");
+    if(arcInfo->fptr_src_image == NULL)
+    {
+        perror("fopen");
+        fprintf(stderr, "ERROR: Unable to open file %s\n", arcInfo->src_image_fname);
+        return e_failure;
+    }
+    if(decode_archive_table(arcInfo) == e_failure)
+    {
+        return e_failure;
+    }
+
+    // STEP2: Find the entry by name
+    ArchiveEntry *entry = NULL;
+    for(uint i = 0; i < arcInfo->entry_count; i++)
+    {
+        if(strcmp(arcInfo->entries[i].name, arcInfo->entry_name) == 0)
+        {
+            entry = &arcInfo->entries[i];
+            break;
+        }
+    }
+    if(entry == NULL)
+    {
+        printf("INFO: Entry '%s' not found in the archive!\n\n", arcInfo->entry_name);
+        return e_failure;
+    }
+
+    // STEP3: The entry must lie inside the image
+    long table_size = get_archive_table_size(arcInfo->entry_count);
+    unsigned long long end = (unsigned long long)table_size + entry->offset + entry->length;
+    if(end * 8 > get_image_size_for_bmp(arcInfo->fptr_src_image))
+    {
+        printf("INFO: The entry lies outside the image!\n\n");
+        return e_failure;
+    }
+    if(admit_output_bytes(entry->length) == e_failure)
+    {
+        return e_failure;
+    }
+
+    // STEP4: Seek to the bit offset of the entry and open a temporary output file next to the output file
+    char part_fname[4096];
+    snprintf(part_fname, sizeof(part_fname), "%s.%d.part", arcInfo->output_fname, (int)getpid());
+    fseek(arcInfo->fptr_src_image, 54 + (table_size + (long)entry->offset) * 8, SEEK_SET);
+    arcInfo->fptr_output = fopen(part_fname, "w");
+    if(arcInfo->fptr_output == NULL)
+    {
+        perror("fopen");
+        fprintf(stderr, "ERROR: Unable to open file %s\n", part_fname);
+        return e_failure;
+    }
+
+    // STEP5: Decode the entry block by block and verify its checksum
+    uint checksum = 1;
+    long remaining = entry->length;
+    Status ret = e_success;
+    while(remaining > 0 && ret == e_success)
+    {
+        long block = remaining < MAX_BLOCK_SIZE ? remaining : MAX_BLOCK_SIZE;
+        if(decode_image_to_block(data, block, arcInfo->fptr_src_image) == e_failure ||
+           fwrite(data, 1, block, arcInfo->fptr_output) != (size_t)block)
+        {
+            ret = e_failure;
+        }
+        checksum = get_archive_checksum(checksum, data, block);
+        remaining -= block;
+    }
+    if(ret == e_success && checksum != entry->checksum)
+    {
+        printf("INFO: Checksum of entry '%s' does not match!\n\n", entry->name);
+        ret = e_failure;
+    }
+
+    // STEP6: Only a complete entry with a matching checksum replaces the output file, anything else is removed
+    if(fclose(arcInfo->fptr_output) != 0)
+    {
+        ret = e_failure;
+    }
+    arcInfo->fptr_output = NULL;
+    if(ret == e_success && rename(part_fname, arcInfo->output_fname) != 0)
+    {
+        perror("rename");
+        fprintf(stderr, "ERROR: Unable to write file %s\n", arcInfo->output_fname);
+        ret = e_failure;
+    }
+    if(ret == e_failure)
+    {
+        remove(part_fname);
+        return e_failure;
+    }
+
+    printf("INFO: Entry '%s' extracted to %s successfully.\n", entry->name, arcInfo->output_fname);
+    return e_success;
+}
+
+// Function to free the entry table and close archive file pointers
+void clear_archive_info(ArchiveInfo *arcInfo)
+{
+    if(arcInfo->entries) free(arcInfo->entries);
+
+    if(arcInfo->fptr_src_image) fclose(arcInfo->fptr_src_image);
+    if(arcInfo->fptr_stego_image) fclose(arcInfo->fptr_stego_image);
+    if(arcInfo->fptr_member) fclose(arcInfo->fptr_member);
+    if(arcInfo->fptr_output) fclose(arcInfo->fptr_output);
+}
@@ -0,0 +1,79 @@
+#ifndef ARCHIVE_H
+#define ARCHIVE_H
+
+#include "types.h" // Contains user defined types
+
+/*
+ * Structures to store information required for
+ * packing several files into one source Image and
+ * for listing/extracting single entries from it
+ *
+ * Layout after the 54 byte bmp header (each byte in 8 image bytes):
+ * magic (2) | entry count (4) | entry table (count * 28) | payloads
+ * Entry offsets are relative to the start of the payloads
+ */
+
+#define ARCHIVE_NAME_LEN 16
+#define ARCHIVE_ENTRY_SIZE (ARCHIVE_NAME_LEN + 4 + 4 + 4)
+#define ARCHIVE_HEADER_SIZE 6
+#define MAX_ARCHIVE_ENTRIES 1024
+
+typedef struct _ArchiveEntry
+{
+    char name[ARCHIVE_NAME_LEN];    // Entry name, null padded
+    uint offset;                    // Payload offset in bytes
+    uint length;                    // Payload length in bytes
+    uint checksum;                  // Adler-32 of the payload
+} ArchiveEntry;
+
+typedef struct _ArchiveInfo
+{
+    /* Source/Encoded Image info */
+    char *src_image_fname;      // Source image (cover for -c, archive for -l/-x)
+    FILE *fptr_src_image;       // File pointer of source image
+
+    /* Stego Image Info (-c only) */
+    char *stego_image_fname;    // Output Image file name
+    FILE *fptr_stego_image;     // File pointer of output image
+
+    /* Entry Info */
+    char **member_fnames;       // Files to be packed (-c only), points into argv
+    FILE *fptr_member;          // File pointer of the member being processed
+    uint entry_count;           // Number of entries in the table
+    ArchiveEntry *entries;      // Entry table
+
+    /* Extract Info (-x only) */
+    char *entry_name;           // Name of the entry to be extracted
+    char *output_fname;         // Output file name for the entry
+    FILE *fptr_output;          // File pointer of output file
+
+} ArchiveInfo;  // Datatype of the structure
+
+
+/* Archive function prototype */
+
+/* Read and validate archive create args from argv */
+Status read_and_validate_archive_args(int argc, char *argv[], ArchiveInfo *arcInfo);
+
+/* Read and validate list/extract args from argv */
+Status read_and_validate_extract_args(int argc, char *argv[], ArchiveInfo *arcInfo);
+
+/* Pack all member files into the source image */
+Status do_archiving(ArchiveInfo *arcInfo);
+
+/* Print the entry table of an archive image */
+Status do_listing(ArchiveInfo *arcInfo);
+
+/* Extract a single entry from an archive image */
+Status do_extracting(ArchiveInfo *arcInfo);
+
+/* Read and decode the entry table from an archive image */
+Status decode_archive_table(ArchiveInfo *arcInfo);
+
+/* Adler-32 checksum, continued from a previous value (start with 1) */
+uint get_archive_checksum(uint checksum, const char *data, long size);
+
+/* Free the entry table and close archive file pointers */
+void clear_archive_info(ArchiveInfo *arcInfo);
+
+#endif
@@ -0,0 +1,299 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+// User-defined header files
+#include "broadcast.h"
+#include "encode.h"
+#include "lsb_kernel.h"
+#include "types.h"
+#include "common.h"
+
+/* Function Definitions */
+
+// Function to get the file name of a cover, its stego image has the same name inside the output directory
+static const char *get_cover_name(const char *cover_fname)
+{
+    const char *name = strrchr(cover_fname, '/');
+    return name ? name + 1 : cover_fname;
+}
+
+// qsort comparator, covers by file name
+static int compare_cover_name(const void *a, const void *b)
+{
+    return strcmp(get_cover_name(*(char * const *)a), get_cover_name(*(char * const *)b));
+}
+
+// Function to check that no two covers have the same file name, their workers would write the same stego image
+static Status check_cover_names(BroadcastInfo *bcInfo)
+{
+    char **sorted = malloc(bcInfo->cover_count * sizeof(char *));
+    Status ret = e_success;
+
+    if(sorted == NULL)
+    {
+        return e_failure;
+    }
+    memcpy(sorted, bcInfo->cover_fnames, bcInfo->cover_count * sizeof(char *));
+    qsort(sorted, bcInfo->cover_count, sizeof(char *), compare_cover_name);
+    for(int i = 1; i < bcInfo->cover_count; i++)
+    {
+        if(compare_cover_name(&sorted[i - 1], &sorted[i]) == 0)
+        {
+            printf("INFO: %s and %s would both be written to %s/%s!\n\n", sorted[i - 1], sorted[i],
+                   bcInfo->output_dirname, get_cover_name(sorted[i]));
+            ret = e_failure;
+        }
+    }
+    free(sorted);
+    return ret;
+}
+
+// Function to read and validate command line arguments entered by user after -b
+Status read_and_validate_broadcast_args(int argc, char *argv[], BroadcastInfo *bcInfo)
+{
+    int first = 4;
+
+    // STEP1: Check argv[2] is .txt file or not, like the encoder
+    if(strstr(argv[2], ".txt") == NULL)
+    {
+        return e_failure;
+    }
+    bcInfo->secret_fname = argv[2];
+    bcInfo->output_dirname = argv[3];
+
+    // STEP2: Optional --threads N before the covers
+    bcInfo->threads = 0;
+    if(argc > 5 && strcmp(argv[4], "--threads") == 0)
+    {
+        bcInfo->threads = atoi(argv[5]);
+        if(bcInfo->threads <= 0 || bcInfo->threads > BROADCAST_MAX_THREADS)
+        {
+            return e_failure;
+        }
+        first = 6;
+    }
+
+    // STEP3: Every remaining argument must be a .bmp cover
+    bcInfo->cover_fnames = argv + first;
+    bcInfo->cover_count = argc - first;
+    if(bcInfo->cover_count <= 0)
+    {
+        return e_failure;
+    }
+    for(int i = 0; i < bcInfo->cover_count; i++)
+    {
+        if(strstr(bcInfo->cover_fnames[i], ".bmp") == NULL)
+        {
+            return e_failure;
+        }
+    }
+
+    // STEP4: Stego images are named after the covers, so the cover file names must differ
+    if(check_cover_names(bcInfo) == e_failure)
+    {
+        return e_failure;
+    }
+    if(bcInfo->threads == 0)
+    {
+        bcInfo->threads = bcInfo->cover_count < BROADCAST_MAX_THREADS ? bcInfo->cover_count : BROADCAST_MAX_THREADS;
+    }
+
+    bcInfo->results = calloc(bcInfo->cover_count, sizeof(Status));
+    return bcInfo->results ? e_success : e_failure;
+}
+
+// Function to read the secret once and expand its stego stream into the LSB plane
+Status build_lsb_plane(BroadcastInfo *bcInfo)
+{
+    // STEP1: Open the secret and find its size and extension, as check_capacity() does
+    FILE *fptr_secret = fopen(bcInfo->secret_fname, "r");
+    if(fptr_secret == NULL)
+    {
+        perror("fopen");
+        fprintf(stderr, "ERROR: Unable to open file %s\n", bcInfo->secret_fname);
+        return e_failure;
+    }
+    bcInfo->size_secret_file = get_file_size(fptr_secret);
+    fseek(fptr_secret, 0, SEEK_SET);
+    bcInfo->extn_secret_file = (char *)get_secret_extension(bcInfo->secret_fname);
+    uint extn_size = strlen(bcInfo->extn_secret_file);
+    bcInfo->needed = get_encoded_size(extn_size, bcInfo->size_secret_file);
+
+    // STEP2: Build the stream: magic string | extension size | extension | file size | data
+    long stream_size = strlen(MAGIC_STRING) + 4 + extn_size + 4 + bcInfo->size_secret_file;
+    char *stream = malloc(stream_size);
+    bcInfo->plane_size = stream_size * 8;
+    bcInfo->plane = calloc(bcInfo->plane_size, 1);
+    if(!stream || !bcInfo->plane)
+    {
+        free(stream);
+        fclose(fptr_secret);
+        return e_failure;
+    }
+    char *ptr = stream + build_stream_header(stream, bcInfo->extn_secret_file, bcInfo->size_secret_file);
+    Status ret = fread(ptr, 1, bcInfo->size_secret_file, fptr_secret) == (size_t)bcInfo->size_secret_file ? e_success : e_failure;
+    fclose(fptr_secret);
+
+    // STEP3: Encoding into an all zero buffer leaves exactly the 0/1 plane
+    if(ret == e_success)
+    {
+        encode_bytes_to_lsb(stream, stream_size, bcInfo->plane);
+    }
+    free(stream);
+    return ret;
+}
+
+// Function to apply an LSB plane to a block of image data, 8 image bytes per step
+void apply_lsb_plane(char *image_buffer, const char *plane, long size)
+{
+    const uint64_t keep = ~0x0101010101010101ULL;
+    long i = 0;
+
+    for(; i + 8 <= size; i += 8)
+    {
+        uint64_t image, bits;
+        memcpy(&image, image_buffer + i, 8);
+        memcpy(&bits, plane + i, 8);
+        image = (image & keep) | bits;
+        memcpy(image_buffer + i, &image, 8);
+    }
+    for(; i < size; i++)
+    {
+        image_buffer[i] = (image_buffer[i] & ~1) | plane[i];
+    }
+}
+
+// Function to encode the plane into one cover, stego image goes to the output directory
+Status broadcast_to_cover(BroadcastInfo *bcInfo, const char *cover_fname)
+{
+    char arr[MAX_BLOCK_SIZE * 8];
+    char stego_fname[4096];
+    Status ret = e_failure;
+
+    // STEP1: Stego image has the cover's file name inside the output directory
+    snprintf(stego_fname, sizeof(stego_fname), "%s/%s", bcInfo->output_dirname, get_cover_name(cover_fname));
+
+    // STEP2: Open the cover and check its capacity
+    FILE *fptr_src_image = fopen(cover_fname, "r");
+    if(fptr_src_image == NULL)
+    {
+        perror("fopen");
+        fprintf(stderr, "ERROR: Unable to open file %s\n", cover_fname);
+        return e_failure;
+    }
+    if(get_image_size_for_bmp(fptr_src_image) <= bcInfo->needed)
+    {
+        printf("INFO: %s does not have enough capacity!\n", cover_fname);
+        fclose(fptr_src_image);
+        return e_failure;
+    }
+    FILE *fptr_stego_image = fopen(stego_fname, "w");
+    if(fptr_stego_image == NULL)
+    {
+        perror("fopen");
+        fprintf(stderr, "ERROR: Unable to open file %s\n", stego_fname);
+        fclose(fptr_src_image);
+        return e_failure;
+    }
+
+    // STEP3: Header, then the plane block by block, then the rest of the image
+    if(copy_bmp_header(fptr_src_image, fptr_stego_image) == e_success)
+    {
+        long done = 0;
+        ret = e_success;
+        while(done < bcInfo->plane_size && ret == e_success)
+        {
+            long block = bcInfo->plane_size - done < (long)sizeof(arr) ? bcInfo->plane_size - done : (long)sizeof(arr);
+            if(fread(arr, 1, block, fptr_src_image) != (size_t)block)
+            {
+                ret = e_failure;
+                break;
+            }
+            apply_lsb_plane(arr, bcInfo->plane + done, block);
+            if(fwrite(arr, 1, block, fptr_stego_image) != (size_t)block)
+            {
+                ret = e_failure;
+            }
+            done += block;
+        }
+        if(ret == e_success)
+        {
+            ret = copy_image_blocks(fptr_src_image, fptr_stego_image, NULL, NULL);
+        }
+    }
+
+    // STEP4: Stego image must be as large as the cover
+    if(ret == e_success && get_file_size(fptr_stego_image) != get_file_size(fptr_src_image))
+    {
+        ret = e_failure;
+    }
+    fclose(fptr_src_image);
+    if(fclose(fptr_stego_image) != 0)
+    {
+        ret = e_failure;
+    }
+    return ret;
+}
+
+// Worker thread, takes the next cover until none are left
+static void *broadcast_worker(void *arg)
+{
+    BroadcastInfo *bcInfo = arg;
+    int i;
+
+    while((i = __atomic_fetch_add(&bcInfo->next_cover, 1, __ATOMIC_RELAXED)) < bcInfo->cover_count)
+    {
+        bcInfo->results[i] = broadcast_to_cover(bcInfo, bcInfo->cover_fnames[i]);
+    }
+    return NULL;
+}
+
+// Function to encode the secret into every cover
+Status do_broadcasting(BroadcastInfo *bcInfo)
+{
+    pthread_t workers[BROADCAST_MAX_THREADS];
+    int started = 0, failed = 0;
+
+    // STEP1: Read and expand the secret once
+    if(build_lsb_plane(bcInfo) == e_failure)
+    {
+        printf("INFO: The secret file could not be read!\n\n");
+        return e_failure;
+    }
+    printf("INFO: Secret expanded once into a %ld byte LSB plane.\n\n", bcInfo->plane_size);
+
+    // STEP2: Workers apply the plane to the covers, --threads N counts the main thread, which works too
+    for(int i = 0; i < bcInfo->threads - 1; i++)
+    {
+        if(pthread_create(&workers[started], NULL, broadcast_worker, bcInfo) == 0)
+        {
+            started++;
+        }
+    }
+    broadcast_worker(bcInfo);
+    for(int i = 0; i < started; i++)
+    {
+        pthread_join(workers[i], NULL);
+    }
+
+    // STEP3: Report the covers that failed
+    for(int i = 0; i < bcInfo->cover_count; i++)
+    {
+        if(bcInfo->results[i] == e_failure)
+        {
+            printf("INFO: %s could not be encoded!\n", bcInfo->cover_fnames[i]);
+            failed++;
+        }
+    }
+    printf("INFO: Secret encoded into %d of %d covers.\n", bcInfo->cover_count - failed, bcInfo->cover_count);
+    return failed ? e_failure : e_success;
+}
+
+// Function to free the plane and results
+void clear_broadcast_info(BroadcastInfo *bcInfo)
+{
+    if(bcInfo->plane) free(bcInfo->plane);
+    if(bcInfo->results) free(bcInfo->results);
+}
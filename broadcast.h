@@ -0,0 +1,64 @@
+#ifndef BROADCAST_H
+#define BROADCAST_H
+
+#include "types.h" // Contains user defined types
+
+/*
+ * Structure to store information required for
+ * encoding one secret into many cover Images
+ *
+ * The secret is read once and its whole stego stream (magic string,
+ * extension size, extension, file size, data) is expanded once into an
+ * LSB plane of one 0/1 byte per image byte, 8 times the stream size.
+ * Every cover then only needs (image & ~1) | plane
+ *
+ * Stego images get the cover file names inside the output directory, so
+ * covers with the same file name in different directories are refused
+ */
+
+#define BROADCAST_MAX_THREADS 64
+
+typedef struct _BroadcastInfo
+{
+    /* Secret File Info */
+    char *secret_fname;         // Secret file name
+    char *extn_secret_file;     // Extension of secret file, points into secret_fname
+    long size_secret_file;      // Secret file size
+
+    /* Pre-expanded LSB plane */
+    char *plane;                // One 0/1 byte per image byte of the stego stream
+    long plane_size;            // 8 * stream size
+    unsigned long long needed;  // Image bytes needed, see get_encoded_size()
+
+    /* Cover Images Info */
+    char *output_dirname;       // Directory for the stego images
+    char **cover_fnames;        // Cover images, points into argv
+    int cover_count;
+    Status *results;            // One result per cover
+    int next_cover;             // Next cover to be taken by a worker
+    int threads;                // Number of worker threads, the main thread included (--threads N)
+
+} BroadcastInfo;  // Datatype of the structure
+
+
+/* Broadcast function prototype */
+
+/* Read and validate broadcast args from argv */
+Status read_and_validate_broadcast_args(int argc, char *argv[], BroadcastInfo *bcInfo);
+
+/* Encode the secret into every cover */
+Status do_broadcasting(BroadcastInfo *bcInfo);
+
+/* Read the secret once and expand its stego stream into the LSB plane */
+Status build_lsb_plane(BroadcastInfo *bcInfo);
+
+/* Apply an LSB plane to a block of image data */
+void apply_lsb_plane(char *image_buffer, const char *plane, long size);
+
+/* Encode the plane into one cover */
+Status broadcast_to_cover(BroadcastInfo *bcInfo, const char *cover_fname);
+
+/* Free the plane and results */
+void clear_broadcast_info(BroadcastInfo *bcInfo);
+
+#endif
@@ -0,0 +1,362 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <limits.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <linux/fs.h>
+// User-defined header files
+#include "cache.h"
+#include "encode.h"
+#include "pool.h"
+#include "types.h"
+
+CacheInfo cache = { NULL, CACHE_DEFAULT_MAX_SIZE };
+
+/* Function Definitions */
+
+// 64 bit primes of the hash rounds
+#define CACHE_P1 11400714785074694791ULL
+#define CACHE_P2 14029467366897019727ULL
+#define CACHE_P3 1609587929392839161ULL
+#define CACHE_P5 2870177450012600261ULL
+
+static inline uint64_t rotate_cache_word(uint64_t value, int bits)
+{
+    return (value << bits) | (value >> (64 - bits));
+}
+
+// Function to mix one 32 byte stripe into the accumulators, four independent multiply-rotate lanes
+static inline void hash_cache_stripe(uint64_t *acc, const unsigned char *stripe)
+{
+    for(int lane = 0; lane < 4; lane++)
+    {
+        uint64_t word;
+        memcpy(&word, stripe + lane * 8, 8);
+        acc[lane] = rotate_cache_word(acc[lane] + word * CACHE_P2, 31) * CACHE_P1;
+    }
+}
+
+// Function to spread every input bit over the whole word
+static uint64_t avalanche_cache_word(uint64_t value)
+{
+    value ^= value >> 33;
+    value *= CACHE_P2;
+    value ^= value >> 29;
+    value *= CACHE_P3;
+    value ^= value >> 32;
+    return value;
+}
+
+// Function to start a hash
+void start_cache_hash(CacheHash *hash)
+{
+    memset(hash, 0, sizeof(CacheHash));
+    hash->acc[0] = CACHE_P1 + CACHE_P2;
+    hash->acc[1] = CACHE_P2;
+    hash->acc[2] = 0;
+    hash->acc[3] = -CACHE_P1;
+}
+
+// Function to feed size bytes to a hash, whole stripes straight from data
+void update_cache_hash(CacheHash *hash, const void *data, long size)
+{
+    const unsigned char *ptr = data;
+
+    hash->length += size;
+    while(size > 0)
+    {
+        if(hash->buffered == 0 && size >= 32)
+        {
+            hash_cache_stripe(hash->acc, ptr);
+            ptr += 32;
+            size -= 32;
+            continue;
+        }
+        long count = 32 - hash->buffered < size ? 32 - hash->buffered : size;
+        memcpy(hash->stripe + hash->buffered, ptr, count);
+        hash->buffered += count;
+        ptr += count;
+        size -= count;
+        if(hash->buffered == 32)
+        {
+            hash_cache_stripe(hash->acc, hash->stripe);
+            hash->buffered = 0;
+        }
+    }
+}
+
+// Function to finish a hash into CACHE_KEY_SIZE hex digits, the length tells zero padding apart
+void finish_cache_hash(CacheHash *hash, char *key)
+{
+    uint64_t *acc = hash->acc;
+
+    if(hash->buffered > 0)
+    {
+        memset(hash->stripe + hash->buffered, 0, 32 - hash->buffered);
+        hash_cache_stripe(acc, hash->stripe);
+    }
+    uint64_t high = avalanche_cache_word(acc[0] + rotate_cache_word(acc[1], 7) + rotate_cache_word(acc[2], 12) +
+                                         rotate_cache_word(acc[3], 18) + hash->length);
+    uint64_t low = avalanche_cache_word(acc[3] + rotate_cache_word(acc[2], 7) + rotate_cache_word(acc[1], 12) +
+                                        rotate_cache_word(acc[0], 18) + hash->length * CACHE_P5);
+    snprintf(key, CACHE_KEY_SIZE + 1, "%016llx%016llx", (unsigned long long)high, (unsigned long long)low);
+}
+
+// Function to turn the cache on, dir is created if it does not exist
+Status set_cache_dir(const char *dir)
+{
+    if(mkdir(dir, 0777) != 0 && errno != EEXIST)
+    {
+        perror("mkdir");
+        fprintf(stderr, "ERROR: Unable to create directory %s\n", dir);
+        return e_failure;
+    }
+    cache.dir = (char *)dir;
+    return e_success;
+}
+
+// Function to feed a whole file and its size to a hash
+static Status hash_cache_file(CacheHash *hash, const char *fname)
+{
+    long size = 0, count;
+    char *buffer = get_pool_buffer(POOL_IO_BUFFER_SIZE);
+    FILE *fptr = fopen(fname, "r");
+
+    if(buffer == NULL || fptr == NULL)
+    {
+        put_pool_buffer(buffer);
+        if(fptr) fclose(fptr);
+        return e_failure;
+    }
+    while((count = fread(buffer, 1, POOL_IO_BUFFER_SIZE, fptr)) > 0)
+    {
+        update_cache_hash(hash, buffer, count);
+        size += count;
+    }
+    update_cache_hash(hash, &size, sizeof(size));
+    put_pool_buffer(buffer);
+    fclose(fptr);
+    return e_success;
+}
+
+// Function to copy a file with plain reads and writes
+static Status copy_cache_file(int in, int out)
+{
+    char *buffer = get_pool_buffer(POOL_IO_BUFFER_SIZE);
+    ssize_t count;
+    Status ret = buffer ? e_success : e_failure;
+
+    while(ret == e_success && (count = read(in, buffer, POOL_IO_BUFFER_SIZE)) != 0)
+    {
+        if(count < 0 || write(out, buffer, count) != count)
+        {
+            ret = e_failure;
+        }
+    }
+    put_pool_buffer(buffer);
+    return ret;
+}
+
+// Function to make 'to' a new file with the contents of 'from': reflink, else plain copy, never a hard link,
+// written under a temporary name and renamed into place; returns how, NULL if it failed
+static const char *copy_cache_entry(const char *from, const char *to, mode_t mode)
+{
+    char temp[PATH_MAX];
+    const char *method = NULL;
+
+    // STEP1: A temporary name next to 'to', readers never see a partial file
+    snprintf(temp, sizeof(temp), "%s.%d.part", to, (int)getpid());
+    int in = open(from, O_RDONLY);
+    if(in < 0)
+    {
+        return NULL;
+    }
+    int out = open(temp, O_WRONLY | O_CREAT | O_TRUNC, mode);
+    if(out < 0)
+    {
+        close(in);
+        return NULL;
+    }
+
+    // STEP2: Reflink, shares the blocks copy-on-write but not the inode, else a copy
+    if(ioctl(out, FICLONE, in) == 0)
+    {
+        method = "reflinked";
+    }
+    else if(copy_cache_file(in, out) == e_success)
+    {
+        method = "copied";
+    }
+    if(close(out) != 0)
+    {
+        method = NULL;
+    }
+    close(in);
+
+    // STEP3: Replace what is there, like a normal encode would
+    if(method == NULL || rename(temp, to) != 0)
+    {
+        unlink(temp);
+        return NULL;
+    }
+    return method;
+}
+
+// Function to compute the key of an encode job, hit -> output copied from the cache
+Status lookup_encode_cache(EncodeInfo *encInfo)
+{
+    char entry[PATH_MAX];
+    CacheHash hash;
+
+    // STEP1: Only with --cache, a resumable job keeps its partial output and files handed in open (-T) have no name to hash
+    encInfo->cache_key[0] = '\0';
+    if(cache.dir == NULL || encInfo->journal.enabled || encInfo->fptr_src_image)
+    {
+        return e_failure;
+    }
+
+    // STEP2: Key from the options that change the output, the extension and both files, a secret without one is not cached
+    long options[] = { CACHE_VERSION, encInfo->fec_parity, encInfo->lsb_bits, encInfo->lsb_channels, encInfo->lsb_msb_first };
+    const char *extn = get_secret_extension(encInfo->secret_fname);
+    if(extn == NULL)
+    {
+        return e_failure;
+    }
+    start_cache_hash(&hash);
+    update_cache_hash(&hash, options, sizeof(options));
+    update_cache_hash(&hash, extn, strlen(extn) + 1);
+    if(hash_cache_file(&hash, encInfo->src_image_fname) == e_failure || hash_cache_file(&hash, encInfo->secret_fname) == e_failure)
+    {
+        return e_failure;
+    }
+    finish_cache_hash(&hash, encInfo->cache_key);
+
+    // STEP3: Miss -> the encode writes a new inode, never through an output hard linked by an older cache
+    snprintf(entry, sizeof(entry), "%s/%s.bmp", cache.dir, encInfo->cache_key);
+    if(access(entry, R_OK) != 0)
+    {
+        printf("INFO: Cache miss %s.\n\n", encInfo->cache_key);
+        unlink(encInfo->stego_image_fname);
+        return e_failure;
+    }
+
+    // STEP4: Hit -> most recently used, the output comes from the entry
+    utimensat(AT_FDCWD, entry, NULL, 0);
+    const char *method = copy_cache_entry(entry, encInfo->stego_image_fname, 0666);
+    if(method == NULL)
+    {
+        printf("INFO: Cache hit %s, but the output could not be copied!\n\n", encInfo->cache_key);
+        return e_failure;
+    }
+    printf("INFO: Cache hit %s, the output is %s from the cache.\n\n", encInfo->cache_key, method);
+    return e_success;
+}
+
+// Entry of the cache directory while evicting
+typedef struct
+{
+    char name[CACHE_KEY_SIZE + 8];
+    long size;
+    struct timespec mtime;
+} CacheEntry;
+
+// Function to order entries least recently used first
+static int compare_cache_entries(const void *a, const void *b)
+{
+    const struct timespec *x = &((const CacheEntry *)a)->mtime, *y = &((const CacheEntry *)b)->mtime;
+    return x->tv_sec != y->tv_sec ? (x->tv_sec < y->tv_sec ? -1 : 1) : (x->tv_nsec < y->tv_nsec ? -1 : x->tv_nsec > y->tv_nsec);
+}
+
+// Function to remove the least recently used entries until the cache fits max_size
+static void evict_cache_entries(void)
+{
+    char fname[PATH_MAX];
+    CacheEntry *entries = NULL;
+    long count = 0, allocated = 0, total = 0;
+    struct stat st;
+
+    // STEP1: Every entry with its size and last use
+    DIR *dir = opendir(cache.dir);
+    if(dir == NULL)
+    {
+        return;
+    }
+    for(struct dirent *dirent = readdir(dir); dirent; dirent = readdir(dir))
+    {
+        snprintf(fname, sizeof(fname), "%s/%s", cache.dir, dirent->d_name);
+        if(strlen(dirent->d_name) != CACHE_KEY_SIZE + 4 || strcmp(dirent->d_name + CACHE_KEY_SIZE, ".bmp") != 0 ||
+           stat(fname, &st) != 0)
+        {
+            continue;
+        }
+        if(count == allocated)
+        {
+            allocated = allocated ? allocated * 2 : 256;
+            CacheEntry *grown = realloc(entries, allocated * sizeof(CacheEntry));
+            if(grown == NULL)
+            {
+                break;
+            }
+            entries = grown;
+        }
+        strcpy(entries[count].name, dirent->d_name);
+        entries[count].size = st.st_size;
+        entries[count].mtime = st.st_mtim;
+        total += st.st_size;
+        count++;
+    }
+    closedir(dir);
+
+    // STEP2: Oldest first until it fits, the entry just added is the newest
+    if(total > cache.max_size)
+    {
+        qsort(entries, count, sizeof(CacheEntry), compare_cache_entries);
+        for(long i = 0; i < count && total > cache.max_size; i++)
+        {
+            snprintf(fname, sizeof(fname), "%s/%s", cache.dir, entries[i].name);
+            if(unlink(fname) == 0 || errno == ENOENT)
+            {
+                total -= entries[i].size;
+            }
+        }
+    }
+    free(entries);
+}
+
+// Function to close the output of a finished encode and add it to the cache
+Status store_encode_cache(EncodeInfo *encInfo)
+{
+    char entry[PATH_MAX];
+
+    if(cache.dir == NULL || encInfo->cache_key[0] == '\0')
+    {
+        return e_success;
+    }
+
+    // STEP1: The output must be complete before it is shared
+    int ret = fclose(encInfo->fptr_stego_image);
+    encInfo->fptr_stego_image = NULL;
+    if(ret != 0)
+    {
+        fprintf(stderr, "ERROR: Unable to write file %s\n", encInfo->stego_image_fname);
+        return e_failure;
+    }
+
+    // STEP2: A read-only copy of its own, the caller's output is left as it is; a failure here does not fail the encode
+    snprintf(entry, sizeof(entry), "%s/%s.bmp", cache.dir, encInfo->cache_key);
+    if(copy_cache_entry(encInfo->stego_image_fname, entry, 0444) == NULL)
+    {
+        printf("INFO: The output could not be added to the cache %s!\n\n", cache.dir);
+        return e_success;
+    }
+    printf("INFO: The output is added to the cache as %s.\n\n", encInfo->cache_key);
+
+    // STEP3: Keep the cache within --cache-size
+    evict_cache_entries();
+    return e_success;
+}
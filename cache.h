@@ -0,0 +1,71 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <stdint.h>
+#include "types.h" // Contains user defined types
+#include "encode.h"
+
+/*
+ * Content addressed cache of encode results (--cache dir, --cache-size bytes)
+ *
+ * The key is a 128 bit hash of the carrier file, the secret file, the
+ * secret extension and every option that changes the output (--fec,
+ * --bits, --channels, --msb-first); --verify, --direct and the kernel do
+ * not. On a hit the output is reflinked from dir/<key>.bmp, or copied if
+ * the filesystem can not reflink, and do_encoding() skips the encode
+ * steps. On a miss the closed output is copied into the cache the same
+ * way. Outputs and entries never share an inode, so changing an output
+ * in place (-a) leaves the cache and every other output alone.
+ *
+ * Entries are read-only. A hit touches the entry's mtime, and after
+ * every insert the oldest entries are removed until the cache fits
+ * --cache-size (LRU). Entries and outputs are written under a temporary
+ * name and renamed into place, so the runner and watch workers can
+ * share one cache. --journal jobs, the
+ * chunks of a split encode and the members of a tar stream (-T) bypass it.
+ *
+ * The hash is not cryptographic: only use a cache directory whose
+ * inputs you trust
+ */
+
+#define CACHE_DEFAULT_MAX_SIZE (1024L * 1024 * 1024)    // 1 GiB
+#define CACHE_KEY_SIZE 32               // Hex digits of the key
+#define CACHE_VERSION 1                 // Part of every key, bump when the stream format changes
+
+typedef struct _CacheHash
+{
+    uint64_t acc[4];            // One accumulator per 8 byte lane of a 32 byte stripe
+    unsigned char stripe[32];   // Bytes not hashed yet
+    int buffered;
+    uint64_t length;
+
+} CacheHash;
+
+typedef struct _CacheInfo
+{
+    char *dir;                  // Cache directory (--cache), NULL if off
+    long max_size;              // Bytes the entries may take (--cache-size)
+
+} CacheInfo;  // Datatype of the structure
+
+/* Cache of the current process, set once from the command line */
+extern CacheInfo cache;
+
+
+/* Cache function prototype */
+
+/* Start, feed and finish a hash, the digest is CACHE_KEY_SIZE hex digits */
+void start_cache_hash(CacheHash *hash);
+void update_cache_hash(CacheHash *hash, const void *data, long size);
+void finish_cache_hash(CacheHash *hash, char *key);
+
+/* Turn the cache on, dir is created if it does not exist */
+Status set_cache_dir(const char *dir);
+
+/* Compute the key of an encode job, hit -> output linked from the cache and e_success */
+Status lookup_encode_cache(EncodeInfo *encInfo);
+
+/* Close the output of a finished encode and add it to the cache, evicting the oldest entries */
+Status store_encode_cache(EncodeInfo *encInfo);
+
+#endif
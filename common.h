@@ -4,4 +4,16 @@
 /* Magic string to identify whether stegged or not */
 #define MAGIC_STRING "#*"
 
+/* Magic string to identify a multi-entry archive carrier */
+#define ARCHIVE_MAGIC_STRING "#@"
+
+/* Magic string to identify a carrier encoded with --fec */
+#define FEC_MAGIC_STRING "#%"
+
+/* Number of secret bytes embedded/extracted per block (8 image bytes each) */
+#define MAX_BLOCK_SIZE 4096
+
+/* Seconds to pause between encode/decode steps, 0 for batch workers */
+extern unsigned int step_delay;
+
 #endif
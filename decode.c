@@ -4,14 +4,27 @@
 #include <unistd.h>
 // User-defined header files
 #include "decode.h"
+#include "lsb_kernel.h"
+#include "probes.h"
+#include "fec.h"
 #include "types.h"
 #include "common.h"
+#include "admission.h"
+#include "progress.h"
+#include "pool.h"
+#include "lsb_mode.h"
+#include "layout_probe.h"
 
 /* Function Definitions */
 
 // Function to open the source image file for decoding
 Status open_source_file(DecodeInfo *decInfo)
 {
+    // An image handed in open (a tar stream member in memory, see tar_stream.h) is used as it is
+    if(decInfo->fptr_enc_image)
+    {
+        return e_success;
+    }
     // Open the source image
     decInfo->fptr_enc_image = fopen(decInfo->enc_image_fname, "r");
     // If the file could not be opened, return e_failure
@@ -29,8 +42,13 @@ Status open_source_file(DecodeInfo *decInfo)
 // Function to open the output file for storing decoded data
 Status open_output_file(DecodeInfo *decInfo)
 {
-    // Open the secret output file
-    decInfo->fptr_secret = fopen(decInfo->secret_fname, "w");
+    // An output handed in open (a tar stream member in memory) is used as it is
+    if(decInfo->fptr_secret)
+    {
+        return e_success;
+    }
+    // Open the secret output file, kept (not truncated) when resuming from a journal
+    decInfo->fptr_secret = fopen(decInfo->secret_fname, decInfo->journal.resumed ? "r+" : "w");
     // If the file could not be opened, return e_failure
     if (decInfo->fptr_secret == NULL)
     {
@@ -54,8 +72,8 @@ Status read_and_validate_decode_args(int argc, char *argv[], DecodeInfo *decInfo
         return e_failure;
     }
 
-    // STEP3: Allocate memory dynamically and store the arguments into respective structure member
-    decInfo->enc_image_fname = malloc(strlen(argv[2]) + 1);
+    // STEP3: Allocate memory from the job arena and store the arguments into respective structure member
+    decInfo->enc_image_fname = arena_alloc(strlen(argv[2]) + 1);
     if (!decInfo->enc_image_fname)
     {
         // If memory allocation fails. return e_failure
@@ -63,27 +81,97 @@ Status read_and_validate_decode_args(int argc, char *argv[], DecodeInfo *decInfo
     }
     strcpy(decInfo->enc_image_fname, argv[2]);
 
-    // STEP4: Assign default name to output file if not provided and store it in structure
-    // STEP5: If output file name provided, GoTo STEP6
+    // STEP4: Collect the output file name and options (--range offset:length, --journal, --bits k, --channels list, --msb-first, --no-probe)
+    char *output_name = NULL;
+    for(int i = 3; i < argc; i++)
+    {
+        if(strcmp(argv[i], "--range") == 0)
+        {
+            if(i + 1 >= argc || sscanf(argv[i + 1], "%ld:%ld", &decInfo->range_offset, &decInfo->range_length) != 2 ||
+               decInfo->range_offset < 0 || decInfo->range_length <= 0)
+            {
+                printf("INFO: Give the range as --range offset:length!\n\n");
+                return e_failure;
+            }
+            decInfo->range_selected = 1;
+            i++;
+        }
+        else if(strcmp(argv[i], "--journal") == 0)
+        {
+            decInfo->journal.enabled = 1;
+        }
+        else if(strcmp(argv[i], "--bits") == 0)
+        {
+            if(parse_lsb_bits(i + 1 < argc ? argv[++i] : NULL, &decInfo->lsb_bits) == e_failure)
+            {
+                return e_failure;
+            }
+        }
+        else if(strcmp(argv[i], "--channels") == 0)
+        {
+            if(parse_lsb_channels(i + 1 < argc ? argv[++i] : NULL, &decInfo->lsb_channels) == e_failure)
+            {
+                return e_failure;
+            }
+        }
+        else if(strcmp(argv[i], "--msb-first") == 0)
+        {
+            decInfo->lsb_msb_first = 1;
+        }
+        else if(strcmp(argv[i], "--no-probe") == 0)
+        {
+            decInfo->no_probe = 1;
+        }
+        else if(output_name == NULL && argv[i][0] != '-')
+        {
+            output_name = argv[i];
+        }
+        else
+        {
+            return e_failure;
+        }
+    }
+    if(decInfo->range_selected && decInfo->journal.enabled)
+    {
+        printf("INFO: --journal can not be combined with --range!\n\n");
+        return e_failure;
+    }
+    if(decInfo->lsb_bits || decInfo->lsb_channels || decInfo->lsb_msb_first)
+    {
+        if(decInfo->range_selected || decInfo->journal.enabled || decInfo->no_probe)
+        {
+            printf("INFO: --bits, --channels and --msb-first can not be combined with --range, --journal or --no-probe!\n\n");
+            return e_failure;
+        }
+        decInfo->lsb_bits = decInfo->lsb_bits ? decInfo->lsb_bits : 1;
+        decInfo->lsb_channels = decInfo->lsb_channels ? decInfo->lsb_channels : LSB_MODE_DEFAULT_CHANNELS;
+    }
+
+    // STEP5: Assign default name to output file if not provided and store it in structure
+    // STEP6: If output file name provided, GoTo STEP7
     char default_name[] = "Decoded_file";
-    if(argc < 4)
+    if(output_name == NULL)
     {
         printf("INFO: 'Decoded_file' has been taken as default name for output file.\n\n");
-        sleep(1);
-        decInfo->secret_fname = malloc(strlen(default_name) + 1);
+        sleep(step_delay);
+        decInfo->secret_fname = arena_alloc(strlen(default_name) + 1);
+        if (!decInfo->secret_fname)
+        {
+            return e_failure;
+        }
         strcpy(decInfo->secret_fname, default_name);
     }
     else
     {
-        // STEP6: Allocate memory according to the provided output file name
-        // STEP7: Store the name into the structure
-        decInfo->secret_fname = malloc(strlen(argv[3]) + 1);
+        // STEP7: Allocate memory according to the provided output file name
+        // STEP8: Store the name into the structure
+        decInfo->secret_fname = arena_alloc(strlen(output_name) + 1);
         if (!decInfo->secret_fname)
         {
             // If memory allocation fails. return e_failure
             return e_failure;
         }
-        strcpy(decInfo->secret_fname, argv[3]);
+        strcpy(decInfo->secret_fname, output_name);
     }
 
     // If all validations pass, return e_success
@@ -111,26 +199,137 @@ void decode_lsb_to_byte(char *data, char *image_buffer)
 // Function to decode hidden data from the encoded image file into the output file
 Status decode_image_to_data(DecodeInfo *decInfo)
 {
-    char arr[8]; 
-    char *data;
+    // The whole secret is the range from its first byte, decoded block by block
+    return decode_image_range(decInfo, 0, decInfo->size_secret_file);
+}
+
+// Function to decode a block of data from image, tracing every read and kernel call with the image and secret offsets
+Status decode_image_to_block_at(char *data, long size, FILE *fptr_enc_image, long image_offset, long secret_offset)
+{
+    char arr[MAX_BLOCK_SIZE * 8];
+    size_t done;
 
-    for(int i = 0; i < decInfo->size_secret_file; i++)
+    while(size > 0)
     {
-        // STEP1: Read 8 byte of data from source file and store it one array
-        fread(arr, 1, 8, decInfo->fptr_enc_image);
+        // STEP1: Take at most MAX_BLOCK_SIZE bytes of data in this pass
+        long block = size < MAX_BLOCK_SIZE ? size : MAX_BLOCK_SIZE;
+
+        // STEP2: Read 8 bytes of image data for every byte of the block
+        PROBE4(io__submit, progress.job_id, PROBE_IO_READ, image_offset, block * 8);
+        done = fread(arr, 1, block * 8, fptr_enc_image);
+        PROBE4(io__complete, progress.job_id, PROBE_IO_READ, image_offset, done);
+        if(done != (size_t)(block * 8))
+        {
+            return e_failure;
+        }
+
+        // STEP3: Decode each group of 8 image bytes back into one byte
+        PROBE3(extract__enter, progress.job_id, secret_offset, block);
+        decode_lsb_to_bytes(data, block, arr);
+        PROBE3(extract__leave, progress.job_id, secret_offset, block);
+
+        data += block;
+        size -= block;
+        image_offset += block * 8;
+        secret_offset += block;
+    }
+    return e_success;
+}
+
+// Generic function to decode a block of data from image, MAX_BLOCK_SIZE bytes per read
+Status decode_image_to_block(char *data, long size, FILE *fptr_enc_image)
+{
+    // Callers that do not track the offsets trace them as -1
+    return decode_image_to_block_at(data, size, fptr_enc_image, -1, -1);
+}
 
-        // STEP2: Call decode_lsb_to_byte(data, arr);
-        decode_lsb_to_byte(decInfo->secret_data, arr);
+// Function to decode a byte range of the secret data into the output file
+Status decode_image_range(DecodeInfo *decInfo, long offset, long length)
+{
+    char data[MAX_BLOCK_SIZE];
+    size_t done;
 
-        // STEP3: Write the decoded data to destination file (output.bmp)
-        fwrite(decInfo->secret_data, 1, 1, decInfo->fptr_secret);
+    // STEP1: The range must lie inside the secret data
+    if(offset < 0 || length < 0 || offset > decInfo->size_secret_file || length > decInfo->size_secret_file - offset)
+    {
+        printf("INFO: The range %ld:%ld is outside the secret data of %ld bytes!\n\n", offset, length, decInfo->size_secret_file);
+        return e_failure;
     }
-    // STEP4: Repeat this process for length of data times (size) 
 
-    // Return e_success if all functions are completed successfully
+    // STEP2: Byte i of the secret sits at a fixed image offset, seek straight to it
+    fseek(decInfo->fptr_enc_image, decInfo->data_offset + offset * 8, SEEK_SET);
+
+    // A --range output starts at its first byte, a whole or resumed secret at the byte it has reached
+    long output_offset = decInfo->range_selected ? 0 : offset;
+
+    // STEP3: Decode the range block by block and write it to the output file
+    start_progress_stage("data", offset + length);
+    while(length > 0)
+    {
+        long block = length < MAX_BLOCK_SIZE ? length : MAX_BLOCK_SIZE;
+        if(decode_image_to_block_at(data, block, decInfo->fptr_enc_image, decInfo->data_offset + offset * 8, offset) == e_failure)
+        {
+            return e_failure;
+        }
+        PROBE4(io__submit, progress.job_id, PROBE_IO_WRITE, output_offset, block);
+        done = fwrite(data, 1, block, decInfo->fptr_secret);
+        PROBE4(io__complete, progress.job_id, PROBE_IO_WRITE, output_offset, done);
+        if(done != (size_t)block)
+        {
+            return e_failure;
+        }
+        length -= block;
+        offset += block;
+        output_offset += block;
+
+        // STEP4: With --journal, checkpoint every JOURNAL_INTERVAL_BLOCKS blocks
+        if(update_journal(&decInfo->journal, decInfo->fptr_secret, decInfo->data_offset + offset * 8, offset) == e_failure)
+        {
+            return e_failure;
+        }
+
+        // STEP5: Report progress, stop here if the job was cancelled (checkpointed, so --journal resumes here)
+        if(report_progress(offset) == e_failure)
+        {
+            printf("INFO: Cancelled at secret byte %ld!\n\n", offset);
+            if(decInfo->journal.enabled)
+            {
+                write_journal(&decInfo->journal, decInfo->fptr_secret, ftell(decInfo->fptr_enc_image), offset);
+            }
+            return e_failure;
+        }
+    }
     return e_success;
 }
 
+// Function to decode the secret data from the journal checkpoint (the start for a new journal)
+Status resume_decoding(DecodeInfo *decInfo)
+{
+    JournalInfo *journal = &decInfo->journal;
+
+    // STEP1: A new journal starts at the first data byte
+    if(!journal->resumed)
+    {
+        journal->data_offset = 0;
+        return decode_image_range(decInfo, 0, decInfo->size_secret_file);
+    }
+
+    // STEP2: Checkpoint must lie on a block of this secret's data
+    fseek(decInfo->fptr_secret, 0, SEEK_END);
+    if(journal->data_offset > decInfo->size_secret_file ||
+       journal->image_offset != decInfo->data_offset + journal->data_offset * 8 ||
+       ftell(decInfo->fptr_secret) < journal->data_offset)
+    {
+        printf("INFO: The journal does not match this job, delete %s to start over!\n\n", journal->journal_fname);
+        return e_failure;
+    }
+
+    // STEP3: Continue writing the output after the bytes already decoded
+    fseek(decInfo->fptr_secret, journal->data_offset, SEEK_SET);
+    printf("INFO: First %ld bytes of secret data already decoded.\n\n", journal->data_offset);
+    return decode_image_range(decInfo, journal->data_offset, decInfo->size_secret_file - journal->data_offset);
+}
+
 // Function to decode and validate the magic string 
 Status decode_magic_string(const char *magic_string, FILE *fptr_enc_image)
 {
@@ -140,11 +339,16 @@ Status decode_magic_string(const char *magic_string, FILE *fptr_enc_image)
     char mgc_string[3];
     char data;
 
-    // Loop to decode each character of the magic string
+    size_t done;
+
+    // Loop to decode each character of the magic string, every caller reads it from byte 54
     for(int i = 0; i < 2; i++)
     {
         // Read 8 bytes from the encoded image, if not successful print error
-        if(fread(arr, 1, 8, fptr_enc_image) != 8)
+        PROBE4(io__submit, progress.job_id, PROBE_IO_READ, 54 + i * 8, 8);
+        done = fread(arr, 1, 8, fptr_enc_image);
+        PROBE4(io__complete, progress.job_id, PROBE_IO_READ, 54 + i * 8, done);
+        if(done != 8)
         {
             fprintf(stderr, "Failed to read data from the file!");
             return e_failure;
@@ -192,14 +396,23 @@ Status decode_extn_size(DecodeInfo *decInfo)
 {
     // Array to hold 32 bytes read from the image
     char arr[32];
+    long image_offset = 54 + strlen(MAGIC_STRING) * 8;
     // Read 32 bytes from the encoded image; if unsuccessful, print error
-    if(fread(arr, 1, 32, decInfo->fptr_enc_image) != 32)
+    PROBE4(io__submit, progress.job_id, PROBE_IO_READ, image_offset, 32);
+    size_t done = fread(arr, 1, 32, decInfo->fptr_enc_image);
+    PROBE4(io__complete, progress.job_id, PROBE_IO_READ, image_offset, done);
+    if(done != 32)
     {
         fprintf(stderr, "Failed to read data from the file!");
         return e_failure;
     }
     // Decode the LSBs from arr to obtain the extension size
     decode_size_from_lsb(&decInfo->extn_file_size, arr);
+    // Untrusted field, check it before it sizes anything
+    if(admit_extn_size(decInfo->extn_file_size, decInfo->fptr_enc_image) == e_failure)
+    {
+        return e_failure;
+    }
     // If all operations are done return e_success
     return e_success;
 }
@@ -211,22 +424,54 @@ Status decode_secret_file_extn(DecodeInfo *decInfo)
     char arr[8], data;
     int read, write;
 
-    // Allocate memory for the decoded extension based on its size
-    decInfo->extn_secret_file = malloc(decInfo->extn_file_size);
+    // Allocate memory for the decoded extension based on its size, plus the terminator
+    if(admit_allocation(decInfo->extn_file_size + 1) == e_failure)
+    {
+        return e_failure;
+    }
+    decInfo->extn_secret_file = arena_alloc(decInfo->extn_file_size + 1);
+    if(!decInfo->extn_secret_file)
+    {
+        return e_failure;
+    }
 
-    // Loop to decode each character of the file extension
+    // Loop to decode each character of the file extension, it follows the magic string and its size
+    long image_offset = 54 + strlen(MAGIC_STRING) * 8 + 32;
     for(int i = 0; i < decInfo->extn_file_size; i++)
     {
         // STEP1: Read 8 byte of data from source file and store it one array
+        PROBE4(io__submit, progress.job_id, PROBE_IO_READ, image_offset + i * 8, 8);
         read = fread(arr, 1, 8, decInfo->fptr_enc_image);
+        PROBE4(io__complete, progress.job_id, PROBE_IO_READ, image_offset + i * 8, read);
+        if(read != 8)
+        {
+            return e_failure;
+        }
         // STEP2: Call decode_byte_to_lsb(data[0], arr);
         decode_lsb_to_byte(&data, arr);
         // STEP3: Store decoded character in extension structure variable
         decInfo->extn_secret_file[i] = data;
     }
+    decInfo->extn_secret_file[decInfo->extn_file_size] = '\0';
+
+    // Return e_success if all functions are completed
+    return add_secret_file_extn(decInfo);
+}
 
-    // Resize the filename to add the decoded file extension
-    decInfo->secret_fname = realloc(decInfo->secret_fname, strlen(decInfo->secret_fname) + decInfo->extn_file_size);
+// Function to add the decoded extension to the output file name
+Status add_secret_file_extn(DecodeInfo *decInfo)
+{
+    // Copy the filename into a longer arena block to add the decoded file extension
+    if(admit_allocation(decInfo->extn_file_size) == e_failure)
+    {
+        return e_failure;
+    }
+    char *secret_fname = arena_alloc(strlen(decInfo->secret_fname) + decInfo->extn_file_size + 1);
+    if(!secret_fname)
+    {
+        return e_failure;
+    }
+    decInfo->secret_fname = strcpy(secret_fname, decInfo->secret_fname);
 
     // Add the decoded file extension to the secret filename if not already present
     if(strstr(decInfo->secret_fname, decInfo->extn_secret_file) == NULL)
@@ -243,20 +488,81 @@ Status decode_secret_file_size(DecodeInfo *decInfo)
 {
     // Array to hold 32 bytes read from the image
     char arr[32];
+    long image_offset = 54 + strlen(MAGIC_STRING) * 8 + 32 + decInfo->extn_file_size * 8;
 
     // Read 32 bytes from the encoded image; if unsuccessful, print error
-    if(fread(arr, 1, 32, decInfo->fptr_enc_image) != 32)
+    PROBE4(io__submit, progress.job_id, PROBE_IO_READ, image_offset, 32);
+    size_t done = fread(arr, 1, 32, decInfo->fptr_enc_image);
+    PROBE4(io__complete, progress.job_id, PROBE_IO_READ, image_offset, done);
+    if(done != 32)
     {
         fprintf(stderr, "Failed to read data from the file!");
         return e_failure;
     }
     // Decode the LSBs from arr to obtain the secret file size
     decode_size_from_lsb(&decInfo->size_secret_file, arr);
+    // Secret data starts right after the size
+    decInfo->data_offset = image_offset + 32;
+
+    // Untrusted field, the data must fit the image and the bytes to decode the budget
+    if(admit_secret_size(decInfo->size_secret_file, decInfo->fptr_enc_image) == e_failure ||
+       admit_output_bytes(decInfo->range_selected ? decInfo->range_length : decInfo->size_secret_file) == e_failure)
+    {
+        return e_failure;
+    }
 
     // Return e_success if all functions are completed
     return e_success;
 }
 
+// Function to decode the extension size, extension and secret size after the magic string
+static Status decode_stream_header(DecodeInfo *decInfo)
+{
+    sleep(step_delay);
+    // Call decode_extn_size()
+    // Check returned e_success or e_failure
+    // if not e_success print error msg, then return e_failure
+    if(decode_extn_size(decInfo) == e_success)
+    {
+        printf("INFO: The size of extension has successfully been decoded.\n\n");
+    }
+    else
+    {
+        printf("INFO: The size of extension could not be decoded!\n\n");
+        return e_failure;
+    }
+
+    sleep(step_delay);
+    // Call decode_secret_file_extn()
+    // Check returned e_success or e_failure
+    // if not e_success print error msg, then return e_failure
+    if(decode_secret_file_extn(decInfo) == e_success)
+    {
+        printf("INFO: The extension has successfully been decoded.\n\n");
+    }
+    else
+    {
+        printf("INFO: The extension could not be decoded!\n\n");
+        return e_failure;
+    }
+
+    sleep(step_delay);
+    // Call decode_secret_file_size(), the whole header is admitted before the output is created
+    // Check returned e_success or e_failure
+    // if not e_success print error msg, then return e_failure
+    if(decode_secret_file_size(decInfo) == e_success)
+    {
+        printf("INFO: The size of secret file has successfully been decoded.\n\n");
+    }
+    else
+    {
+        printf("INFO: The size of secret file could not be decoded!\n\n");
+        return e_failure;
+    }
+
+    return e_success;
+}
+
 // Function to check if decoding was successful by comparing decoded and original file sizes
 Status check_successful_decoding(DecodeInfo *decInfo)
 {
@@ -265,8 +571,9 @@ Status check_successful_decoding(DecodeInfo *decInfo)
     // Use ftell to get the end position of the file 
     decInfo->size_output_file = ftell(decInfo->fptr_secret);
 
-    // If the decoded file size matches the original secret file size, return e_success
-    if(decInfo->size_secret_file == decInfo->size_output_file)
+    // If the decoded file size matches the original secret file size (or range length), return e_success
+    long expected_size = decInfo->range_selected ? decInfo->range_length : decInfo->size_secret_file;
+    if(expected_size == decInfo->size_output_file)
     {
         return e_success;
     }
@@ -275,10 +582,10 @@ Status check_successful_decoding(DecodeInfo *decInfo)
 }
 
 
-Status do_decoding(DecodeInfo *decInfo)
+static Status run_decoding_steps(DecodeInfo *decInfo)
 {
     // STEP1: Call open_dfiles function
-    sleep(1); // Use sleep to delay the display of next printf
+    sleep(step_delay); // Use sleep to delay the display of next printf
     if(open_source_file(decInfo) == e_success)
     {
         printf("INFO: Source file is opened successfully.\n\n");
@@ -289,51 +596,77 @@ Status do_decoding(DecodeInfo *decInfo)
         return e_failure;
     }
 
-    sleep(1);
+    // The header size is only known once it is decoded
+    start_progress_stage("header", 0);
+    sleep(step_delay);
+    // No layout flags -> probe the known layouts, --range, --journal and --no-probe only read the default one
+    if(!decInfo->lsb_bits && !decInfo->range_selected && !decInfo->journal.enabled && !decInfo->no_probe &&
+       probe_stream_layout(decInfo) == e_failure)
+    {
+        printf("INFO: The magic string does not match!\n\n");
+        return e_failure;
+    }
     // Set the file pointer to encoded image to after the header part
     fseek(decInfo->fptr_enc_image, 54, SEEK_SET);
-    // Call decode_magic_string()
+    // --bits/--channels/--msb-first or a probed layout -> magic string and header fields through that layout
+    // Else call decode_magic_string()
     // Check returned e_success or e_failure
     // if not e_success print error msg, then return e_failure
-    if(decode_magic_string(MAGIC_STRING, decInfo->fptr_enc_image) == e_success)
+    if(decInfo->lsb_bits)
+    {
+        if(decode_mode_stream(decInfo) == e_failure)
+        {
+            printf("INFO: The stream header could not be decoded!\n\n");
+            return e_failure;
+        }
+    }
+    else if(decode_magic_string(MAGIC_STRING, decInfo->fptr_enc_image) == e_success)
     {
         printf("INFO: The magic string has successfully matched.\n\n");
     }
+    // A carrier encoded with --fec has its own magic string at the same offset
+    else if(fseek(decInfo->fptr_enc_image, 54, SEEK_SET) == 0 &&
+            decode_magic_string(FEC_MAGIC_STRING, decInfo->fptr_enc_image) == e_success)
+    {
+        printf("INFO: The FEC magic string has successfully matched.\n\n");
+        decInfo->fec_carrier = 1;
+    }
     else
     {
         printf("INFO: The magic string does not match!\n\n");
         return e_failure;
     }
 
-    sleep(1);
-    // Call decode_extn_size()
-    // Check returned e_success or e_failure
-    // if not e_success print error msg, then return e_failure
-    if(decode_extn_size(decInfo) == e_success)
+    // Plain carrier -> the header fields one by one, FEC carrier -> the whole stream is read and repaired first
+    if(decInfo->lsb_bits)
     {
-        printf("INFO: The size of extension has successfully been decoded.\n\n");
+        printf("INFO: The stream header has successfully been decoded.\n\n");
     }
-    else
+    else if(decInfo->fec_carrier)
     {
-        printf("INFO: The size of extension could not be decoded!\n\n");
-        return e_failure;
+        sleep(step_delay);
+        if(decode_fec_stream(decInfo) == e_success)
+        {
+            printf("INFO: The FEC stream has successfully been decoded.\n\n");
+        }
+        else
+        {
+            printf("INFO: The FEC stream could not be decoded!\n\n");
+            return e_failure;
+        }
     }
-
-    sleep(1);
-    // Call decode_secret_file_extn()
-    // Check returned e_success or e_failure
-    // if not e_success print error msg, then return e_failure
-    if(decode_secret_file_extn(decInfo) == e_success)
+    else if(decode_stream_header(decInfo) == e_failure)
     {
-        printf("INFO: The extension has successfully been decoded.\n\n");
+        return e_failure;
     }
-    else
+
+    // Open the journal (--journal) now that the output name has its extension
+    if(decInfo->journal.enabled && open_journal(&decInfo->journal, decInfo->secret_fname) == e_failure)
     {
-        printf("INFO: The extension could not be decoded!\n\n");
         return e_failure;
     }
 
-    sleep(1);
+    sleep(step_delay);
     // Call open_output_file()
     // Check returned e_success or e_failure
     // if not e_success print error msg, then return e_failure
@@ -347,25 +680,29 @@ Status do_decoding(DecodeInfo *decInfo)
         return e_failure;
     }
 
-    sleep(1);
-    // Call decode_secret_file_size()
+    sleep(step_delay);
+    // Call decode_image_range() if a range is selected or journaling, else decode_image_to_data()
     // Check returned e_success or e_failure
     // if not e_success print error msg, then return e_failure
-    if(decode_secret_file_size(decInfo) == e_success)
+    Status data_status;
+    if(decInfo->lsb_bits)
     {
-        printf("INFO: The size of secret file has successfully been decoded.\n\n");
+        data_status = write_mode_data(decInfo);
+    }
+    else if(decInfo->fec_carrier)
+    {
+        data_status = write_fec_data(decInfo);
+    }
+    else if(decInfo->journal.enabled)
+    {
+        data_status = resume_decoding(decInfo);
     }
     else
     {
-        printf("INFO: The size of secret file could not be decoded!\n\n");
-        return e_failure;
+        data_status = decInfo->range_selected ? decode_image_range(decInfo, decInfo->range_offset, decInfo->range_length)
+                                              : decode_image_to_data(decInfo);
     }
-
-    sleep(1);
-    // Call decode_image_to_data()
-    // Check returned e_success or e_failure
-    // if not e_success print error msg, then return e_failure
-    if(decode_image_to_data(decInfo) == e_success)
+    if(data_status == e_success)
     {
         printf("INFO: The data of secret file has successfully been decoded.\n\n");
     }
@@ -375,7 +712,7 @@ Status do_decoding(DecodeInfo *decInfo)
         return e_failure;
     }
 
-    sleep(1);
+    sleep(step_delay);
     // Call check_successful_decoding()
     // Check returned e_success or e_failure
     // if not e_success print error msg, then return e_failure
@@ -402,6 +739,18 @@ Status do_decoding(DecodeInfo *decInfo)
         return e_failure;
     }
 
+    // Job finished, remove the journal
+    close_journal(&decInfo->journal, e_success);
+
     // return e_success if all functions have been executed successfully
     return e_success;
-}
\ No newline at end of file
+}
+
+// Function to perform all the steps of decoding, with job progress events around them
+Status do_decoding(DecodeInfo *decInfo)
+{
+    start_progress_job(decInfo->enc_image_fname);
+    Status ret = run_decoding_steps(decInfo);
+    finish_progress_job(ret);
+    return ret;
+}
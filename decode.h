@@ -2,6 +2,7 @@
 #define DECODE_H
 
 #include "types.h" // Contains user defined types
+#include "journal.h" // Checkpoint sidecar for --journal
 
 /* 
  * Structure to store information required for
@@ -29,6 +30,28 @@ typedef struct _DecodeInfo
     char secret_data[MAX_SECRET_BUF_SIZE];    // To store secret data (1 byte at a time)
     long size_secret_file;      // Original Secret file size
     long size_output_file;      // Size of decoded output file
+    long data_offset;           // Image offset of the first secret data byte
+
+    /* Byte range Info (--range offset:length) */
+    int range_selected;         // Decode only a slice of the secret data
+    long range_offset;          // First secret byte of the slice
+    long range_length;          // Number of secret bytes in the slice
+
+    /* Checkpoint and resume (--journal) */
+    JournalInfo journal;
+
+    /* Forward error correction (carrier encoded with --fec, see fec.h) */
+    int fec_carrier;            // Stream starts with FEC_MAGIC_STRING
+    char *fec_stream;           // Repaired stream, from the extension size to the end of the data (pool buffer)
+    long fec_repaired;          // Codewords that needed repair
+
+    /* Pixel aware layout (--bits k, --channels list, --msb-first, see lsb_mode.h), or the one the probe found */
+    int lsb_bits;               // Bits per channel byte, 0 for the default layout
+    int lsb_channels;           // Channel mask, 0 for a flat layout
+    int lsb_msb_first;          // Stream bits most significant first
+    long lsb_offset;            // First byte of the stream, 0 for the pixel data offset
+    int no_probe;               // --no-probe, the default layout without probing
+    struct _LsbLayout *lsb_layout;      // Layout being read (job arena)
 
 } DecodeInfo;  // Datatype of the structure
 
@@ -53,6 +76,18 @@ void decode_lsb_to_byte(char *data, char *image_buffer);
 /* Decode function, which does the real decoding */
 Status decode_image_to_data(DecodeInfo *decInfo);
 
+/* Decode a block of data from image, MAX_BLOCK_SIZE bytes at a time */
+Status decode_image_to_block(char *data, long size, FILE *fptr_enc_image);
+
+/* Same, with the image and secret offsets of the block for the trace probes */
+Status decode_image_to_block_at(char *data, long size, FILE *fptr_enc_image, long image_offset, long secret_offset);
+
+/* Decode a byte range of the secret data, reads only 8 * length image bytes */
+Status decode_image_range(DecodeInfo *decInfo, long offset, long length);
+
+/* Decode the secret data from the journal checkpoint (--journal) */
+Status resume_decoding(DecodeInfo *decInfo);
+
 /* Decode extension size */
 Status decode_extn_size(DecodeInfo *decInfo);
 
@@ -62,6 +97,9 @@ void decode_size_from_lsb(long *size, char *image_buffer);
 /* Decode secret file extenstion */
 Status decode_secret_file_extn(DecodeInfo *decInfo);
 
+/* Add the decoded extension to the output file name */
+Status add_secret_file_extn(DecodeInfo *decInfo);
+
 /* Open output dedcoding file and collect file pointers*/
 Status open_output_file(DecodeInfo *decInfo);
 
@@ -0,0 +1,212 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+// User-defined header files
+#include "direct_io.h"
+#include "pool.h"
+#include "types.h"
+
+/* Function Definitions */
+
+// Function to write count bytes of the buffer at the flushed offset, dropping back to buffered writes if O_DIRECT is refused
+static int write_direct_block(DirectInfo *out, long count)
+{
+    long done = 0;
+    while(done < count)
+    {
+        ssize_t ret = pwrite(out->fd, out->buffer + done, count - done, out->flushed + done);
+        if(ret < 0 && errno == EINVAL && out->direct)
+        {
+            // Some filesystems accept O_DIRECT on open and refuse it on write
+            fcntl(out->fd, F_SETFL, fcntl(out->fd, F_GETFL) & ~O_DIRECT);
+            out->direct = 0;
+            continue;
+        }
+        if(ret <= 0)
+        {
+            return -1;
+        }
+        done += ret;
+    }
+
+    // Buffered fallback: start writeback of this block, wait for the previous one and drop it from the cache
+    if(!out->direct)
+    {
+        sync_file_range(out->fd, out->flushed, count, SYNC_FILE_RANGE_WRITE);
+        if(out->flushed >= DIRECT_BUFFER_SIZE)
+        {
+            long previous = out->flushed - DIRECT_BUFFER_SIZE;
+            sync_file_range(out->fd, previous, DIRECT_BUFFER_SIZE,
+                            SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER);
+            posix_fadvise(out->fd, previous, DIRECT_BUFFER_SIZE, POSIX_FADV_DONTNEED);
+        }
+    }
+    return 0;
+}
+
+// Function to gather the bytes written through the FILE pointer, write them out a full buffer at a time
+static ssize_t direct_write(void *cookie, const char *data, size_t size)
+{
+    DirectInfo *out = cookie;
+    size_t done = 0;
+    while(done < size)
+    {
+        long count = DIRECT_BUFFER_SIZE - out->buffered;
+        if((size_t)count > size - done)
+        {
+            count = size - done;
+        }
+        memcpy(out->buffer + out->buffered, data + done, count);
+        out->buffered += count;
+        done += count;
+
+        if(out->buffered == DIRECT_BUFFER_SIZE)
+        {
+            if(write_direct_block(out, DIRECT_BUFFER_SIZE) != 0)
+            {
+                return done > (size_t)count ? (ssize_t)(done - count) : -1;
+            }
+            out->flushed += DIRECT_BUFFER_SIZE;
+            out->buffered = 0;
+        }
+    }
+    return done;
+}
+
+// Function to report the position, the output is append only so only the current end is a valid target
+static int direct_seek(void *cookie, off64_t *position, int whence)
+{
+    DirectInfo *out = cookie;
+    off64_t end = out->flushed + out->buffered;
+    off64_t target = whence == SEEK_SET ? *position : end + *position;
+    if(target != end)
+    {
+        errno = ESPIPE;
+        return -1;
+    }
+    *position = end;
+    return 0;
+}
+
+// Function to write the padded tail, cut the file to its real size and release everything
+static int direct_close(void *cookie)
+{
+    DirectInfo *out = cookie;
+    long size = out->flushed + out->buffered;
+    int ret = 0;
+
+    // STEP1: O_DIRECT writes whole blocks, the padding is truncated away in STEP2
+    if(out->buffered > 0)
+    {
+        long count = out->buffered;
+        if(out->direct)
+        {
+            count = (count + DIRECT_ALIGNMENT - 1) / DIRECT_ALIGNMENT * DIRECT_ALIGNMENT;
+            memset(out->buffer + out->buffered, 0, count - out->buffered);
+        }
+        ret = write_direct_block(out, count);
+    }
+
+    // STEP2: Also trims the preallocation when the job stopped early
+    if(ftruncate(out->fd, size) != 0)
+    {
+        ret = -1;
+    }
+
+    // STEP3: Buffered fallback leaves dirty pages behind, write them and drop them
+    if(!out->direct)
+    {
+        if(fdatasync(out->fd) != 0)
+        {
+            ret = -1;
+        }
+        posix_fadvise(out->fd, 0, 0, POSIX_FADV_DONTNEED);
+    }
+    if(close(out->fd) != 0)
+    {
+        ret = -1;
+    }
+    if(ret != 0)
+    {
+        fprintf(stderr, "ERROR: Unable to write file %s\n", out->fname);
+    }
+
+    // STEP4: The buffer goes back to the pool, the state lives in the job arena
+    put_pool_buffer(out->buffer);
+    return ret;
+}
+
+// Function to create fname preallocated to size bytes and return a write only FILE pointer on it
+FILE *open_direct_output(const char *fname, long size)
+{
+    // STEP1: State from the job arena, aligned buffer from the pool
+    DirectInfo *out = arena_alloc(sizeof(DirectInfo));
+    if(!out)
+    {
+        return NULL;
+    }
+    memset(out, 0, sizeof(DirectInfo));
+    out->fname = arena_strdup(fname);
+    out->buffer = get_pool_buffer(DIRECT_BUFFER_SIZE);
+    if(!out->fname || !out->buffer)
+    {
+        put_pool_buffer(out->buffer);
+        return NULL;
+    }
+
+    // STEP2: Open with O_DIRECT, or buffered if the filesystem does not support it
+    out->direct = 1;
+    out->fd = open(fname, O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT, 0666);
+    if(out->fd < 0 && errno == EINVAL)
+    {
+        out->direct = 0;
+        out->fd = open(fname, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    }
+    if(out->fd < 0)
+    {
+        perror("open");
+        put_pool_buffer(out->buffer);
+        return NULL;
+    }
+
+    // STEP3: Reserve the blocks up front, a full disk fails here instead of halfway through
+    if(size > 0)
+    {
+        if(fallocate(out->fd, 0, 0, size) == 0)
+        {
+            out->preallocated = size;
+        }
+        else if(errno != EOPNOTSUPP)
+        {
+            perror("fallocate");
+            close(out->fd);
+            put_pool_buffer(out->buffer);
+            return NULL;
+        }
+    }
+
+    // STEP4: Wrap it in a FILE pointer, unbuffered since the cookie buffers already
+    cookie_io_functions_t functions = { NULL, direct_write, direct_seek, direct_close };
+    FILE *fptr = fopencookie(out, "w", functions);
+    if(fptr == NULL)
+    {
+        close(out->fd);
+        put_pool_buffer(out->buffer);
+        return NULL;
+    }
+    setvbuf(fptr, NULL, _IONBF, 0);
+    return fptr;
+}
+
+// Function to drop the pages of fptr before offset from the page cache
+void advise_consumed(FILE *fptr, long offset)
+{
+    if(offset > 0)
+    {
+        posix_fadvise(fileno(fptr), 0, offset, POSIX_FADV_DONTNEED);
+    }
+}
@@ -0,0 +1,49 @@
+#ifndef DIRECT_IO_H
+#define DIRECT_IO_H
+
+#include <stdio.h>
+#include "types.h" // Contains user defined types
+
+/*
+ * Structure to store information required for
+ * writing the stego image around the page cache (--direct)
+ *
+ * The output is preallocated to the source image size with fallocate and
+ * opened with O_DIRECT. It stays a FILE pointer (fopencookie), so every
+ * encode step writes to it as before; the bytes are gathered in an
+ * aligned buffer and written DIRECT_BUFFER_SIZE at a time. The unaligned
+ * tail is written as one padded block and the file is truncated back to
+ * its real size on close. Writes are append only: seeking anywhere but
+ * the current end fails, so --journal can not be combined with --direct.
+ *
+ * Filesystems without O_DIRECT (tmpfs) fall back to buffered writes
+ * followed by POSIX_FADV_DONTNEED. Input files are advised the same way
+ * every DIRECT_ADVISE_INTERVAL bytes once they have been consumed
+ */
+
+#define DIRECT_ALIGNMENT 4096
+#define DIRECT_BUFFER_SIZE (1 << 20)                // Bytes per O_DIRECT write
+#define DIRECT_ADVISE_INTERVAL (8L << 20)           // Consumed input bytes between DONTNEED advices
+
+typedef struct _DirectInfo
+{
+    int fd;                     // Output file descriptor
+    int direct;                 // O_DIRECT accepted, else buffered with DONTNEED
+    char *fname;                // Output file name, for messages
+    unsigned char *buffer;      // DIRECT_BUFFER_SIZE bytes, DIRECT_ALIGNMENT aligned
+    long buffered;              // Bytes waiting in buffer
+    long flushed;               // Bytes already written to fd
+    long preallocated;          // Size given to fallocate, 0 if it was not supported
+
+} DirectInfo;  // Datatype of the structure
+
+
+/* Direct I/O function prototype */
+
+/* Create fname preallocated to size bytes, return a write only FILE pointer on it, NULL on errors */
+FILE *open_direct_output(const char *fname, long size);
+
+/* Drop the pages of fptr before offset from the page cache */
+void advise_consumed(FILE *fptr, long offset);
+
+#endif
@@ -4,8 +4,20 @@
 #include <unistd.h>
 // User-defined header files
 #include "encode.h" 
+#include "lsb_kernel.h"
+#include "decode.h"
+#include "probes.h"
+#include "fec.h"
+#include "direct_io.h"
+#include "pool.h"
+#include "lsb_mode.h"
+#include "cache.h"
 #include "types.h"
 #include "common.h"
+#include "progress.h"
+
+// Seconds to pause between steps, batch workers set it to 0
+unsigned int step_delay = 1;
 
 /* Function Definitions */
 
@@ -42,6 +54,12 @@ uint get_image_size_for_bmp(FILE *fptr_image)
  */
 Status open_files(EncodeInfo *encInfo)
 {
+    // Files handed in open (tar stream members in memory, see tar_stream.h) are used as they are
+    if(encInfo->fptr_src_image && encInfo->fptr_secret && encInfo->fptr_stego_image)
+    {
+        return e_success;
+    }
+
     // Src Image file
     encInfo->fptr_src_image = fopen(encInfo->src_image_fname, "r");
     // Do Error handling
@@ -64,8 +82,17 @@ Status open_files(EncodeInfo *encInfo)
     	return e_failure;
     }
 
-    // Stego Image file
-    encInfo->fptr_stego_image = fopen(encInfo->stego_image_fname, "w");
+    // Stego Image file, kept (not truncated) when resuming from a journal,
+    // preallocated to the source size and written with O_DIRECT for --direct
+    if(encInfo->direct)
+    {
+        encInfo->fptr_stego_image = open_direct_output(encInfo->stego_image_fname, get_file_size(encInfo->fptr_src_image));
+        rewind(encInfo->fptr_src_image);
+    }
+    else
+    {
+        encInfo->fptr_stego_image = fopen(encInfo->stego_image_fname, encInfo->journal.resumed ? "r+" : "w");
+    }
     // Do Error handling
     if (encInfo->fptr_stego_image == NULL)
     {
@@ -98,9 +125,9 @@ Status read_and_validate_encode_args(int argc, char *argv[], EncodeInfo *encInfo
         return e_failure;
     }
     
-    // Allocate memory dynamically
-    encInfo->src_image_fname = malloc(strlen(argv[2]) + 1);
-    encInfo->secret_fname = malloc(strlen(argv[3]) + 1);
+    // Allocate memory from the job arena
+    encInfo->src_image_fname = arena_alloc(strlen(argv[2]) + 1);
+    encInfo->secret_fname = arena_alloc(strlen(argv[3]) + 1);
 
     if (!encInfo->src_image_fname || !encInfo->secret_fname)
     {
@@ -112,14 +139,85 @@ Status read_and_validate_encode_args(int argc, char *argv[], EncodeInfo *encInfo
     strcpy(encInfo->src_image_fname, argv[2]);
     strcpy(encInfo->secret_fname, argv[3]);
 
-    // STEP6: Assign default name to output file if not provided and store it in structure
-    // STEP7: If output file name provided, GoTo STEP8
+    // STEP6: Collect the output file name and options (--verify, --journal, --fec[=N], --direct, --bits k, --channels list, --msb-first)
+    char *output_name = NULL;
+    for(int i = 4; i < argc; i++)
+    {
+        if(strcmp(argv[i], "--verify") == 0)
+        {
+            encInfo->verify = 1;
+        }
+        else if(strcmp(argv[i], "--journal") == 0)
+        {
+            encInfo->journal.enabled = 1;
+        }
+        else if(strcmp(argv[i], "--direct") == 0)
+        {
+            encInfo->direct = 1;
+        }
+        else if(strcmp(argv[i], "--bits") == 0)
+        {
+            if(parse_lsb_bits(i + 1 < argc ? argv[++i] : NULL, &encInfo->lsb_bits) == e_failure)
+            {
+                return e_failure;
+            }
+        }
+        else if(strcmp(argv[i], "--channels") == 0)
+        {
+            if(parse_lsb_channels(i + 1 < argc ? argv[++i] : NULL, &encInfo->lsb_channels) == e_failure)
+            {
+                return e_failure;
+            }
+        }
+        else if(strcmp(argv[i], "--msb-first") == 0)
+        {
+            encInfo->lsb_msb_first = 1;
+        }
+        else if(strncmp(argv[i], "--fec", 5) == 0)
+        {
+            if(parse_fec_parity(argv[i], &encInfo->fec_parity) == e_failure)
+            {
+                return e_failure;
+            }
+        }
+        else if(output_name == NULL && argv[i][0] != '-')
+        {
+            output_name = argv[i];
+        }
+        else
+        {
+            return e_failure;
+        }
+    }
+    if(encInfo->fec_parity && encInfo->journal.enabled)
+    {
+        printf("INFO: --journal can not be combined with --fec!\n\n");
+        return e_failure;
+    }
+    if(encInfo->direct && encInfo->journal.enabled)
+    {
+        printf("INFO: --journal can not be combined with --direct!\n\n");
+        return e_failure;
+    }
+    if(encInfo->lsb_bits || encInfo->lsb_channels || encInfo->lsb_msb_first)
+    {
+        if(encInfo->fec_parity || encInfo->journal.enabled)
+        {
+            printf("INFO: --bits, --channels and --msb-first can not be combined with --fec or --journal!\n\n");
+            return e_failure;
+        }
+        encInfo->lsb_bits = encInfo->lsb_bits ? encInfo->lsb_bits : 1;
+        encInfo->lsb_channels = encInfo->lsb_channels ? encInfo->lsb_channels : LSB_MODE_DEFAULT_CHANNELS;
+    }
+
+    // STEP7: Assign default name to output file if not provided and store it in structure
+    // STEP8: If output file name provided, GoTo STEP9
     char default_bmp_name[] = "Encoded_Image.bmp";
-    if(argc < 5)
+    if(output_name == NULL)
     {
         printf("INFO: 'Encoded_Image.bmp' has been taken as default name for output file.\n\n");
-        sleep(1);
-        encInfo->stego_image_fname = malloc(strlen(default_bmp_name) + 1);
+        sleep(step_delay);
+        encInfo->stego_image_fname = arena_alloc(strlen(default_bmp_name) + 1);
         if (!encInfo->stego_image_fname)
         {
             // If memory allocation fails
@@ -129,24 +227,24 @@ Status read_and_validate_encode_args(int argc, char *argv[], EncodeInfo *encInfo
     }
     else
     {
-        // STEP8: Check argv[4] is .bmp file or not
-        // STEP9: If yes -> Goto STEP10, No -> Print error then return e_failure
-        ptr = strstr(argv[4], ".bmp");
+        // STEP9: Check output name is .bmp file or not
+        // STEP10: If yes -> Goto STEP11, No -> Print error then return e_failure
+        ptr = strstr(output_name, ".bmp");
         if(ptr == NULL)
         {
             return e_failure;
         }
 
-        // STEP10: Allocate memory according to argv[4]
-        encInfo->stego_image_fname = malloc(strlen(argv[4]) + 1);
+        // STEP11: Allocate memory according to output name
+        encInfo->stego_image_fname = arena_alloc(strlen(output_name) + 1);
 
         if (!encInfo->stego_image_fname)
         {
             // If memory allocation fails return e_failure
             return e_failure;
         } 
-        // STEP11: Store argv[4] into structure
-        strcpy(encInfo->stego_image_fname, argv[4]);
+        // STEP12: Store output name into structure
+        strcpy(encInfo->stego_image_fname, output_name);
     }
 
     // If all steps are done correctly return e_success
@@ -162,17 +260,56 @@ uint get_file_size(FILE *fptr)
     return ftell(fptr);
 }
 
+// Function to find where the secret file extension starts, NULL if it has none
+const char *get_secret_extension(const char *secret_fname)
+{
+    // The extension starts at the first '.' of the name, the encoded stream carries all of it
+    return strchr(secret_fname, '.');
+}
+
 // Function to find the size of extension of the secret data file
 uint get_secret_extension_size(EncodeInfo *encInfo)
 {
     // Store the address where the file extension starts in a pointer
-    char *extn = strchr(encInfo->secret_fname, '.');
+    const char *extn = get_secret_extension(encInfo->secret_fname);
     // Store the file extension into the structure variable using previous pointer
     strcpy(encInfo->extn_secret_file, extn);
     // Return the length of the extension
     return strlen(encInfo->extn_secret_file);
 }
 
+// Function to store a 32 bit value into 4 bytes, same bit order as encode_size_to_lsb()
+void put_stream_uint(char *buffer, uint value)
+{
+    for(int i = 0; i < 4; i++)
+    {
+        buffer[i] = (value >> (i * 8)) & 0xFF;
+    }
+}
+
+// Function to build the stream bytes before the data, returns their number
+long build_stream_header(char *buffer, const char *extn, long secret_size)
+{
+    char *ptr = buffer;
+    uint extn_size = strlen(extn);
+
+    memcpy(ptr, MAGIC_STRING, strlen(MAGIC_STRING));
+    ptr += strlen(MAGIC_STRING);
+    put_stream_uint(ptr, extn_size);
+    ptr += 4;
+    memcpy(ptr, extn, extn_size);
+    ptr += extn_size;
+    put_stream_uint(ptr, secret_size);
+    ptr += 4;
+    return ptr - buffer;
+}
+
+// Function to find the image bytes needed to encode a secret, same formula check_capacity() uses
+unsigned long long get_encoded_size(uint extn_size, long secret_size)
+{
+    return 16 + 32 + (extn_size * 8ULL) + 32 + (secret_size * 8ULL) + 54 + 1;
+}
+
 // Function to check if the input image has enough capacity to store the data that needs to be encoded
 Status check_capacity(EncodeInfo *encInfo)
 {
@@ -187,7 +324,7 @@ Status check_capacity(EncodeInfo *encInfo)
         return e_failure;
     }
     // STEP2: Call the get_file_size() function to get the size of secret file 
-    sleep(1);
+    sleep(step_delay);
     if(encInfo->size_secret_file = get_file_size(encInfo->fptr_secret))
     {
         fseek(encInfo->fptr_secret, 0, SEEK_SET);
@@ -201,7 +338,7 @@ Status check_capacity(EncodeInfo *encInfo)
     }
 
     // STEP3: Find the size of secret file extension (from . extract string then find size)
-    sleep(1);
+    sleep(step_delay);
     uint extn_size;
     if(extn_size = get_secret_extension_size(encInfo))
     {
@@ -215,7 +352,20 @@ Status check_capacity(EncodeInfo *encInfo)
 
     // STEP4: Check if the bmp file has enough capacity to hold all the data
     // size_of_bmp_file > (16 + 32 + (size_of_extn * 8) + 32 + (size_of_secret_file * 8) + 54 + 1)
-    uint total_size = 16 + 32 + (extn_size * 8) + 32 + (encInfo->size_secret_file * 8) + 54 + 1;
+    // With --fec the whole stream after the magic string is padded to codewords and gets parity bytes
+    unsigned long long total_size = encInfo->fec_parity ? get_fec_encoded_size(extn_size, encInfo->size_secret_file, encInfo->fec_parity)
+                                                        : get_encoded_size(extn_size, encInfo->size_secret_file);
+
+    // With --bits/--channels the stream only goes into the selected bits of whole pixel groups
+    if(encInfo->lsb_bits)
+    {
+        LsbLayout layout;
+        if(read_lsb_layout(encInfo->fptr_src_image, encInfo->lsb_bits, encInfo->lsb_channels, encInfo->lsb_msb_first, 0, &layout) == e_failure)
+        {
+            return e_failure;
+        }
+        return layout.capacity >= (long)(strlen(MAGIC_STRING) + 4 + extn_size + 4) + encInfo->size_secret_file ? e_success : e_failure;
+    }
 
     // STEP5: If enough capacity -> return e_success, else -> return e_failure
     if(encInfo->image_capacity > total_size)
@@ -302,6 +452,37 @@ Status encode_data_to_image(const char *data, int size, FILE *fptr_src_image, FI
     return e_failure;
 }
 
+// Generic function to encode a block of data to image, MAX_BLOCK_SIZE bytes per read/write
+Status encode_block_to_image(const char *data, long size, FILE *fptr_src_image, FILE *fptr_stego_image)
+{
+    char arr[MAX_BLOCK_SIZE * 8];
+
+    while(size > 0)
+    {
+        // STEP1: Take at most MAX_BLOCK_SIZE bytes of data in this pass
+        long block = size < MAX_BLOCK_SIZE ? size : MAX_BLOCK_SIZE;
+
+        // STEP2: Read 8 bytes of image data for every byte of the block
+        if(fread(arr, 1, block * 8, fptr_src_image) != (size_t)(block * 8))
+        {
+            return e_failure;
+        }
+
+        // STEP3: Encode each byte of the block into its 8 image bytes
+        encode_bytes_to_lsb(data, block, arr);
+
+        // STEP4: Write the encoded block to destination file
+        if(fwrite(arr, 1, block * 8, fptr_stego_image) != (size_t)(block * 8))
+        {
+            return e_failure;
+        }
+
+        data += block;
+        size -= block;
+    }
+    return e_success;
+}
+
 // Function to encode the magic string into the output image
 Status encode_magic_string(const char *magic_string, FILE *fptr_src_image, FILE *fptr_stego_image)
 {
@@ -384,34 +565,157 @@ Status encode_secret_file_size(long file_size, FILE *fptr_src_image, FILE *fptr_
     return e_failure;
 }
 
-// Function to encode the secret file data to the destination image
+// Function to encode the secret file data to the destination image, one block at a time
 Status encode_secret_file_data(EncodeInfo *encInfo)
 {
-    // STEP1: Create a character array of the size of the secret file
-    char secret_data[encInfo -> size_secret_file];
-    // STEP2: Read the secret data from secret file
-    fread(secret_data, encInfo -> size_secret_file , 1, encInfo -> fptr_secret);
-    // STEP3: Call the encode_data_to_image() function with secret data and its size as arguments
-    // STEP4: If its successful -> return e_success, else -> return e_failure
-    if(encode_data_to_image(secret_data, encInfo->size_secret_file, encInfo->fptr_src_image, encInfo->fptr_stego_image) == e_success)
+    char secret_data[MAX_BLOCK_SIZE];
+    char check_data[MAX_BLOCK_SIZE];
+    char arr[MAX_BLOCK_SIZE * 8];
+    long remaining = encInfo->size_secret_file - encInfo->journal.data_offset;
+    long image_offset = ftell(encInfo->fptr_src_image);
+    size_t done;
+
+    start_progress_stage("data", encInfo->size_secret_file);
+    while(remaining > 0)
+    {
+        long block = remaining < MAX_BLOCK_SIZE ? remaining : MAX_BLOCK_SIZE;
+        long offset = encInfo->size_secret_file - remaining;
+
+        // STEP1: Read a block of secret data and the image bytes that will carry it
+        PROBE4(io__submit, progress.job_id, PROBE_IO_READ, offset, block);
+        done = fread(secret_data, 1, block, encInfo->fptr_secret);
+        PROBE4(io__complete, progress.job_id, PROBE_IO_READ, offset, done);
+        if(done != (size_t)block)
+        {
+            return e_failure;
+        }
+        PROBE4(io__submit, progress.job_id, PROBE_IO_READ, image_offset, block * 8);
+        done = fread(arr, 1, block * 8, encInfo->fptr_src_image);
+        PROBE4(io__complete, progress.job_id, PROBE_IO_READ, image_offset, done);
+        if(done != (size_t)(block * 8))
+        {
+            return e_failure;
+        }
+
+        // STEP2: Encode the block
+        PROBE3(embed__enter, progress.job_id, offset, block);
+        encode_bytes_to_lsb(secret_data, block, arr);
+        PROBE3(embed__leave, progress.job_id, offset, block);
+
+        // STEP3: With --verify, extract the block again and compare it before it is written,
+        //        with the scalar decode_lsb_to_byte() so a bug in the selected kernel can not hide itself
+        if(encInfo->verify)
+        {
+            PROBE3(extract__enter, progress.job_id, offset, block);
+            for(long i = 0; i < block; i++)
+            {
+                decode_lsb_to_byte(&check_data[i], &arr[i * 8]);
+            }
+            PROBE3(extract__leave, progress.job_id, offset, block);
+            if(memcmp(check_data, secret_data, block) != 0)
+            {
+                printf("INFO: Verification failed at secret byte %ld!\n\n", encInfo->size_secret_file - remaining);
+                return e_failure;
+            }
+            encInfo->verified_size += block;
+        }
+
+        // STEP4: Write the encoded block to destination file, at the same offset as in the source image
+        PROBE4(io__submit, progress.job_id, PROBE_IO_WRITE, image_offset, block * 8);
+        done = fwrite(arr, 1, block * 8, encInfo->fptr_stego_image);
+        PROBE4(io__complete, progress.job_id, PROBE_IO_WRITE, image_offset, done);
+        if(done != (size_t)(block * 8))
+        {
+            return e_failure;
+        }
+        remaining -= block;
+        image_offset += block * 8;
+
+        // With --direct, drop the consumed source pages every DIRECT_ADVISE_INTERVAL bytes
+        if(encInfo->direct && image_offset % DIRECT_ADVISE_INTERVAL < block * 8)
+        {
+            advise_consumed(encInfo->fptr_src_image, image_offset);
+            advise_consumed(encInfo->fptr_secret, encInfo->size_secret_file - remaining);
+        }
+
+        // STEP5: With --journal, checkpoint every JOURNAL_INTERVAL_BLOCKS blocks
+        if(update_journal(&encInfo->journal, encInfo->fptr_stego_image, ftell(encInfo->fptr_stego_image),
+                          encInfo->size_secret_file - remaining) == e_failure)
+        {
+            return e_failure;
+        }
+
+        // STEP6: Report progress, stop here if the job was cancelled (checkpointed, so --journal resumes here)
+        if(report_progress(encInfo->size_secret_file - remaining) == e_failure)
+        {
+            printf("INFO: Cancelled at secret byte %ld!\n\n", encInfo->size_secret_file - remaining);
+            if(encInfo->journal.enabled)
+            {
+                write_journal(&encInfo->journal, encInfo->fptr_stego_image, ftell(encInfo->fptr_stego_image),
+                              encInfo->size_secret_file - remaining);
+            }
+            return e_failure;
+        }
+    }
+    return e_success;
+}
+
+// Function to copy image bytes from src to stego image in blocks until src ends
+// hook (if any) runs after every block with the source offset and bytes copied so far, e_failure stops the copy
+Status copy_image_blocks(FILE *fptr_src_image, FILE *fptr_stego_image, CopyBlockHook hook, void *arg)
+{
+    char arr[MAX_BLOCK_SIZE * 8];
+    long start = ftell(fptr_src_image);
+    long done = 0;
+    size_t read;
+
+    // Read data from source image and write it to the destination image
+    while(1)
+    {
+        PROBE4(io__submit, progress.job_id, PROBE_IO_READ, start + done, sizeof(arr));
+        read = fread(arr, 1, sizeof(arr), fptr_src_image);
+        PROBE4(io__complete, progress.job_id, PROBE_IO_READ, start + done, read);
+        if(read == 0)
+        {
+            break;
+        }
+        PROBE4(io__submit, progress.job_id, PROBE_IO_WRITE, start + done, read);
+        size_t write = fwrite(arr, 1, read, fptr_stego_image);
+        PROBE4(io__complete, progress.job_id, PROBE_IO_WRITE, start + done, write);
+        if(write != read)
+        {
+            return e_failure;
+        }
+        done += read;
+        if(hook && hook(arg, start + done, done) == e_failure)
+        {
+            return e_failure;
+        }
+    }
+    return e_success;
+}
+
+// Copy hook of the encoder, drops consumed pages with --direct and reports progress
+static Status encode_copy_hook(void *arg, long offset, long done)
+{
+    EncodeInfo *encInfo = arg;
+
+    if(encInfo->direct && done % DIRECT_ADVISE_INTERVAL < MAX_BLOCK_SIZE * 8)
     {
-        return e_success;
+        advise_consumed(encInfo->fptr_src_image, offset);
     }
-    return e_failure;
+    return report_progress(done);
 }
 
 // Function to copy the remaining data from source image to destination image
 Status copy_remaining_img_data(EncodeInfo *encInfo)
 {
-    char ch;
-    // Read data from source image
-    while(fread(&ch, 1, 1, encInfo->fptr_src_image))
-    {   
-        // Write data to the destination image  
-        fwrite(&ch, 1, 1, encInfo->fptr_stego_image);
-    }
-    // Return e_success after all the functions have been performed
-    return e_success;
+    long start = ftell(encInfo->fptr_src_image);
+
+    // Copy block by block, reporting progress, return e_failure if a write fails
+    start_progress_stage("copy", get_file_size(encInfo->fptr_src_image) - start);
+    fseek(encInfo->fptr_src_image, start, SEEK_SET);
+    return copy_image_blocks(encInfo->fptr_src_image, encInfo->fptr_stego_image, encode_copy_hook, encInfo);
 }
 
 // Function to check whether encoding was successful
@@ -434,40 +738,15 @@ Status check_successful_encoding(EncodeInfo *encInfo)
     return e_failure;
 }
 
-// Function to perform all the steps of encoding one by oone
-Status do_encoding(EncodeInfo *encInfo)
+// Function to encode magic string, extension size, extension and secret size after the header
+Status encode_stego_header(EncodeInfo *encInfo)
 {
-    // STEP1: Call open_files function
-    sleep(1);
-    if(open_files(encInfo) == e_success)
-    {
-        printf("INFO: All files are opened successfully.\n\n");
-    }
-    else
-    {
-        printf("INFO: Files could not be opened!\n\n");
-        return e_failure;
-    }
+    // STEP7: Call copy_bmp_header(encInfo->fptr_src_image, encInfo->fptr_stego_image)
+    // STEP8: Check returned e_success or e_failure
+    // STEP9: if_e_success -> Goto STEP10, else -> print error msg, then return e_failure
 
-    // STEP2: Call check_capacity()
-    // STEP3: Check returned e_success or e_failure
-    // STEP4: if_e_success -> Goto STEP5, else -> print error msg, then return e_failure
-    sleep(1);
-    if(check_capacity(encInfo) == e_success)
-    {
-        printf("INFO: The source image has enough capacity to be encoded.\n\n");
-    }
-    else
-    {
-        printf("INFO: Source Image does not have enough capacity!\n\n");
-        return e_failure;
-    }
-
-    // STEP5: Call copy_bmp_header(encInfo->fptr_src_image, encInfo->fptr_stego_image)
-    // STEP6: Check returned e_success or e_failure
-    // STEP7: if_e_success -> Goto STEP8, else -> print error msg, then return e_failure
-
-    sleep(1);
+    start_progress_stage("header", get_encoded_size(strlen(encInfo->extn_secret_file), 0) - 1);
+    sleep(step_delay);
     if(copy_bmp_header(encInfo->fptr_src_image, encInfo->fptr_stego_image) == e_success)
     {
         printf("INFO: The header has been successfully copied.\n\n");
@@ -478,11 +757,11 @@ Status do_encoding(EncodeInfo *encInfo)
         return e_failure;
     }
 
-    // STEP8: Call encode_magic_string(MAGIC_STRING, /*File pointers*/)
-    // STEP9: Check returned e_success or e_failure
-    // STEP10: if_e_success -> Goto STEP11, else -> print error msg, then return e_failure
+    // STEP10: Call encode_magic_string(MAGIC_STRING, /*File pointers*/)
+    // STEP11: Check returned e_success or e_failure
+    // STEP12: if_e_success -> Goto STEP13, else -> print error msg, then return e_failure
  
-    sleep(1);
+    sleep(step_delay);
     if(encode_magic_string(MAGIC_STRING, encInfo->fptr_src_image, encInfo->fptr_stego_image) == e_success)
     {
         printf("INFO: The magic string has been successfully encoded.\n\n");
@@ -493,10 +772,10 @@ Status do_encoding(EncodeInfo *encInfo)
         return e_failure;
     }
 
-    // STEP11: Call encode_secret_file_extn_size(extn_size, /*File pointers*/)
-    // STEP12: Check returned e_success or e_failure
-    // STEP13: if_e_success -> Goto STEP14, else -> print error msg, then return e_failure
-    sleep(1);
+    // STEP13: Call encode_secret_file_extn_size(extn_size, /*File pointers*/)
+    // STEP14: Check returned e_success or e_failure
+    // STEP15: if_e_success -> Goto STEP16, else -> print error msg, then return e_failure
+    sleep(step_delay);
     uint extn_size = get_secret_extension_size(encInfo);
     if(encode_secret_file_extn_size(extn_size, encInfo->fptr_src_image, encInfo->fptr_stego_image) == e_success)
     {
@@ -508,10 +787,10 @@ Status do_encoding(EncodeInfo *encInfo)
         return e_failure;
     }
 
-    // STEP14: Call encode_secret_file_extn(extn, /*File pointers*/)
-    // STEP15: Check returned e_success or e_failure
-    // STEP16: if_e_success -> Goto STEP17, else -> print error msg, then return e_failure
-    sleep(1);
+    // STEP16: Call encode_secret_file_extn(extn, /*File pointers*/)
+    // STEP17: Check returned e_success or e_failure
+    // STEP18: if_e_success -> Goto STEP19, else -> print error msg, then return e_failure
+    sleep(step_delay);
     if(encode_secret_file_extn(encInfo->extn_secret_file, encInfo->fptr_src_image, encInfo->fptr_stego_image) == e_success)
     {
         printf("INFO: The secret file extension has been successfully encoded.\n\n");
@@ -522,10 +801,10 @@ Status do_encoding(EncodeInfo *encInfo)
         return e_failure;
     }
 
-    // STEP17: Call encode_secret_file_size(file_size, /*File pointers*/)
-    // STEP18: Check returned e_success or e_failure
-    // STEP19: if_e_success -> Goto STEP20, else -> print error msg, then return e_failure
-    sleep(1);
+    // STEP19: Call encode_secret_file_size(file_size, /*File pointers*/)
+    // STEP20: Check returned e_success or e_failure
+    // STEP21: if_e_success -> Goto STEP22, else -> print error msg, then return e_failure
+    sleep(step_delay);
     if(encode_secret_file_size(encInfo->size_secret_file, encInfo->fptr_src_image, encInfo->fptr_stego_image) == e_success)
     {
         printf("INFO: The secret file size has been successfully encoded.\n\n");
@@ -536,13 +815,98 @@ Status do_encoding(EncodeInfo *encInfo)
         return e_failure;
     }
 
-    // STEP20: Call encode_secret_file_data(encInfo)
-    // STEP21: Check returned e_success or e_failure
-    // STEP22: if_e_success -> Goto STEP23, else -> print error msg, then return e_failure
-    sleep(1);
-    if(encode_secret_file_data(encInfo) == e_success)
+    return e_success;
+}
+
+// Function to continue an interrupted encoding from its journal checkpoint
+Status resume_encoding(EncodeInfo *encInfo)
+{
+    // STEP1: Checkpoint must lie on a block of this secret's data
+    long data_start = 54 + (strlen(MAGIC_STRING) + 4 + strlen(encInfo->extn_secret_file) + 4) * 8;
+    JournalInfo *journal = &encInfo->journal;
+    if(journal->data_offset > encInfo->size_secret_file ||
+       journal->image_offset != data_start + journal->data_offset * 8 ||
+       (long)get_file_size(encInfo->fptr_stego_image) < journal->image_offset)
+    {
+        return e_failure;
+    }
+
+    // STEP2: Seek all three files to the checkpoint
+    fseek(encInfo->fptr_src_image, journal->image_offset, SEEK_SET);
+    fseek(encInfo->fptr_stego_image, journal->image_offset, SEEK_SET);
+    fseek(encInfo->fptr_secret, journal->data_offset, SEEK_SET);
+    printf("INFO: Header and first %ld bytes of secret data already encoded.\n\n", journal->data_offset);
+    return e_success;
+}
+
+// Function to perform all the steps of encoding one by oone
+static Status run_encoding_steps(EncodeInfo *encInfo)
+{
+    // STEP1: Open the journal (--journal), then call open_files function
+    if(encInfo->journal.enabled && open_journal(&encInfo->journal, encInfo->stego_image_fname) == e_failure)
+    {
+        return e_failure;
+    }
+    sleep(step_delay);
+    if(open_files(encInfo) == e_success)
+    {
+        printf("INFO: All files are opened successfully.\n\n");
+    }
+    else
+    {
+        printf("INFO: Files could not be opened!\n\n");
+        return e_failure;
+    }
+
+    // STEP2: Call check_capacity()
+    // STEP3: Check returned e_success or e_failure
+    // STEP4: if_e_success -> Goto STEP5, else -> print error msg, then return e_failure
+    sleep(step_delay);
+    if(check_capacity(encInfo) == e_success)
+    {
+        printf("INFO: The source image has enough capacity to be encoded.\n\n");
+    }
+    else
+    {
+        printf("INFO: Source Image does not have enough capacity!\n\n");
+        return e_failure;
+    }
+
+    // STEP5: Resuming from a journal -> header and data before the checkpoint are already written
+    // STEP6: Else call encode_stego_header(encInfo) for STEP7 to STEP21 (--fec and --bits/--channels write it in STEP22)
+    if(encInfo->journal.resumed)
+    {
+        if(resume_encoding(encInfo) == e_failure)
+        {
+            printf("INFO: The journal does not match this job, delete %s to start over!\n\n", encInfo->journal.journal_fname);
+            return e_failure;
+        }
+    }
+    else if(encInfo->fec_parity == 0 && encInfo->lsb_bits == 0 && encode_stego_header(encInfo) == e_failure)
+    {
+        return e_failure;
+    }
+    else if(encInfo->journal.enabled &&
+            write_journal(&encInfo->journal, encInfo->fptr_stego_image, ftell(encInfo->fptr_stego_image), 0) == e_failure)
+    {
+        printf("INFO: The journal could not be written!\n\n");
+        return e_failure;
+    }
+
+    // STEP22: Call encode_secret_file_data(encInfo), encode_fec_stream(encInfo) for --fec
+    //         or encode_mode_stream(encInfo) for --bits/--channels
+    // STEP23: Check returned e_success or e_failure
+    // STEP24: if_e_success -> Goto STEP25, else -> print error msg, then return e_failure
+    sleep(step_delay);
+    Status data_status = encInfo->fec_parity ? encode_fec_stream(encInfo) :
+                         encInfo->lsb_bits ? encode_mode_stream(encInfo) : encode_secret_file_data(encInfo);
+    if(data_status == e_success)
     {
         printf("INFO: The secret file data has been successfully encoded.\n\n");
+        if(encInfo->verify)
+        {
+            printf("INFO: %ld bytes of secret file data verified.\n\n", encInfo->verified_size);
+        }
     }
     else
     {
@@ -550,10 +914,10 @@ Status do_encoding(EncodeInfo *encInfo)
         return e_failure;
     }
 
-    // STEP23: Call copy_remaining_img_data(fptr_src_image, fptr_stego_image)
-    // STEP24: Check returned e_success or e_failure
-    // STEP25: if_e_success -> Goto STEP26, else -> print error msg, then return e_failure
-    sleep(1);
+    // STEP25: Call copy_remaining_img_data(fptr_src_image, fptr_stego_image)
+    // STEP26: Check returned e_success or e_failure
+    // STEP27: if_e_success -> Goto STEP28, else -> print error msg, then return e_failure
+    sleep(step_delay);
     if(copy_remaining_img_data(encInfo) == e_success)
     {
         printf("INFO: The remaining data has been successfully copied.\n\n");
@@ -564,11 +928,17 @@ Status do_encoding(EncodeInfo *encInfo)
         return e_failure;
     }
 
-    // STEP26: Call check_successful_encoding(encInfo)
-    // STEP27: Check returned e_success or e_failure
-    // STEP28: if_e_success -> Goto STEP29, else -> print error msg, then return e_failure
+    // STEP28: Call check_successful_encoding(encInfo)
+    // STEP29: Check returned e_success or e_failure
+    // STEP30: if_e_success -> Goto STEP31, else -> print error msg, then return e_failure
     if(check_successful_encoding(encInfo) == e_success)
     {
+        if(encInfo->direct)
+        {
+            advise_consumed(encInfo->fptr_src_image, encInfo->src_image_size);
+            advise_consumed(encInfo->fptr_secret, encInfo->size_secret_file);
+        }
+
         char str[] = "INFO: Enoding Completed Successfully.";
         int width = strlen(str);
         for(int i = 0; i < width; i++)
@@ -590,6 +960,23 @@ Status do_encoding(EncodeInfo *encInfo)
         return e_failure;
     }
     
-    // STEP29: Return e_success if all the functions have been executed successfully
+    // STEP31: Job finished, remove the journal
+    close_journal(&encInfo->journal, e_success);
+
+    // STEP32: Return e_success if all the functions have been executed successfully
     return e_success;
-}
\ No newline at end of file
+}
+
+// Function to perform all the steps of encoding, with job progress events around them
+Status do_encoding(EncodeInfo *encInfo)
+{
+    start_progress_job(encInfo->stego_image_fname);
+    // --cache: the same carrier, secret and options were encoded before -> the output comes from the cache
+    Status ret = lookup_encode_cache(encInfo) == e_success ? e_success : run_encoding_steps(encInfo);
+    if(ret == e_success && encInfo->fptr_stego_image)
+    {
+        ret = store_encode_cache(encInfo);
+    }
+    finish_progress_job(ret);
+    return ret;
+}
@@ -2,6 +2,7 @@
 #define ENCODE_H
 
 #include "types.h" // Contains user defined types
+#include "journal.h" // Checkpoint sidecar for --journal
 
 /* 
  * Structure to store information required for
@@ -14,6 +15,9 @@
 #define MAX_IMAGE_BUF_SIZE (MAX_SECRET_BUF_SIZE * 8)
 #define MAX_FILE_SUFFIX 4
 
+/* Called after every block copy_image_blocks() writes: source offset, bytes copied, e_failure stops the copy */
+typedef Status (*CopyBlockHook)(void *arg, long offset, long done);
+
 typedef struct _EncodeInfo
 {
     /* Source Image info */
@@ -36,6 +40,17 @@ typedef struct _EncodeInfo
     FILE *fptr_stego_image;     // File pointer of output image
     uint output_image_size;     // Stego Image size
 
+    /* Options */
+    int verify;                 // Re-extract every block with the scalar decoder and compare it before it is written (--verify)
+    long verified_size;         // Number of secret bytes verified
+    JournalInfo journal;        // Checkpoint and resume (--journal)
+    int fec_parity;             // Reed-Solomon parity bytes per codeword (--fec[=N]), 0 for a plain stream
+    int direct;                 // Preallocate the stego image and write it with O_DIRECT (--direct)
+    int lsb_bits;               // Bits per channel byte (--bits k), 0 for the default layout
+    int lsb_channels;           // Channel mask (--channels list), see lsb_mode.h
+    int lsb_msb_first;          // Stream bits most significant first (--msb-first)
+    char cache_key[33];         // Result cache key of the job (--cache, see cache.h), "" if not looked up
+
 } EncodeInfo;  // Datatype of the structure
 
 
@@ -59,18 +74,36 @@ Status open_files(EncodeInfo *encInfo);
 /* check capacity */
 Status check_capacity(EncodeInfo *encInfo);
 
+/* Get image bytes needed for a secret of given extension and file size */
+unsigned long long get_encoded_size(uint extn_size, long secret_size);
+
+/* Build the stream bytes before the data: magic string | extension size | extension | file size */
+long build_stream_header(char *buffer, const char *extn, long secret_size);
+
 /* Get image size */
 uint get_image_size_for_bmp(FILE *fptr_image);
 
 /* Get file size */
 uint get_file_size(FILE *fptr);
 
+/* Get where the secret file extension starts, the first '.' of the name */
+const char *get_secret_extension(const char *secret_fname);
+
+/* Store a 32 bit value into 4 bytes, LSB first */
+void put_stream_uint(char *buffer, uint value);
+
 /* Get secret file extension size */
 uint get_secret_extension_size(EncodeInfo *encInfo);
 
 /* Copy bmp image header */
 Status copy_bmp_header(FILE *fptr_src_image, FILE *fptr_dest_image);
 
+/* Encode magic string, extension and size (everything before the data) */
+Status encode_stego_header(EncodeInfo *encInfo);
+
+/* Continue an interrupted encoding from its journal checkpoint */
+Status resume_encoding(EncodeInfo *encInfo);
+
 /* Store Magic String */
 Status encode_magic_string(const char *magic_string, FILE *fptr_src_image, FILE *fptr_stego_image);
 
@@ -92,9 +125,15 @@ Status encode_secret_file_data(EncodeInfo *encInfo);
 /* Encode function, which does the real encoding */
 Status encode_data_to_image(const char *data, int size, FILE *fptr_src_image, FILE *fptr_stego_image);
 
+/* Encode a block of data to image, MAX_BLOCK_SIZE bytes at a time */
+Status encode_block_to_image(const char *data, long size, FILE *fptr_src_image, FILE *fptr_stego_image);
+
 /* Encode a byte into LSB of image data array */
 void encode_byte_to_lsb(char data, char *image_buffer);
 
+/* Copy image bytes from src to stego image in blocks until src ends, calling hook (if not NULL) after every block */
+Status copy_image_blocks(FILE *fptr_src_image, FILE *fptr_stego_image, CopyBlockHook hook, void *arg);
+
 /* Copy remaining image bytes from src to stego image after encoding */
 Status copy_remaining_img_data(EncodeInfo *encInfo);
 
@@ -0,0 +1,938 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+// User-defined header files
+#include "fec.h"
+#include "encode.h"
+#include "decode.h"
+#include "lsb_kernel.h"
+#include "admission.h"
+#include "progress.h"
+#include "pool.h"
+#include "probes.h"
+#include "common.h"
+#include "types.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define FEC_KERNEL_X86 1
+#include <immintrin.h>
+#endif
+
+/* GF(2^8) with the polynomial x^8 + x^4 + x^3 + x^2 + 1, generator 2 */
+static unsigned char gf_exp[512];
+static unsigned char gf_log[256];
+static int gf_ready;
+
+/* Function Definitions */
+
+// Function to build the exp and log tables once
+static void init_gf_tables(void)
+{
+    int x = 1;
+
+    if(gf_ready)
+    {
+        return;
+    }
+    for(int i = 0; i < 255; i++)
+    {
+        gf_exp[i] = x;
+        gf_log[x] = i;
+        x <<= 1;
+        if(x & 0x100)
+        {
+            x ^= 0x11D;
+        }
+    }
+    for(int i = 255; i < 512; i++)
+    {
+        gf_exp[i] = gf_exp[i - 255];
+    }
+    gf_ready = 1;
+}
+
+static unsigned char gf_mul(unsigned char a, unsigned char b)
+{
+    return a && b ? gf_exp[gf_log[a] + gf_log[b]] : 0;
+}
+
+static unsigned char gf_div(unsigned char a, unsigned char b)
+{
+    return a ? gf_exp[gf_log[a] + 255 - gf_log[b]] : 0;
+}
+
+static unsigned char gf_inverse(unsigned char a)
+{
+    return gf_exp[255 - gf_log[a]];
+}
+
+// Function to build the products of c with every low nibble and every high nibble
+static void build_nibble_tables(unsigned char c, unsigned char *lo, unsigned char *hi)
+{
+    init_gf_tables();
+    for(int x = 0; x < 16; x++)
+    {
+        lo[x] = gf_mul(c, x);
+        hi[x] = gf_mul(c, x << 4);
+    }
+}
+
+// Scalar kernel, two table lookups per byte
+static int scalar_supported(void)
+{
+    return 1;
+}
+
+static void scalar_mul_xor(unsigned char *dst, const unsigned char *src, long size, unsigned char c)
+{
+    unsigned char lo[16], hi[16];
+
+    build_nibble_tables(c, lo, hi);
+    for(long i = 0; i < size; i++)
+    {
+        dst[i] ^= lo[src[i] & 0x0F] ^ hi[src[i] >> 4];
+    }
+}
+
+static void scalar_mul_add(unsigned char *dst, const unsigned char *src, long size, unsigned char c)
+{
+    unsigned char lo[16], hi[16];
+
+    build_nibble_tables(c, lo, hi);
+    for(long i = 0; i < size; i++)
+    {
+        dst[i] = lo[dst[i] & 0x0F] ^ hi[dst[i] >> 4] ^ src[i];
+    }
+}
+
+#ifdef FEC_KERNEL_X86
+
+// SSSE3 kernel, the nibble tables are looked up 16 bytes at a time with pshufb
+static int ssse3_supported(void)
+{
+    return __builtin_cpu_supports("ssse3");
+}
+
+__attribute__((target("ssse3")))
+static inline __m128i ssse3_gf_mul(__m128i x, __m128i lo, __m128i hi)
+{
+    const __m128i mask = _mm_set1_epi8(0x0F);
+    return _mm_xor_si128(_mm_shuffle_epi8(lo, _mm_and_si128(x, mask)),
+                         _mm_shuffle_epi8(hi, _mm_and_si128(_mm_srli_epi64(x, 4), mask)));
+}
+
+__attribute__((target("ssse3")))
+static void ssse3_mul_xor(unsigned char *dst, const unsigned char *src, long size, unsigned char c)
+{
+    unsigned char lo[16], hi[16];
+    long i = 0;
+
+    build_nibble_tables(c, lo, hi);
+    __m128i tlo = _mm_loadu_si128((const __m128i *)lo);
+    __m128i thi = _mm_loadu_si128((const __m128i *)hi);
+    for(; i + 16 <= size; i += 16)
+    {
+        __m128i p = ssse3_gf_mul(_mm_loadu_si128((const __m128i *)(src + i)), tlo, thi);
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_xor_si128(_mm_loadu_si128((const __m128i *)(dst + i)), p));
+    }
+    scalar_mul_xor(dst + i, src + i, size - i, c);
+}
+
+__attribute__((target("ssse3")))
+static void ssse3_mul_add(unsigned char *dst, const unsigned char *src, long size, unsigned char c)
+{
+    unsigned char lo[16], hi[16];
+    long i = 0;
+
+    build_nibble_tables(c, lo, hi);
+    __m128i tlo = _mm_loadu_si128((const __m128i *)lo);
+    __m128i thi = _mm_loadu_si128((const __m128i *)hi);
+    for(; i + 16 <= size; i += 16)
+    {
+        __m128i p = ssse3_gf_mul(_mm_loadu_si128((const __m128i *)(dst + i)), tlo, thi);
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_xor_si128(p, _mm_loadu_si128((const __m128i *)(src + i))));
+    }
+    scalar_mul_add(dst + i, src + i, size - i, c);
+}
+
+// AVX2 kernel, 32 bytes at a time, tables repeated in both lanes
+static int avx2_supported(void)
+{
+    return __builtin_cpu_supports("avx2");
+}
+
+__attribute__((target("avx2")))
+static inline __m256i avx2_gf_mul(__m256i x, __m256i lo, __m256i hi)
+{
+    const __m256i mask = _mm256_set1_epi8(0x0F);
+    return _mm256_xor_si256(_mm256_shuffle_epi8(lo, _mm256_and_si256(x, mask)),
+                            _mm256_shuffle_epi8(hi, _mm256_and_si256(_mm256_srli_epi64(x, 4), mask)));
+}
+
+__attribute__((target("avx2")))
+static void avx2_mul_xor(unsigned char *dst, const unsigned char *src, long size, unsigned char c)
+{
+    unsigned char lo[16], hi[16];
+    long i = 0;
+
+    build_nibble_tables(c, lo, hi);
+    __m256i tlo = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)lo));
+    __m256i thi = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)hi));
+    for(; i + 32 <= size; i += 32)
+    {
+        __m256i p = avx2_gf_mul(_mm256_loadu_si256((const __m256i *)(src + i)), tlo, thi);
+        _mm256_storeu_si256((__m256i *)(dst + i), _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)(dst + i)), p));
+    }
+    scalar_mul_xor(dst + i, src + i, size - i, c);
+}
+
+__attribute__((target("avx2")))
+static void avx2_mul_add(unsigned char *dst, const unsigned char *src, long size, unsigned char c)
+{
+    unsigned char lo[16], hi[16];
+    long i = 0;
+
+    build_nibble_tables(c, lo, hi);
+    __m256i tlo = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)lo));
+    __m256i thi = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)hi));
+    for(; i + 32 <= size; i += 32)
+    {
+        __m256i p = avx2_gf_mul(_mm256_loadu_si256((const __m256i *)(dst + i)), tlo, thi);
+        _mm256_storeu_si256((__m256i *)(dst + i), _mm256_xor_si256(p, _mm256_loadu_si256((const __m256i *)(src + i))));
+    }
+    scalar_mul_add(dst + i, src + i, size - i, c);
+}
+
+// AVX-512 kernel, 64 bytes at a time (vpshufb on zmm needs AVX512BW)
+static int avx512_supported(void)
+{
+    return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static inline __m512i avx512_gf_mul(__m512i x, __m512i lo, __m512i hi)
+{
+    const __m512i mask = _mm512_set1_epi8(0x0F);
+    return _mm512_xor_si512(_mm512_shuffle_epi8(lo, _mm512_and_si512(x, mask)),
+                            _mm512_shuffle_epi8(hi, _mm512_and_si512(_mm512_srli_epi64(x, 4), mask)));
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static void avx512_mul_xor(unsigned char *dst, const unsigned char *src, long size, unsigned char c)
+{
+    unsigned char lo[16], hi[16];
+    long i = 0;
+
+    build_nibble_tables(c, lo, hi);
+    __m512i tlo = _mm512_broadcast_i32x4(_mm_loadu_si128((const __m128i *)lo));
+    __m512i thi = _mm512_broadcast_i32x4(_mm_loadu_si128((const __m128i *)hi));
+    for(; i + 64 <= size; i += 64)
+    {
+        __m512i p = avx512_gf_mul(_mm512_loadu_si512(src + i), tlo, thi);
+        _mm512_storeu_si512(dst + i, _mm512_xor_si512(_mm512_loadu_si512(dst + i), p));
+    }
+    scalar_mul_xor(dst + i, src + i, size - i, c);
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static void avx512_mul_add(unsigned char *dst, const unsigned char *src, long size, unsigned char c)
+{
+    unsigned char lo[16], hi[16];
+    long i = 0;
+
+    build_nibble_tables(c, lo, hi);
+    __m512i tlo = _mm512_broadcast_i32x4(_mm_loadu_si128((const __m128i *)lo));
+    __m512i thi = _mm512_broadcast_i32x4(_mm_loadu_si128((const __m128i *)hi));
+    for(; i + 64 <= size; i += 64)
+    {
+        __m512i p = avx512_gf_mul(_mm512_loadu_si512(dst + i), tlo, thi);
+        _mm512_storeu_si512(dst + i, _mm512_xor_si512(p, _mm512_loadu_si512(src + i)));
+    }
+    scalar_mul_add(dst + i, src + i, size - i, c);
+}
+
+#endif
+
+// All kernels compiled in, in order of preference
+static const FecKernel fec_kernels[] =
+{
+#ifdef FEC_KERNEL_X86
+    {"avx512", avx512_supported, avx512_mul_xor, avx512_mul_add},
+    {"avx2", avx2_supported, avx2_mul_xor, avx2_mul_add},
+    {"ssse3", ssse3_supported, ssse3_mul_xor, ssse3_mul_add},
+#endif
+    {"scalar", scalar_supported, scalar_mul_xor, scalar_mul_add},
+    {NULL, NULL, NULL, NULL}
+};
+
+// Function to get the kernel named like the selected LSB kernel (--kernel), else the best supported one
+const FecKernel *get_fec_kernel(void)
+{
+    static const FecKernel *selected;
+
+    if(selected == NULL)
+    {
+        const char *name = get_lsb_kernel()->name;
+        for(const FecKernel *kernel = fec_kernels; kernel->name && selected == NULL; kernel++)
+        {
+            if(strcmp(kernel->name, name) == 0 && kernel->supported())
+            {
+                selected = kernel;
+            }
+        }
+        for(const FecKernel *kernel = fec_kernels; kernel->name && selected == NULL; kernel++)
+        {
+            if(kernel->supported())
+            {
+                selected = kernel;
+            }
+        }
+    }
+    return selected;
+}
+
+// Function to get the table of all kernels compiled in
+const FecKernel *get_fec_kernel_table(void)
+{
+    return fec_kernels;
+}
+
+// Function to read --fec (default parity) or --fec=parity
+Status parse_fec_parity(const char *arg, int *parity)
+{
+    char *end;
+
+    if(strcmp(arg, "--fec") == 0)
+    {
+        *parity = FEC_DEFAULT_PARITY;
+        return e_success;
+    }
+    if(strncmp(arg, "--fec=", 6) != 0)
+    {
+        return e_failure;
+    }
+    long value = strtol(arg + 6, &end, 10);
+    // Even, so that errors fix exactly parity / 2 bytes
+    if(end == arg + 6 || *end != '\0' || value < 2 || value > FEC_MAX_PARITY || value % 2)
+    {
+        printf("INFO: Give the parity as --fec=N, N even from 2 to %d!\n\n", FEC_MAX_PARITY);
+        return e_failure;
+    }
+    *parity = value;
+    return e_success;
+}
+
+// Function to find the number of codewords for data_size bytes
+long get_fec_columns(long data_size, int parity)
+{
+    long k = FEC_CODEWORD_SIZE - parity;
+    return (data_size + k - 1) / k;
+}
+
+// Function to find the image bytes needed to encode a secret with --fec
+unsigned long long get_fec_encoded_size(uint extn_size, long secret_size, int parity)
+{
+    long data_size = 4 + extn_size + 4 + secret_size;
+    unsigned long long stream = strlen(FEC_MAGIC_STRING) + FEC_HEADER_SIZE * FEC_HEADER_COPIES +
+                                (unsigned long long)get_fec_columns(data_size, parity) * FEC_CODEWORD_SIZE;
+    return stream * 8 + 54 + 1;
+}
+
+// Function to build the generator polynomial (x - 1)(x - 2)...(x - 2^(parity - 1)), highest power first
+static void build_generator(int parity, unsigned char *generator)
+{
+    init_gf_tables();
+    generator[0] = 1;
+    for(int i = 0; i < parity; i++)
+    {
+        generator[i + 1] = 0;
+        for(int j = i + 1; j > 0; j--)
+        {
+            generator[j] ^= gf_mul(generator[j - 1], gf_exp[i]);
+        }
+    }
+}
+
+// Function to compute the parity rows, all columns of a tile shift through one LFSR step per data row
+Status fec_encode(FecInfo *fec, const FecKernel *kernel)
+{
+    unsigned char generator[FEC_MAX_PARITY + 1];
+    int parity = fec->parity, k = FEC_CODEWORD_SIZE - parity;
+    long columns = fec->columns;
+
+    build_generator(parity, generator);
+    unsigned char *reg = get_pool_buffer((long)parity * FEC_TILE_SIZE);
+    unsigned char *feedback = get_pool_buffer(FEC_TILE_SIZE);
+    if(reg == NULL || feedback == NULL)
+    {
+        put_pool_buffer(reg);
+        put_pool_buffer(feedback);
+        return e_failure;
+    }
+
+    for(long tile = 0; tile < columns; tile += FEC_TILE_SIZE)
+    {
+        long width = columns - tile < FEC_TILE_SIZE ? columns - tile : FEC_TILE_SIZE;
+        int head = 0;   // Register row holding the highest parity term
+
+        memset(reg, 0, (long)parity * FEC_TILE_SIZE);
+        for(int j = 0; j < k; j++)
+        {
+            const unsigned char *data = fec->stream + j * columns + tile;
+            unsigned char *first = reg + (long)head * FEC_TILE_SIZE;
+
+            // feedback = data ^ highest term, every other term takes generator * feedback and moves up one
+            for(long i = 0; i < width; i++)
+            {
+                feedback[i] = data[i] ^ first[i];
+            }
+            for(int t = 1; t < parity; t++)
+            {
+                kernel->mul_xor(reg + (long)((head + t) % parity) * FEC_TILE_SIZE, feedback, width, generator[t]);
+            }
+            memset(first, 0, width);
+            kernel->mul_xor(first, feedback, width, generator[parity]);
+            head = (head + 1) % parity;
+        }
+        for(int t = 0; t < parity; t++)
+        {
+            memcpy(fec->stream + (long)(k + t) * columns + tile, reg + (long)((head + t) % parity) * FEC_TILE_SIZE, width);
+        }
+        if(report_progress((tile + width) * k) == e_failure)
+        {
+            put_pool_buffer(reg);
+            put_pool_buffer(feedback);
+            return e_failure;
+        }
+    }
+    put_pool_buffer(reg);
+    put_pool_buffer(feedback);
+    return e_success;
+}
+
+// Function to evaluate a polynomial (highest power first) at x
+static unsigned char eval_poly(const unsigned char *poly, int len, unsigned char x)
+{
+    unsigned char y = poly[0];
+    for(int i = 1; i < len; i++)
+    {
+        y = gf_mul(y, x) ^ poly[i];
+    }
+    return y;
+}
+
+// Function to multiply two polynomials, returns the length of the product
+static int mul_poly(const unsigned char *a, int la, const unsigned char *b, int lb, unsigned char *out)
+{
+    memset(out, 0, la + lb - 1);
+    for(int i = 0; i < la; i++)
+    {
+        for(int j = 0; j < lb; j++)
+        {
+            out[i + j] ^= gf_mul(a[i], b[j]);
+        }
+    }
+    return la + lb - 1;
+}
+
+// Function to compute the syndromes, synd[0] is 0 and synd[i + 1] is the codeword at 2^i
+static int get_syndromes(const unsigned char *msg, int parity, unsigned char *synd)
+{
+    int nonzero = 0;
+
+    synd[0] = 0;
+    for(int i = 0; i < parity; i++)
+    {
+        synd[i + 1] = eval_poly(msg, FEC_CODEWORD_SIZE, gf_exp[i]);
+        nonzero |= synd[i + 1];
+    }
+    return nonzero;
+}
+
+// Function to correct errors and erasures of one codeword (Berlekamp-Massey, Chien search, Forney)
+static Status correct_codeword(unsigned char *msg, int parity, const int *erase_pos, int erase_count)
+{
+    unsigned char synd[FEC_MAX_PARITY + 1], fsynd[FEC_MAX_PARITY];
+    unsigned char err_loc[FEC_CODEWORD_SIZE + 1], old_loc[FEC_CODEWORD_SIZE + 1], tmp[FEC_CODEWORD_SIZE + 1];
+    unsigned char errata_loc[FEC_CODEWORD_SIZE + 1], product[2 * FEC_CODEWORD_SIZE + 2], evaluator[FEC_CODEWORD_SIZE + 1];
+    int pos[FEC_CODEWORD_SIZE];
+    int count = erase_count;
+
+    // STEP1: More erasures than parity bytes can not be rebuilt
+    if(erase_count > parity)
+    {
+        return e_failure;
+    }
+    if(get_syndromes(msg, parity, synd) == 0)
+    {
+        return e_success;
+    }
+
+    // STEP2: Forney syndromes hide the erasures from the error locator search
+    memcpy(fsynd, synd + 1, parity);
+    for(int e = 0; e < erase_count; e++)
+    {
+        unsigned char x = gf_exp[FEC_CODEWORD_SIZE - 1 - erase_pos[e]];
+        for(int j = 0; j < parity - 1; j++)
+        {
+            fsynd[j] = gf_mul(fsynd[j], x) ^ fsynd[j + 1];
+        }
+    }
+
+    // STEP3: Berlekamp-Massey on the Forney syndromes finds the error locator
+    int err_len = 1, old_len = 1;
+    err_loc[0] = old_loc[0] = 1;
+    for(int i = 0; i < parity - erase_count; i++)
+    {
+        unsigned char delta = fsynd[i];
+        for(int j = 1; j < err_len && j <= i; j++)
+        {
+            delta ^= gf_mul(err_loc[err_len - 1 - j], fsynd[i - j]);
+        }
+        old_loc[old_len++] = 0;
+        if(delta != 0)
+        {
+            if(old_len > err_len)
+            {
+                for(int j = 0; j < old_len; j++)
+                {
+                    tmp[j] = gf_mul(old_loc[j], delta);
+                }
+                for(int j = 0; j < err_len; j++)
+                {
+                    old_loc[j] = gf_mul(err_loc[j], gf_inverse(delta));
+                }
+                int tmp_len = old_len;
+                old_len = err_len;
+                memcpy(err_loc, tmp, tmp_len);
+                err_len = tmp_len;
+            }
+            // err_loc += delta * old_loc, aligned on the lowest power
+            for(int j = 0; j < old_len; j++)
+            {
+                err_loc[err_len - old_len + j] ^= gf_mul(old_loc[j], delta);
+            }
+        }
+    }
+    int skip = 0;
+    while(skip < err_len - 1 && err_loc[skip] == 0)
+    {
+        skip++;
+    }
+    memmove(err_loc, err_loc + skip, err_len - skip);
+    err_len -= skip;
+    int errors = err_len - 1;
+    if(errors * 2 + erase_count > parity)
+    {
+        return e_failure;
+    }
+
+    // STEP4: Chien search, the roots of the reversed locator give the error positions
+    memcpy(pos, erase_pos, erase_count * sizeof(int));
+    for(int i = 0; i < err_len; i++)
+    {
+        tmp[i] = err_loc[err_len - 1 - i];
+    }
+    for(int i = 0; i < FEC_CODEWORD_SIZE; i++)
+    {
+        if(eval_poly(tmp, err_len, gf_exp[i]) == 0)
+        {
+            if(count == FEC_CODEWORD_SIZE)
+            {
+                return e_failure;
+            }
+            pos[count++] = FEC_CODEWORD_SIZE - 1 - i;
+        }
+    }
+    if(count - erase_count != errors)
+    {
+        return e_failure;
+    }
+
+    // STEP5: Errata locator of errors and erasures, evaluator = synd * locator mod x^(count + 1)
+    int loc_len = 1;
+    errata_loc[0] = 1;
+    for(int e = 0; e < count; e++)
+    {
+        unsigned char factor[2] = { gf_exp[FEC_CODEWORD_SIZE - 1 - pos[e]], 1 };
+        loc_len = mul_poly(errata_loc, loc_len, factor, 2, tmp);
+        memcpy(errata_loc, tmp, loc_len);
+    }
+    for(int i = 0; i <= parity; i++)
+    {
+        tmp[i] = synd[parity - i];
+    }
+    int product_len = mul_poly(tmp, parity + 1, errata_loc, loc_len, product);
+    memcpy(evaluator, product + product_len - loc_len, loc_len);
+
+    // STEP6: Forney, magnitude at X = 2^(coefficient position) is X * evaluator(1/X) / locator'(1/X)
+    for(int e = 0; e < count; e++)
+    {
+        unsigned char x = gf_exp[FEC_CODEWORD_SIZE - 1 - pos[e]];
+        unsigned char x_inv = gf_inverse(x);
+        unsigned char prime = 1;
+        for(int j = 0; j < count; j++)
+        {
+            if(j != e)
+            {
+                prime = gf_mul(prime, 1 ^ gf_mul(x_inv, gf_exp[FEC_CODEWORD_SIZE - 1 - pos[j]]));
+            }
+        }
+        if(prime == 0)
+        {
+            return e_failure;
+        }
+        msg[pos[e]] ^= gf_div(gf_mul(x, eval_poly(evaluator, loc_len, x_inv)), prime);
+    }
+
+    // STEP7: Only a codeword again counts as repaired
+    return get_syndromes(msg, parity, synd) == 0 ? e_success : e_failure;
+}
+
+// Function to repair one column, bytes past the available stream are erasures
+static void repair_column(FecInfo *fec, long column)
+{
+    unsigned char msg[FEC_CODEWORD_SIZE];
+    int erase_pos[FEC_CODEWORD_SIZE];
+    int erase_count = 0;
+
+    for(int j = 0; j < FEC_CODEWORD_SIZE; j++)
+    {
+        long index = j * fec->columns + column;
+        msg[j] = fec->stream[index];
+        if(index >= fec->available)
+        {
+            erase_pos[erase_count++] = j;
+        }
+    }
+    if(correct_codeword(msg, fec->parity, erase_pos, erase_count) == e_failure)
+    {
+        fec->failed++;
+        return;
+    }
+    for(int j = 0; j < FEC_CODEWORD_SIZE; j++)
+    {
+        fec->stream[j * fec->columns + column] = msg[j];
+    }
+    fec->repaired++;
+}
+
+// Function to find and repair the damaged codewords
+Status fec_decode(FecInfo *fec, const FecKernel *kernel)
+{
+    int parity = fec->parity;
+    long columns = fec->columns;
+
+    init_gf_tables();
+    unsigned char *synd = get_pool_buffer((long)parity * FEC_TILE_SIZE);
+    uint64_t *dirty = get_pool_buffer(FEC_TILE_SIZE);
+    if(synd == NULL || dirty == NULL)
+    {
+        put_pool_buffer(synd);
+        put_pool_buffer(dirty);
+        return e_failure;
+    }
+
+    fec->repaired = fec->failed = 0;
+    for(long tile = 0; tile < columns; tile += FEC_TILE_SIZE)
+    {
+        long width = columns - tile < FEC_TILE_SIZE ? columns - tile : FEC_TILE_SIZE;
+
+        // STEP1: Syndrome i of every column by Horner over the rows: synd = 2^i * synd ^ row
+        memset(synd, 0, (long)parity * FEC_TILE_SIZE);
+        for(int j = 0; j < FEC_CODEWORD_SIZE; j++)
+        {
+            const unsigned char *row = fec->stream + j * columns + tile;
+            for(int i = 0; i < parity; i++)
+            {
+                kernel->mul_add(synd + (long)i * FEC_TILE_SIZE, row, width, gf_exp[i]);
+            }
+        }
+
+        // STEP2: OR of the syndromes, 8 columns per word
+        memset(dirty, 0, FEC_TILE_SIZE);
+        for(int i = 0; i < parity; i++)
+        {
+            const unsigned char *row = synd + (long)i * FEC_TILE_SIZE;
+            for(long w = 0; w < (width + 7) / 8; w++)
+            {
+                uint64_t value;
+                memcpy(&value, row + w * 8, 8);
+                dirty[w] |= value;
+            }
+        }
+
+        // STEP3: Only columns with a nonzero syndrome are decoded one by one
+        for(long w = 0; w < (width + 7) / 8; w++)
+        {
+            for(int b = 0; dirty[w] && b < 8 && w * 8 + b < width; b++)
+            {
+                if((dirty[w] >> (8 * b)) & 0xFF)
+                {
+                    repair_column(fec, tile + w * 8 + b);
+                }
+            }
+        }
+        if(report_progress((tile + width) * FEC_CODEWORD_SIZE) == e_failure)
+        {
+            put_pool_buffer(synd);
+            put_pool_buffer(dirty);
+            return e_failure;
+        }
+    }
+    put_pool_buffer(synd);
+    put_pool_buffer(dirty);
+    return fec->failed ? e_failure : e_success;
+}
+
+// Function to store a 32 bit value, same byte order as the stream header
+static void put_fec_uint(unsigned char *buffer, uint value)
+{
+    for(int i = 0; i < 4; i++)
+    {
+        buffer[i] = (value >> (i * 8)) & 0xFF;
+    }
+}
+
+static uint get_fec_uint(const unsigned char *buffer)
+{
+    return buffer[0] | buffer[1] << 8 | buffer[2] << 16 | (uint)buffer[3] << 24;
+}
+
+// Function to encode the bmp header and the whole protected stream
+Status encode_fec_stream(EncodeInfo *encInfo)
+{
+    char header[64];
+    unsigned char prefix[2 + FEC_HEADER_SIZE * FEC_HEADER_COPIES];
+    char secret_data[MAX_BLOCK_SIZE], check_data[MAX_BLOCK_SIZE];
+    char arr[MAX_BLOCK_SIZE * 8];
+    FecInfo fec;
+
+    // STEP1: Protected data is the plain stream after the magic string, then the secret data
+    long header_size = build_stream_header(header, encInfo->extn_secret_file, encInfo->size_secret_file) - strlen(MAGIC_STRING);
+    memset(&fec, 0, sizeof(fec));
+    fec.parity = encInfo->fec_parity;
+    fec.data_size = header_size + encInfo->size_secret_file;
+    fec.columns = get_fec_columns(fec.data_size, fec.parity);
+    fec.stream = get_pool_buffer(fec.columns * FEC_CODEWORD_SIZE);
+    if(fec.stream == NULL)
+    {
+        return e_failure;
+    }
+    memset(fec.stream, 0, fec.columns * FEC_CODEWORD_SIZE);
+    memcpy(fec.stream, header + strlen(MAGIC_STRING), header_size);
+    if(fread(fec.stream + header_size, 1, encInfo->size_secret_file, encInfo->fptr_secret) != (size_t)encInfo->size_secret_file)
+    {
+        put_pool_buffer(fec.stream);
+        return e_failure;
+    }
+
+    // STEP2: Parity rows
+    start_progress_stage("parity", fec.columns * (FEC_CODEWORD_SIZE - fec.parity));
+    if(fec_encode(&fec, get_fec_kernel()) == e_failure)
+    {
+        put_pool_buffer(fec.stream);
+        return e_failure;
+    }
+
+    // STEP3: bmp header, magic string and the header copies
+    memcpy(prefix, FEC_MAGIC_STRING, 2);
+    for(int i = 0; i < FEC_HEADER_COPIES; i++)
+    {
+        unsigned char *copy = prefix + 2 + i * FEC_HEADER_SIZE;
+        memset(copy, 0, FEC_HEADER_SIZE);
+        put_fec_uint(copy, fec.data_size);
+        copy[4] = fec.parity;
+        copy[5] = FEC_CODEWORD_SIZE;
+    }
+    if(copy_bmp_header(encInfo->fptr_src_image, encInfo->fptr_stego_image) == e_failure ||
+       encode_block_to_image((const char *)prefix, sizeof(prefix), encInfo->fptr_src_image, encInfo->fptr_stego_image) == e_failure)
+    {
+        put_pool_buffer(fec.stream);
+        return e_failure;
+    }
+
+    // STEP4: Embed the protected stream block by block, with --verify extract every block again
+    long total = fec.columns * FEC_CODEWORD_SIZE;
+    start_progress_stage("data", total);
+    for(long done = 0; done < total; )
+    {
+        long block = total - done < MAX_BLOCK_SIZE ? total - done : MAX_BLOCK_SIZE;
+        memcpy(secret_data, fec.stream + done, block);
+        if(fread(arr, 1, block * 8, encInfo->fptr_src_image) != (size_t)(block * 8))
+        {
+            put_pool_buffer(fec.stream);
+            return e_failure;
+        }
+        PROBE3(embed__enter, progress.job_id, done, block);
+        encode_bytes_to_lsb(secret_data, block, arr);
+        PROBE3(embed__leave, progress.job_id, done, block);
+        if(encInfo->verify)
+        {
+            // The scalar decode_lsb_to_byte(), so a bug in the selected kernel can not hide itself
+            PROBE3(extract__enter, progress.job_id, done, block);
+            for(long i = 0; i < block; i++)
+            {
+                decode_lsb_to_byte(&check_data[i], &arr[i * 8]);
+            }
+            PROBE3(extract__leave, progress.job_id, done, block);
+            if(memcmp(check_data, secret_data, block) != 0)
+            {
+                printf("INFO: Verification failed at stream byte %ld!\n\n", done);
+                put_pool_buffer(fec.stream);
+                return e_failure;
+            }
+            encInfo->verified_size += block;
+        }
+        if(fwrite(arr, 1, block * 8, encInfo->fptr_stego_image) != (size_t)(block * 8))
+        {
+            put_pool_buffer(fec.stream);
+            return e_failure;
+        }
+        done += block;
+        if(report_progress(done) == e_failure)
+        {
+            printf("INFO: Cancelled at stream byte %ld!\n\n", done);
+            put_pool_buffer(fec.stream);
+            return e_failure;
+        }
+    }
+    printf("INFO: %ld codewords of %d parity bytes protect %ld stream bytes.\n\n", fec.columns, fec.parity, fec.data_size);
+    put_pool_buffer(fec.stream);
+    return e_success;
+}
+
+// Function to read and repair the protected stream, then decode the header fields from it
+Status decode_fec_stream(DecodeInfo *decInfo)
+{
+    unsigned char copies[FEC_HEADER_SIZE * FEC_HEADER_COPIES], header[FEC_HEADER_SIZE];
+    FecInfo fec;
+
+    // STEP1: The stream is repaired in memory, there is nothing to resume
+    if(decInfo->journal.enabled)
+    {
+        printf("INFO: --journal can not be used with an FEC carrier!\n\n");
+        return e_failure;
+    }
+
+    // STEP2: Header copies after the magic string, every bit by majority, then the protected stream
+    long image_offset = 54 + strlen(FEC_MAGIC_STRING) * 8;
+    if(decode_image_to_block_at((char *)copies, sizeof(copies), decInfo->fptr_enc_image, image_offset, -1) == e_failure)
+    {
+        return e_failure;
+    }
+    for(int i = 0; i < FEC_HEADER_SIZE; i++)
+    {
+        unsigned char a = copies[i], b = copies[FEC_HEADER_SIZE + i], c = copies[2 * FEC_HEADER_SIZE + i];
+        header[i] = (a & b) | (a & c) | (b & c);
+    }
+    memset(&fec, 0, sizeof(fec));
+    fec.data_size = get_fec_uint(header);
+    fec.parity = header[4];
+    if(fec.parity < 2 || fec.parity > FEC_MAX_PARITY || fec.parity % 2 || header[5] != FEC_CODEWORD_SIZE || fec.data_size < 8)
+    {
+        printf("INFO: The FEC header is corrupted!\n\n");
+        return e_failure;
+    }
+
+    // STEP3: Untrusted size, the stream must be in the image except what the parity can rebuild
+    fec.columns = get_fec_columns(fec.data_size, fec.parity);
+    long total = fec.columns * FEC_CODEWORD_SIZE;
+    long in_image = get_remaining_image_bytes(decInfo->fptr_enc_image) / 8;
+    fec.available = total < in_image ? total : in_image;
+    if(fec.available < fec.columns * (FEC_CODEWORD_SIZE - fec.parity))
+    {
+        printf("INFO: The FEC stream of %ld bytes does not fit the image!\n\n", total);
+        return e_failure;
+    }
+    if(admit_allocation(total) == e_failure)
+    {
+        return e_failure;
+    }
+    fec.stream = get_pool_buffer(fec.columns * FEC_CODEWORD_SIZE);
+    if(fec.stream == NULL)
+    {
+        return e_failure;
+    }
+    memset(fec.stream, 0, fec.columns * FEC_CODEWORD_SIZE);
+    decInfo->fec_stream = (char *)fec.stream;
+
+    // STEP4: Read what the image holds, a missing tail stays zero and is rebuilt as erasures
+    start_progress_stage("data", fec.available);
+    for(long done = 0; done < fec.available; )
+    {
+        long block = fec.available - done < MAX_BLOCK_SIZE ? fec.available - done : MAX_BLOCK_SIZE;
+        if(decode_image_to_block_at((char *)fec.stream + done, block, decInfo->fptr_enc_image,
+                                    image_offset + (long)(sizeof(copies) + done) * 8, done) == e_failure)
+        {
+            return e_failure;
+        }
+        done += block;
+        if(report_progress(done) == e_failure)
+        {
+            return e_failure;
+        }
+    }
+
+    // STEP5: Repair
+    start_progress_stage("repair", total);
+    Status repair_status = fec_decode(&fec, get_fec_kernel());
+    decInfo->fec_repaired = fec.repaired;
+    if(fec.available < total)
+    {
+        printf("INFO: The image ends %ld stream bytes early, rebuilt from parity.\n\n", total - fec.available);
+    }
+    if(repair_status == e_failure)
+    {
+        if(fec.failed)
+        {
+            printf("INFO: %ld of %ld codewords have too many errors to repair!\n\n", fec.failed, fec.columns);
+        }
+        return e_failure;
+    }
+    printf("INFO: %ld of %ld codewords repaired.\n\n", fec.repaired, fec.columns);
+
+    // STEP6: Header fields from the repaired stream, same checks as a plain carrier
+    decInfo->extn_file_size = get_fec_uint(fec.stream);
+    if(decInfo->extn_file_size <= 0 || decInfo->extn_file_size > MAX_DECODE_EXTN_SIZE ||
+       8 + decInfo->extn_file_size > fec.data_size)
+    {
+        printf("INFO: The extension size %ld is corrupted!\n\n", decInfo->extn_file_size);
+        return e_failure;
+    }
+    decInfo->size_secret_file = get_fec_uint(fec.stream + 4 + decInfo->extn_file_size);
+    if(decInfo->size_secret_file != fec.data_size - 8 - decInfo->extn_file_size)
+    {
+        printf("INFO: The secret size %ld does not match the FEC stream!\n\n", decInfo->size_secret_file);
+        return e_failure;
+    }
+    if(admit_output_bytes(decInfo->range_selected ? decInfo->range_length : decInfo->size_secret_file) == e_failure ||
+       admit_allocation(decInfo->extn_file_size + 1) == e_failure)
+    {
+        return e_failure;
+    }
+    decInfo->extn_secret_file = arena_alloc(decInfo->extn_file_size + 1);
+    if(!decInfo->extn_secret_file)
+    {
+        return e_failure;
+    }
+    memcpy(decInfo->extn_secret_file, fec.stream + 4, decInfo->extn_file_size);
+    decInfo->extn_secret_file[decInfo->extn_file_size] = '\0';
+    return add_secret_file_extn(decInfo);
+}
+
+// Function to write the secret data (or --range slice) from the repaired stream
+Status write_fec_data(DecodeInfo *decInfo)
+{
+    long offset = decInfo->range_selected ? decInfo->range_offset : 0;
+    long length = decInfo->range_selected ? decInfo->range_length : decInfo->size_secret_file;
+
+    if(offset > decInfo->size_secret_file || length > decInfo->size_secret_file - offset)
+    {
+        printf("INFO: The range %ld:%ld is outside the secret data of %ld bytes!\n\n", offset, length, decInfo->size_secret_file);
+        return e_failure;
+    }
+    const char *data = decInfo->fec_stream + 8 + decInfo->extn_file_size;
+    return fwrite(data + offset, 1, length, decInfo->fptr_secret) == (size_t)length ? e_success : e_failure;
+}
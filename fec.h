@@ -0,0 +1,92 @@
+#ifndef FEC_H
+#define FEC_H
+
+#include "types.h" // Contains user defined types
+#include "encode.h"
+#include "decode.h"
+
+/*
+ * Reed-Solomon forward error correction for the stego stream (--fec)
+ *
+ * Stream after the bmp header:
+ * FEC_MAGIC_STRING | FEC header x FEC_HEADER_COPIES | protected stream
+ * FEC header: data size (4) | parity (1) | codeword size 255 (1) | 0 (2),
+ * read back bit by bit by majority of the copies.
+ * Protected data is the plain stream after the magic string (extension
+ * size, extension, secret size, data), zero padded to k * columns bytes
+ * (k = 255 - parity), followed by parity * columns parity bytes.
+ *
+ * Byte j of codeword i sits at j * columns + i, so every codeword spans
+ * the whole payload: a burst of B corrupted bytes costs each codeword
+ * about B / columns symbols and a truncated tail only loses whole rows,
+ * repaired as erasures. Each codeword fixes parity / 2 errors or parity
+ * erasures. Rows are encoded and checked for all columns at once with
+ * GF(2^8) multiply kernels (two 16 entry nibble tables and a byte shuffle);
+ * only codewords with a nonzero syndrome are decoded one by one
+ */
+
+#define FEC_CODEWORD_SIZE 255
+#define FEC_DEFAULT_PARITY 32           // Fixes 16 corrupted bytes per codeword
+#define FEC_MAX_PARITY 128
+#define FEC_HEADER_SIZE 8
+#define FEC_HEADER_COPIES 3
+#define FEC_TILE_SIZE 4096              // Columns processed together, keeps the parity rows in cache
+
+/* dst ^= c * src, and dst = c * dst ^ src, over size bytes */
+typedef void (*FecMulXorFn)(unsigned char *dst, const unsigned char *src, long size, unsigned char c);
+typedef void (*FecMulAddFn)(unsigned char *dst, const unsigned char *src, long size, unsigned char c);
+
+typedef struct _FecKernel
+{
+    const char *name;           // Variant name (scalar, ssse3, avx2, avx512)
+    int (*supported)(void);     // Returns 1 if this CPU can run the variant
+    FecMulXorFn mul_xor;        // Parity rows while encoding
+    FecMulAddFn mul_add;        // Syndrome rows while decoding (Horner step)
+} FecKernel;
+
+typedef struct _FecInfo
+{
+    int parity;                 // Parity bytes per codeword
+    long data_size;             // Stream bytes protected
+    long columns;               // Number of codewords
+    unsigned char *stream;      // columns * 255 bytes, data rows then parity rows
+    long available;             // Stream bytes read from the image, the rest are erasures
+    long repaired;              // Codewords repaired
+    long failed;                // Codewords with more errors than the parity can fix
+
+} FecInfo;  // Datatype of the structure
+
+
+/* FEC function prototype */
+
+/* Read --fec or --fec=parity */
+Status parse_fec_parity(const char *arg, int *parity);
+
+/* Number of codewords for data_size bytes */
+long get_fec_columns(long data_size, int parity);
+
+/* Image bytes needed to encode a secret with --fec, same form as get_encoded_size() */
+unsigned long long get_fec_encoded_size(uint extn_size, long secret_size, int parity);
+
+/* Get the kernel named like the selected LSB kernel, else the best supported one */
+const FecKernel *get_fec_kernel(void);
+
+/* Get the table of all kernels compiled in, terminated by a NULL name */
+const FecKernel *get_fec_kernel_table(void);
+
+/* Compute the parity rows from the data rows */
+Status fec_encode(FecInfo *fec, const FecKernel *kernel);
+
+/* Repair every codeword with a nonzero syndrome, bytes past available are erasures */
+Status fec_decode(FecInfo *fec, const FecKernel *kernel);
+
+/* Encode the bmp header and the whole protected stream (replaces the header and data steps) */
+Status encode_fec_stream(EncodeInfo *encInfo);
+
+/* Read and repair the protected stream, then decode the header fields from it */
+Status decode_fec_stream(DecodeInfo *decInfo);
+
+/* Write the secret data (or --range slice) from the repaired stream */
+Status write_fec_data(DecodeInfo *decInfo);
+
+#endif
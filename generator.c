@@ -0,0 +1,401 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/stat.h>
+// User-defined header files
+#include "generator.h"
+#include "encode.h"
+#include "admission.h"
+#include "lsb_mode.h"
+#include "types.h"
+#include "common.h"
+
+/* Function Definitions */
+
+// Function to read and validate command line arguments entered by user after -g
+Status read_and_validate_generator_args(int argc, char *argv[], GeneratorInfo *genInfo)
+{
+    // STEP1: Store the workload file and the output directory
+    genInfo->workload_fname = argv[2];
+    genInfo->output_dirname = argv[3];
+    if(argc > 4)
+    {
+        return e_failure;
+    }
+
+    // STEP2: Read the classes of the workload file
+    return read_workload_file(genInfo);
+}
+
+// Function to mix a 64 bit value (splitmix64), used to seed the streams
+static uint64_t mix_seed(uint64_t value)
+{
+    value += 0x9E3779B97F4A7C15ULL;
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+    return value ^ (value >> 31);
+}
+
+// Function to seed the stream of one file from the seed, class name, file kind and index
+static uint64_t seed_stream(GeneratorInfo *genInfo, GeneratorClass *cls, char kind, long index)
+{
+    uint64_t hash = 0xCBF29CE484222325ULL;
+
+    // FNV-1a of the class name and kind, so adding a class does not change the others
+    for(const char *ptr = cls->name; *ptr; ptr++)
+    {
+        hash = (hash ^ (unsigned char)*ptr) * 0x100000001B3ULL;
+    }
+    hash = (hash ^ (unsigned char)kind) * 0x100000001B3ULL;
+    uint64_t state = mix_seed(genInfo->seed ^ mix_seed(hash ^ mix_seed(index)));
+    return state ? state : 1;
+}
+
+// Function to get the next value of a stream (xorshift64*)
+static uint64_t next_random(uint64_t *state)
+{
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 0x2545F4914F6CDD1DULL;
+}
+
+// Function to read one class line of the workload file
+static Status read_workload_class(char *line, GeneratorClass *cls)
+{
+    char header[8], content[16], secret[32];
+
+    if(sscanf(line, "%31s %ld %ld %ld %ld %d %7s %15s %31s %d", cls->name, &cls->jobs, &cls->covers,
+              &cls->width, &cls->height, &cls->bpp, header, content, secret, &cls->entropy) != 10)
+    {
+        return e_failure;
+    }
+    if(cls->jobs <= 0 || cls->covers <= 0 || cls->covers > cls->jobs ||
+       cls->width <= 0 || cls->width > GENERATOR_MAX_DIMENSION || cls->height <= 0 || cls->height > GENERATOR_MAX_DIMENSION ||
+       (cls->bpp != 24 && cls->bpp != 32) || cls->entropy < 0 || cls->entropy > 8 ||
+       parse_admission_size(secret, &cls->secret_size) == e_failure)
+    {
+        return e_failure;
+    }
+
+    if(strcmp(header, "info") == 0) cls->header = e_header_info;
+    else if(strcmp(header, "v4") == 0) cls->header = e_header_v4;
+    else if(strcmp(header, "v5") == 0) cls->header = e_header_v5;
+    else return e_failure;
+
+    if(strcmp(content, "random") == 0) cls->content = e_content_random;
+    else if(strcmp(content, "gradient") == 0) cls->content = e_content_gradient;
+    else return e_failure;
+
+    // The secret (.txt extension) must fit the capacity check_capacity() computes for the cover and
+    // the layout the manifests use, counted from where that layout starts (see get_class_layout_args())
+    LsbLayout layout;
+    memset(&layout, 0, sizeof(layout));
+    layout.bpp = cls->bpp;
+    layout.width = cls->width;
+    layout.height = cls->height;
+    layout.pixel_offset = 14 + cls->header;
+    layout.file_size = layout.pixel_offset + (cls->width * cls->bpp + 31) / 32 * 4 * cls->height;
+    const LsbMode *mode = cls->header == e_header_info ? find_lsb_mode(0, 0x1, 1, 0) : find_lsb_mode(cls->bpp, LSB_MODE_DEFAULT_CHANNELS, 1, 0);
+    long stream_size = strlen(MAGIC_STRING) + 4 + strlen(".txt") + 4 + cls->secret_size;
+    if(get_encoded_size(strlen(".txt"), cls->secret_size) >= (unsigned long long)cls->width * cls->height * 3 ||
+       mode == NULL || set_lsb_layout(&layout, mode, cls->header == e_header_info ? 54 : 0) == e_failure ||
+       stream_size > layout.capacity)
+    {
+        printf("INFO: %s: a %ld byte secret does not fit a %ldx%ld cover!\n", cls->name, cls->secret_size, cls->width, cls->height);
+        return e_failure;
+    }
+    return e_success;
+}
+
+// Function to read the workload file
+Status read_workload_file(GeneratorInfo *genInfo)
+{
+    char line[1024];
+    int line_number = 0;
+
+    FILE *fptr_workload = fopen(genInfo->workload_fname, "r");
+    if(fptr_workload == NULL)
+    {
+        perror("fopen");
+        fprintf(stderr, "ERROR: Unable to open file %s\n", genInfo->workload_fname);
+        return e_failure;
+    }
+
+    genInfo->seed = 1;
+    genInfo->class_count = 0;
+    while(fgets(line, sizeof(line), fptr_workload))
+    {
+        char first[GENERATOR_MAX_NAME] = "";
+        line_number++;
+
+        // Skip comments and empty lines
+        char *comment = strchr(line, '#');
+        if(comment)
+        {
+            *comment = '\0';
+        }
+        if(sscanf(line, "%31s", first) != 1)
+        {
+            continue;
+        }
+
+        if(strcmp(first, "seed") == 0)
+        {
+            unsigned long long seed;
+            if(sscanf(line, "%*s %llu", &seed) != 1)
+            {
+                printf("INFO: %s:%d: give the seed as seed N!\n\n", genInfo->workload_fname, line_number);
+                fclose(fptr_workload);
+                return e_failure;
+            }
+            genInfo->seed = seed;
+        }
+        else if(genInfo->class_count == GENERATOR_MAX_CLASSES ||
+                read_workload_class(line, &genInfo->classes[genInfo->class_count]) == e_failure)
+        {
+            printf("INFO: %s:%d is not a valid class (name jobs covers width height bpp header content secret entropy)!\n\n",
+                   genInfo->workload_fname, line_number);
+            fclose(fptr_workload);
+            return e_failure;
+        }
+        else
+        {
+            genInfo->class_count++;
+        }
+    }
+    fclose(fptr_workload);
+
+    if(genInfo->class_count == 0)
+    {
+        printf("INFO: %s has no classes!\n\n", genInfo->workload_fname);
+        return e_failure;
+    }
+    return e_success;
+}
+
+// Function to store a value little endian
+static void put_le(unsigned char *buffer, uint64_t value, int bytes)
+{
+    for(int i = 0; i < bytes; i++)
+    {
+        buffer[i] = value >> (8 * i);
+    }
+}
+
+// Function to write one cover image of a class
+Status write_generated_bmp(GeneratorInfo *genInfo, GeneratorClass *cls, long index, const char *fname)
+{
+    unsigned char header[14 + e_header_v5];
+    long pixel = cls->bpp / 8;
+    long stride = (cls->width * cls->bpp + 31) / 32 * 4;
+    long offset = 14 + cls->header;
+    uint64_t state = seed_stream(genInfo, cls, 'c', index);
+
+    // STEP1: File header and DIB header, no compression, V4/V5 fields as an sRGB image
+    memset(header, 0, sizeof(header));
+    header[0] = 'B';
+    header[1] = 'M';
+    put_le(header + 2, offset + stride * cls->height, 4);
+    put_le(header + 10, offset, 4);
+    put_le(header + 14, cls->header, 4);
+    put_le(header + 18, cls->width, 4);
+    put_le(header + 22, cls->height, 4);
+    put_le(header + 26, 1, 2);
+    put_le(header + 28, cls->bpp, 2);
+    put_le(header + 34, stride * cls->height, 4);
+    put_le(header + 38, 2835, 4);
+    put_le(header + 42, 2835, 4);
+    if(cls->header != e_header_info)
+    {
+        put_le(header + 14 + 56, 0x73524742, 4);    // LCS_sRGB
+    }
+    if(cls->header == e_header_v5)
+    {
+        put_le(header + 14 + 108, 4, 4);            // LCS_GM_IMAGES
+    }
+
+    FILE *fptr_image = fopen(fname, "w");
+    if(fptr_image == NULL)
+    {
+        perror("fopen");
+        fprintf(stderr, "ERROR: Unable to open file %s\n", fname);
+        return e_failure;
+    }
+    unsigned char *row = calloc(stride + 8, 1);
+    if(row == NULL || fwrite(header, 1, offset, fptr_image) != (size_t)offset)
+    {
+        free(row);
+        fclose(fptr_image);
+        return e_failure;
+    }
+
+    // STEP2: Rows bottom up, padding bytes stay zero
+    for(long y = 0; y < cls->height; y++)
+    {
+        if(cls->content == e_content_random)
+        {
+            for(long x = 0; x < cls->width * pixel; x += 8)
+            {
+                put_le(row + x, next_random(&state), 8);
+            }
+            memset(row + cls->width * pixel, 0, stride - cls->width * pixel);
+        }
+        else
+        {
+            // Blue follows x, green follows y, red is shifted per cover so covers differ
+            for(long x = 0; x < cls->width; x++)
+            {
+                row[x * pixel] = cls->width > 1 ? x * 255 / (cls->width - 1) : 0;
+                row[x * pixel + 1] = cls->height > 1 ? y * 255 / (cls->height - 1) : 0;
+                row[x * pixel + 2] = (x + y + index * 37) & 0xFF;
+                if(pixel == 4)
+                {
+                    row[x * pixel + 3] = 0xFF;
+                }
+            }
+        }
+        if(fwrite(row, 1, stride, fptr_image) != (size_t)stride)
+        {
+            free(row);
+            fclose(fptr_image);
+            return e_failure;
+        }
+    }
+    free(row);
+    return fclose(fptr_image) == 0 ? e_success : e_failure;
+}
+
+// Function to write one secret of a class, every byte uniform over 2^entropy values
+Status write_generated_secret(GeneratorInfo *genInfo, GeneratorClass *cls, long index, const char *fname)
+{
+    unsigned char buffer[65536];
+    uint64_t state = seed_stream(genInfo, cls, 's', index);
+    unsigned char mask = (1 << cls->entropy) - 1;
+
+    FILE *fptr_secret = fopen(fname, "w");
+    if(fptr_secret == NULL)
+    {
+        perror("fopen");
+        fprintf(stderr, "ERROR: Unable to open file %s\n", fname);
+        return e_failure;
+    }
+    for(long done = 0; done < cls->secret_size; done += sizeof(buffer))
+    {
+        long block = cls->secret_size - done < (long)sizeof(buffer) ? cls->secret_size - done : (long)sizeof(buffer);
+        for(long i = 0; i < block; i += 8)
+        {
+            uint64_t value = next_random(&state);
+            for(long j = i; j < i + 8 && j < block; j++, value >>= 8)
+            {
+                buffer[j] = value & mask;
+            }
+        }
+        if(fwrite(buffer, 1, block, fptr_secret) != (size_t)block)
+        {
+            fclose(fptr_secret);
+            return e_failure;
+        }
+    }
+    return fclose(fptr_secret) == 0 ? e_success : e_failure;
+}
+
+// Function to get the layout options of a class's jobs, tab separated: an info header takes the default layout,
+// a v4/v5 header the pixel mode from the pixel data offset, the default layout from byte 54 would overwrite its DIB header
+static const char *get_class_layout_args(GeneratorClass *cls)
+{
+    return cls->header != e_header_info ? "\t--bits\t1\t--channels\tbgr" : "";
+}
+
+// Function to write encode.manifest and decode.manifest
+Status write_workload_manifests(GeneratorInfo *genInfo)
+{
+    char encode_fname[GENERATOR_MAX_PATH], decode_fname[GENERATOR_MAX_PATH];
+    const char *dir = genInfo->output_dirname;
+
+    snprintf(encode_fname, sizeof(encode_fname), "%s/encode.manifest", dir);
+    snprintf(decode_fname, sizeof(decode_fname), "%s/decode.manifest", dir);
+    FILE *fptr_encode = fopen(encode_fname, "w");
+    FILE *fptr_decode = fopen(decode_fname, "w");
+    if(fptr_encode == NULL || fptr_decode == NULL)
+    {
+        perror("fopen");
+        fprintf(stderr, "ERROR: Unable to open file %s\n", fptr_encode == NULL ? encode_fname : decode_fname);
+        if(fptr_encode) fclose(fptr_encode);
+        if(fptr_decode) fclose(fptr_decode);
+        return e_failure;
+    }
+
+    // One line per job in workload order, the runner's scheduler orders them by cost
+    for(int c = 0; c < genInfo->class_count; c++)
+    {
+        GeneratorClass *cls = &genInfo->classes[c];
+        for(long j = 0; j < cls->jobs; j++)
+        {
+            fprintf(fptr_encode, "-e\t%s/%s_c%ld.bmp\t%s/%s_%ld.txt\t%s/%s_%ld.stego.bmp%s\n",
+                    dir, cls->name, j % cls->covers, dir, cls->name, j, dir, cls->name, j, get_class_layout_args(cls));
+            fprintf(fptr_decode, "-d\t%s/%s_%ld.stego.bmp\t%s/%s_%ld_decoded%s\n", dir, cls->name, j, dir, cls->name, j,
+                    get_class_layout_args(cls));
+        }
+    }
+    Status ret = fclose(fptr_encode) == 0 ? e_success : e_failure;
+    return fclose(fptr_decode) == 0 ? ret : e_failure;
+}
+
+// Function to write the covers, secrets and manifests
+Status do_generating(GeneratorInfo *genInfo)
+{
+    char fname[GENERATOR_MAX_PATH];
+    long covers = 0, secrets = 0, jobs = 0;
+
+    // STEP1: Create the output directory if needed
+    if(mkdir(genInfo->output_dirname, 0755) != 0 && errno != EEXIST)
+    {
+        perror("mkdir");
+        fprintf(stderr, "ERROR: Unable to create directory %s\n", genInfo->output_dirname);
+        return e_failure;
+    }
+
+    for(int c = 0; c < genInfo->class_count; c++)
+    {
+        GeneratorClass *cls = &genInfo->classes[c];
+
+        // STEP2: Covers of the class
+        for(long i = 0; i < cls->covers; i++)
+        {
+            snprintf(fname, sizeof(fname), "%s/%s_c%ld.bmp", genInfo->output_dirname, cls->name, i);
+            if(write_generated_bmp(genInfo, cls, i, fname) == e_failure)
+            {
+                printf("INFO: %s could not be written!\n\n", fname);
+                return e_failure;
+            }
+            covers++;
+        }
+
+        // STEP3: One secret per job
+        for(long j = 0; j < cls->jobs; j++)
+        {
+            snprintf(fname, sizeof(fname), "%s/%s_%ld.txt", genInfo->output_dirname, cls->name, j);
+            if(write_generated_secret(genInfo, cls, j, fname) == e_failure)
+            {
+                printf("INFO: %s could not be written!\n\n", fname);
+                return e_failure;
+            }
+            secrets++;
+        }
+        jobs += cls->jobs;
+        printf("INFO: %-16s %6ld jobs on %ld %ldx%ld %d bpp %s covers, %ld byte secrets.\n", cls->name, cls->jobs, cls->covers,
+               cls->width, cls->height, cls->bpp, cls->content == e_content_random ? "random" : "gradient", cls->secret_size);
+    }
+
+    // STEP4: Manifests for -j
+    if(write_workload_manifests(genInfo) == e_failure)
+    {
+        printf("INFO: The manifests could not be written!\n\n");
+        return e_failure;
+    }
+    printf("\nINFO: Generated %ld covers, %ld secrets and %ld jobs in %s (seed %llu).\n\n", covers, secrets, jobs,
+           genInfo->output_dirname, (unsigned long long)genInfo->seed);
+    return e_success;
+}
@@ -0,0 +1,97 @@
+#ifndef GENERATOR_H
+#define GENERATOR_H
+
+#include <stdint.h>
+#include "types.h" // Contains user defined types
+
+/*
+ * Structures to store information required for
+ * generating a synthetic corpus and workload manifests from a workload file
+ *
+ * Workload file (whitespace separated, # starts a comment):
+ * seed  42
+ * name  jobs  covers  width  height  bpp  header  content  secret  entropy
+ *
+ * bpp: 24 or 32, header: info (40 byte), v4 (108) or v5 (124) DIB header,
+ * content: random or gradient, secret: bytes with optional K/M/G,
+ * entropy: bits per secret byte, 0 (all zero) to 8 (uniform random)
+ * Rows are padded to 4 bytes, so a 24 bpp width that is not a multiple
+ * of 4 gives padded rows
+ *
+ * Job j of a class uses cover j % covers and its own secret. Everything
+ * comes from one xorshift64* stream per file seeded from seed, class
+ * name and index, so the corpus is byte-identical on every machine.
+ * Output directory gets name_cN.bmp, name_N.txt, encode.manifest
+ * (-e jobs for -j) and decode.manifest (-d jobs on the encode outputs)
+ *
+ * Jobs of info header classes use the default layout from byte 54.
+ * The default layout would overwrite the rest of a v4/v5 DIB header,
+ * so those jobs use --bits 1 --channels bgr from the pixel data offset.
+ * A class's secret must fit the layout its jobs use
+ */
+
+#define GENERATOR_MAX_CLASSES 64
+#define GENERATOR_MAX_NAME 32
+#define GENERATOR_MAX_PATH 4096
+#define GENERATOR_MAX_DIMENSION 65536
+
+typedef enum
+{
+    e_header_info = 40,
+    e_header_v4 = 108,
+    e_header_v5 = 124
+} GeneratorHeader;
+
+typedef enum
+{
+    e_content_random,
+    e_content_gradient
+} GeneratorContent;
+
+typedef struct _GeneratorClass
+{
+    char name[GENERATOR_MAX_NAME];  // Prefix of every file of the class
+    long jobs;                  // Encode jobs in the manifest
+    long covers;                // Distinct cover images, shared round robin by the jobs
+    long width, height;
+    int bpp;                    // 24 or 32
+    GeneratorHeader header;     // DIB header size
+    GeneratorContent content;
+    long secret_size;           // Bytes of every secret
+    int entropy;                // Bits per secret byte
+
+} GeneratorClass;
+
+typedef struct _GeneratorInfo
+{
+    char *workload_fname;       // Workload file
+    char *output_dirname;       // Directory for the corpus and manifests
+    uint64_t seed;              // seed line of the workload file
+
+    GeneratorClass classes[GENERATOR_MAX_CLASSES];
+    int class_count;
+
+} GeneratorInfo;  // Datatype of the structure
+
+
+/* Generator function prototype */
+
+/* Read and validate generator args from argv, then the workload file */
+Status read_and_validate_generator_args(int argc, char *argv[], GeneratorInfo *genInfo);
+
+/* Write the covers, secrets and manifests */
+Status do_generating(GeneratorInfo *genInfo);
+
+/* Read the workload file */
+Status read_workload_file(GeneratorInfo *genInfo);
+
+/* Write one cover image of a class */
+Status write_generated_bmp(GeneratorInfo *genInfo, GeneratorClass *cls, long index, const char *fname);
+
+/* Write one secret of a class */
+Status write_generated_secret(GeneratorInfo *genInfo, GeneratorClass *cls, long index, const char *fname);
+
+/* Write encode.manifest and decode.manifest */
+Status write_workload_manifests(GeneratorInfo *genInfo);
+
+#endif
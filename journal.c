@@ -0,0 +1,91 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+// User-defined header files
+#include "journal.h"
+#include "pool.h"
+#include "types.h"
+
+/* Function Definitions */
+
+// Function to open the sidecar of output_fname, load it if it exists
+Status open_journal(JournalInfo *journal, const char *output_fname)
+{
+    // STEP1: Sidecar name is the output name with the journal suffix
+    journal->journal_fname = arena_alloc(strlen(output_fname) + strlen(JOURNAL_SUFFIX) + 1);
+    if(!journal->journal_fname)
+    {
+        return e_failure;
+    }
+    strcpy(journal->journal_fname, output_fname);
+    strcat(journal->journal_fname, JOURNAL_SUFFIX);
+
+    // STEP2: An existing sidecar with a valid record means resume
+    journal->fptr_journal = fopen(journal->journal_fname, "r+");
+    if(journal->fptr_journal)
+    {
+        if(fscanf(journal->fptr_journal, "%ld %ld", &journal->image_offset, &journal->data_offset) == 2 &&
+           journal->image_offset > 0 && journal->data_offset >= 0)
+        {
+            journal->resumed = 1;
+            printf("INFO: Resuming from %s at secret byte %ld.\n\n", journal->journal_fname, journal->data_offset);
+            return e_success;
+        }
+        fclose(journal->fptr_journal);
+    }
+
+    // STEP3: Otherwise start a new sidecar
+    journal->fptr_journal = fopen(journal->journal_fname, "w");
+    if(journal->fptr_journal == NULL)
+    {
+        perror("fopen");
+        fprintf(stderr, "ERROR: Unable to open file %s\n", journal->journal_fname);
+        return e_failure;
+    }
+    return e_success;
+}
+
+// Function to sync the output and record the offsets
+Status write_journal(JournalInfo *journal, FILE *fptr_output, long image_offset, long data_offset)
+{
+    // STEP1: Everything before the offsets must be on disk before the record says so
+    if(fflush(fptr_output) != 0 || fsync(fileno(fptr_output)) != 0)
+    {
+        return e_failure;
+    }
+
+    // STEP2: Fixed width record, rewritten in place
+    rewind(journal->fptr_journal);
+    fprintf(journal->fptr_journal, "%020ld %020ld\n", image_offset, data_offset);
+    if(fflush(journal->fptr_journal) != 0 || fsync(fileno(journal->fptr_journal)) != 0)
+    {
+        return e_failure;
+    }
+    journal->blocks = 0;
+    return e_success;
+}
+
+// Function to count a block, every JOURNAL_INTERVAL_BLOCKS write a checkpoint
+Status update_journal(JournalInfo *journal, FILE *fptr_output, long image_offset, long data_offset)
+{
+    if(!journal->enabled || ++journal->blocks < JOURNAL_INTERVAL_BLOCKS)
+    {
+        return e_success;
+    }
+    return write_journal(journal, fptr_output, image_offset, data_offset);
+}
+
+// Function to close the sidecar, remove it if the job finished
+void close_journal(JournalInfo *journal, Status job_status)
+{
+    if(journal->fptr_journal)
+    {
+        fclose(journal->fptr_journal);
+        journal->fptr_journal = NULL;
+        if(job_status == e_success)
+        {
+            remove(journal->journal_fname);
+        }
+    }
+}
@@ -0,0 +1,45 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include "types.h" // Contains user defined types
+
+/*
+ * Structure to store information required for
+ * checkpointing long encode/decode jobs in a small sidecar file
+ * (<output file>.journal) and resuming them after a crash
+ *
+ * Record: image offset of the next block | secret bytes already done
+ * The output is flushed and synced before every record is written
+ */
+
+#define JOURNAL_SUFFIX ".journal"
+#define JOURNAL_INTERVAL_BLOCKS 256     // Blocks of MAX_BLOCK_SIZE between checkpoints
+
+typedef struct _JournalInfo
+{
+    int enabled;                // Journaling selected (--journal)
+    int resumed;                // A journal was found, the job continues from it
+    char *journal_fname;        // Sidecar file name
+    FILE *fptr_journal;         // File pointer of sidecar file
+    long image_offset;          // Image offset of the next block to process
+    long data_offset;           // Secret bytes already processed
+    int blocks;                 // Blocks since the last checkpoint
+
+} JournalInfo;  // Datatype of the structure
+
+
+/* Journal function prototype */
+
+/* Open the sidecar of output_fname, load it if it exists */
+Status open_journal(JournalInfo *journal, const char *output_fname);
+
+/* Count a block, every JOURNAL_INTERVAL_BLOCKS sync the output and record the offsets */
+Status update_journal(JournalInfo *journal, FILE *fptr_output, long image_offset, long data_offset);
+
+/* Sync the output and record the offsets now */
+Status write_journal(JournalInfo *journal, FILE *fptr_output, long image_offset, long data_offset);
+
+/* Close the sidecar, remove it if the job finished */
+void close_journal(JournalInfo *journal, Status job_status);
+
+#endif
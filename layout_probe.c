@@ -0,0 +1,211 @@
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+// User-defined header files
+#include "layout_probe.h"
+#include "lsb_mode.h"
+#include "decode.h"
+#include "admission.h"
+#include "pool.h"
+#include "types.h"
+#include "common.h"
+
+/* Function Definitions */
+
+// Function to get a little endian 32 bit stream value
+static long get_stream_uint(const unsigned char *ptr)
+{
+    return (long)ptr[0] | (long)ptr[1] << 8 | (long)ptr[2] << 16 | (long)ptr[3] << 24;
+}
+
+// Function to check a candidate on the prefix: 2 plausible header, 1 default magic string only, 0 no match,
+// stream_size is the stream bytes the header claims
+static int check_layout_candidate(const LsbLayout *layout, const char *prefix, long prefix_size, int is_default, long *stream_size)
+{
+    unsigned char header[LAYOUT_PROBE_HEADER_SIZE];
+    long magic_size = strlen(MAGIC_STRING);
+
+    // STEP1: Magic string and extension size, only the default layout carries --fec streams (length unknown here)
+    *stream_size = layout->capacity;
+    if(extract_layout_prefix(layout, prefix, 54, prefix_size, (char *)header, magic_size + 4) == e_failure)
+    {
+        return 0;
+    }
+    if(is_default && memcmp(header, FEC_MAGIC_STRING, magic_size) == 0)
+    {
+        return 2;
+    }
+    if(memcmp(header, MAGIC_STRING, magic_size) != 0)
+    {
+        return 0;
+    }
+    long extn_size = get_stream_uint(header + magic_size);
+    if(extn_size <= 0 || extn_size > MAX_DECODE_EXTN_SIZE)
+    {
+        return 1;
+    }
+
+    // STEP2: Printable extension and a secret size that fits the layout
+    long header_size = magic_size + 4 + extn_size + 4;
+    if(extract_layout_prefix(layout, prefix, 54, prefix_size, (char *)header, header_size) == e_failure)
+    {
+        return 1;
+    }
+    for(long i = 0; i < extn_size; i++)
+    {
+        if(!isprint(header[magic_size + 4 + i]) || header[magic_size + 4 + i] == '/')
+        {
+            return 1;
+        }
+    }
+    long size = get_stream_uint(header + header_size - 4);
+    if(size < 0 || size > layout->capacity - header_size)
+    {
+        return 1;
+    }
+    *stream_size = header_size + size;
+    return 2;
+}
+
+// Function to get the image bytes from the stream start a layout reads one after another, k bits of every byte
+static long get_contiguous_size(const LsbLayout *layout)
+{
+    const LsbMode *mode = layout->mode;
+    long used = layout->row_groups * mode->group_pixels * mode->pixel_size;
+
+    // Some channels only -> bytes are skipped from the first pixel on
+    if(mode->bpp && mode->channels != (1 << mode->pixel_size) - 1)
+    {
+        return 0;
+    }
+    // Padding or pixels left over at the end of a row -> only the first row
+    return used == layout->row_size ? layout->file_size - layout->data_offset : used;
+}
+
+// Function to check two layouts read the same image bits for the whole stream, so either one decodes it
+static int is_same_layout(const LsbLayout *a, const LsbLayout *b, long stream_size)
+{
+    long needed = (stream_size * 8 + a->mode->bits - 1) / a->mode->bits;
+    long contiguous_a = get_contiguous_size(a), contiguous_b = get_contiguous_size(b);
+
+    return a->mode->bits == b->mode->bits && a->mode->msb_first == b->mode->msb_first &&
+           a->data_offset == b->data_offset && contiguous_a >= needed && contiguous_b >= needed;
+}
+
+// Function to find the stream layout of the image
+Status probe_stream_layout(DecodeInfo *decInfo)
+{
+    FILE *fptr_image = decInfo->fptr_enc_image;
+    const LsbMode *flat = find_lsb_mode(0, 0x1, 1, 0);
+    LsbLayout base, layout, plausible[LAYOUT_PROBE_MAX_PLAUSIBLE];
+    long stream_size, stream_sizes[LAYOUT_PROBE_MAX_PLAUSIBLE];
+    int tested = 0, found = 0, different = 0, default_magic = 0, default_plausible = 0;
+
+    // STEP1: Header fields, not a bmp -> default layout, the magic string check reports it
+    if(read_lsb_header(fptr_image, &base) == e_failure)
+    {
+        return e_success;
+    }
+
+    // STEP2: One read from byte 54 to the prefix size past the later start offset
+    long prefix_size = (base.pixel_offset > 54 ? base.pixel_offset : 54) + LAYOUT_PROBE_PREFIX_SIZE - 54;
+    prefix_size = prefix_size < base.file_size - 54 ? prefix_size : base.file_size - 54;
+    char *prefix = prefix_size > 0 ? get_pool_buffer(prefix_size) : NULL;
+    if(prefix == NULL || fseek(fptr_image, 54, SEEK_SET) != 0 ||
+       fread(prefix, 1, prefix_size, fptr_image) != (size_t)prefix_size)
+    {
+        put_pool_buffer(prefix);
+        return e_failure;
+    }
+
+    // STEP3: Score every candidate: the default layout, the pixel modes of the header's bpp, the other flat layouts
+    for(int pass = 0; pass < 3; pass++)
+    {
+        for(const LsbMode *mode = get_lsb_mode_table(); mode->name; mode++)
+        {
+            long offsets[2] = { mode->bpp ? base.pixel_offset : 54, base.pixel_offset };
+            int count = mode->bpp == 0 && base.pixel_offset != 54 ? 2 : 1;
+            int is_default = pass == 0;
+            if(is_default ? mode != flat : pass == 1 ? mode->bpp != base.bpp : mode->bpp != 0)
+            {
+                continue;
+            }
+            for(int i = 0; i < (is_default ? 1 : count); i++)
+            {
+                layout = base;
+                if((!is_default && mode == flat && offsets[i] == 54) || set_lsb_layout(&layout, mode, offsets[i]) == e_failure)
+                {
+                    continue;
+                }
+                tested++;
+                int result = check_layout_candidate(&layout, prefix, prefix_size, is_default, &stream_size);
+                default_magic |= is_default && result == 1;
+                default_plausible |= is_default && result == 2;
+                if(result != 2)
+                {
+                    continue;
+                }
+
+                // Plausible: the same as one found before (an earlier candidate is kept), or a different one
+                int same = 0;
+                for(int j = 0; j < found && !same; j++)
+                {
+                    same = is_same_layout(&plausible[j], &layout, stream_size > stream_sizes[j] ? stream_size : stream_sizes[j]);
+                }
+                if(!same && found < LAYOUT_PROBE_MAX_PLAUSIBLE)
+                {
+                    plausible[found] = layout;
+                    stream_sizes[found++] = stream_size;
+                }
+                different += !same;
+            }
+        }
+    }
+    put_pool_buffer(prefix);
+
+    // STEP4: Nothing plausible -> the default magic string, or no layout at all
+    if(found == 0)
+    {
+        if(!default_magic)
+        {
+            printf("INFO: None of the %d probed layouts has a stream header!\n\n", tested);
+            return e_failure;
+        }
+        plausible[0] = base;
+        set_lsb_layout(&plausible[0], flat, 54);
+    }
+
+    // STEP5: A plausible default layout always wins, it is what -e writes without options, the others are listed
+    if(default_plausible && different > 1)
+    {
+        printf("INFO: The stream header also fits");
+        for(int j = 1; j < found; j++)
+        {
+            printf(" %s from byte %ld%s", plausible[j].mode->name, plausible[j].data_offset, j + 1 < found ? "," : "");
+        }
+        printf(", decoding the default layout.\nINFO: Give --bits, --channels and --msb-first if the image was encoded with them!\n\n");
+    }
+    // More than one different plausible layout and none is the default -> the image does not tell which, ask for it
+    else if(different > 1)
+    {
+        printf("INFO: The stream header fits %d different layouts:", different);
+        for(int j = 0; j < found; j++)
+        {
+            printf(" %s from byte %ld%s", plausible[j].mode->name, plausible[j].data_offset, j + 1 < found ? "," : "");
+        }
+        printf(".\nINFO: Give the layout with --bits, --channels and --msb-first!\n\n");
+        return e_failure;
+    }
+    LsbLayout *winner = &plausible[0];
+    printf("INFO: Probed %d layouts, the stream uses the %s layout from byte %ld.\n\n", tested, winner->mode->name, winner->data_offset);
+
+    // STEP6: Other than the default -> decode through the mode kernels
+    if(winner->mode != flat || winner->data_offset != 54)
+    {
+        decInfo->lsb_bits = winner->mode->bits;
+        decInfo->lsb_channels = winner->mode->bpp ? winner->mode->channels : 0;
+        decInfo->lsb_msb_first = winner->mode->msb_first;
+        decInfo->lsb_offset = winner->data_offset;
+    }
+    return e_success;
+}
@@ -0,0 +1,48 @@
+#ifndef LAYOUT_PROBE_H
+#define LAYOUT_PROBE_H
+
+#include "types.h" // Contains user defined types
+#include "decode.h"
+#include "admission.h"
+
+/*
+ * Stream layout probe, used by decode when no layout flags are given
+ *
+ * Images from other encoders or other settings start the stream at
+ * byte 54 or at the pixel data offset of the header, take the bits LSB
+ * or MSB first and use 1, 2 or 4 bits per byte, of every byte (flat) or
+ * of some channels of every pixel. Instead of a full decode per guess,
+ * the probe reads one prefix of the image and extracts the first stream
+ * bytes of every candidate from it with the compiled mode kernels (see
+ * lsb_mode.h). A candidate is plausible when it has the magic string,
+ * an extension size of 1 to MAX_DECODE_EXTN_SIZE, a printable extension
+ * and a secret size within its capacity. Every candidate is scored:
+ *
+ * 1. default layout, flat 1 bit LSB first from byte 54 (also --fec carriers)
+ * 2. every mode kernel for the header's bpp, from the pixel data offset
+ * 3. every flat kernel from byte 54 and from the pixel data offset
+ *
+ * Plausible layouts that read the same image bits for the whole stream
+ * (24/bgr/k on rows without padding and flat k from the same byte) are
+ * one layout, the earlier candidate is reported. If the plausible ones
+ * still differ the image can not tell which it is: 24/bgr/k on rows with
+ * padding reads the same header as flat k and only differs after the
+ * first row. A plausible default layout then wins, so images -e wrote
+ * without options never need a flag, and the others are listed. Without
+ * a plausible default the probe fails and asks for --bits, --channels
+ * and --msb-first. A default magic
+ * string with a header that does not look right is taken if nothing is
+ * plausible, so the normal decode steps report what is wrong with it
+ */
+
+#define LAYOUT_PROBE_PREFIX_SIZE (64 * 1024)    // Bytes read past the later start offset
+#define LAYOUT_PROBE_HEADER_SIZE (2 + 4 + MAX_DECODE_EXTN_SIZE + 4)     // Longest stream header checked
+#define LAYOUT_PROBE_MAX_PLAUSIBLE 8    // Different plausible layouts listed
+
+
+/* Layout probe function prototype */
+
+/* Find the stream layout of the image, sets the lsb fields of decInfo unless it is the default one */
+Status probe_stream_layout(DecodeInfo *decInfo);
+
+#endif
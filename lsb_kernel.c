@@ -0,0 +1,297 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+// User-defined header files
+#include "lsb_kernel.h"
+#include "encode.h"
+#include "decode.h"
+#include "types.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define LSB_KERNEL_X86 1
+#include <immintrin.h>
+#endif
+
+/* Function Definitions */
+
+// Scalar kernel, the per byte reference functions in a loop
+static int scalar_supported(void)
+{
+    return 1;
+}
+
+static void scalar_embed(const char *data, long size, char *image_buffer)
+{
+    for(long i = 0; i < size; i++)
+    {
+        encode_byte_to_lsb(data[i], image_buffer + i * 8);
+    }
+}
+
+static void scalar_extract(char *data, long size, const char *image_buffer)
+{
+    for(long i = 0; i < size; i++)
+    {
+        decode_lsb_to_byte(data + i, (char *)image_buffer + i * 8);
+    }
+}
+
+#ifdef LSB_KERNEL_X86
+
+// SSE2 kernel, 2 data bytes per 16 image bytes
+static int sse2_supported(void)
+{
+    return __builtin_cpu_supports("sse2");
+}
+
+__attribute__((target("sse2")))
+static void sse2_embed(const char *data, long size, char *image_buffer)
+{
+    const __m128i bits = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+    const __m128i one = _mm_set1_epi8(1);
+    const __m128i keep = _mm_set1_epi8(~1);
+    long i = 0;
+
+    for(; i + 2 <= size; i += 2)
+    {
+        // Spread each data byte over 8 lanes, then test one bit per lane
+        __m128i d = _mm_cvtsi32_si128((unsigned char)data[i] | ((unsigned char)data[i + 1] << 8));
+        d = _mm_unpacklo_epi8(d, d);
+        d = _mm_unpacklo_epi16(d, d);
+        d = _mm_unpacklo_epi32(d, d);
+        __m128i set = _mm_and_si128(_mm_cmpeq_epi8(_mm_and_si128(d, bits), bits), one);
+
+        __m128i img = _mm_loadu_si128((const __m128i *)(image_buffer + i * 8));
+        img = _mm_or_si128(_mm_and_si128(img, keep), set);
+        _mm_storeu_si128((__m128i *)(image_buffer + i * 8), img);
+    }
+    scalar_embed(data + i, size - i, image_buffer + i * 8);
+}
+
+__attribute__((target("sse2")))
+static void sse2_extract(char *data, long size, const char *image_buffer)
+{
+    long i = 0;
+
+    for(; i + 2 <= size; i += 2)
+    {
+        // Move every LSB to the sign bit of its byte and collect the sign bits
+        __m128i img = _mm_loadu_si128((const __m128i *)(image_buffer + i * 8));
+        int mask = _mm_movemask_epi8(_mm_slli_epi64(img, 7));
+        data[i] = mask & 0xFF;
+        data[i + 1] = (mask >> 8) & 0xFF;
+    }
+    scalar_extract(data + i, size - i, image_buffer + i * 8);
+}
+
+// AVX2 kernel, 4 data bytes per 32 image bytes
+static int avx2_supported(void)
+{
+    return __builtin_cpu_supports("avx2");
+}
+
+__attribute__((target("avx2")))
+static void avx2_embed(const char *data, long size, char *image_buffer)
+{
+    const __m256i spread = _mm256_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1,
+                                            2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3);
+    const __m256i bits = _mm256_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128,
+                                          1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+    const __m256i one = _mm256_set1_epi8(1);
+    const __m256i keep = _mm256_set1_epi8(~1);
+    long i = 0;
+
+    for(; i + 4 <= size; i += 4)
+    {
+        uint32_t word;
+        memcpy(&word, data + i, 4);
+        __m256i d = _mm256_shuffle_epi8(_mm256_set1_epi32(word), spread);
+        __m256i set = _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_and_si256(d, bits), bits), one);
+
+        __m256i img = _mm256_loadu_si256((const __m256i *)(image_buffer + i * 8));
+        img = _mm256_or_si256(_mm256_and_si256(img, keep), set);
+        _mm256_storeu_si256((__m256i *)(image_buffer + i * 8), img);
+    }
+    sse2_embed(data + i, size - i, image_buffer + i * 8);
+}
+
+__attribute__((target("avx2")))
+static void avx2_extract(char *data, long size, const char *image_buffer)
+{
+    long i = 0;
+
+    for(; i + 4 <= size; i += 4)
+    {
+        __m256i img = _mm256_loadu_si256((const __m256i *)(image_buffer + i * 8));
+        uint32_t mask = _mm256_movemask_epi8(_mm256_slli_epi64(img, 7));
+        memcpy(data + i, &mask, 4);
+    }
+    sse2_extract(data + i, size - i, image_buffer + i * 8);
+}
+
+// AVX-512 kernel, 8 data bytes per 64 image bytes, the data bits are used directly as a byte mask
+static int avx512_supported(void)
+{
+    return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static void avx512_embed(const char *data, long size, char *image_buffer)
+{
+    const __m512i one = _mm512_set1_epi8(1);
+    const __m512i keep = _mm512_set1_epi8(~1);
+    long i = 0;
+
+    for(; i + 8 <= size; i += 8)
+    {
+        uint64_t word;
+        memcpy(&word, data + i, 8);
+        __m512i img = _mm512_and_si512(_mm512_loadu_si512(image_buffer + i * 8), keep);
+        img = _mm512_mask_blend_epi8((__mmask64)word, img, _mm512_or_si512(img, one));
+        _mm512_storeu_si512(image_buffer + i * 8, img);
+    }
+    avx2_embed(data + i, size - i, image_buffer + i * 8);
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static void avx512_extract(char *data, long size, const char *image_buffer)
+{
+    const __m512i one = _mm512_set1_epi8(1);
+    long i = 0;
+
+    for(; i + 8 <= size; i += 8)
+    {
+        uint64_t mask = _mm512_test_epi8_mask(_mm512_loadu_si512(image_buffer + i * 8), one);
+        memcpy(data + i, &mask, 8);
+    }
+    avx2_extract(data + i, size - i, image_buffer + i * 8);
+}
+
+// BMI2 kernel, one data byte per 8 image bytes with PDEP/PEXT
+static int bmi2_supported(void)
+{
+    return __builtin_cpu_supports("bmi2");
+}
+
+__attribute__((target("bmi2")))
+static void bmi2_embed(const char *data, long size, char *image_buffer)
+{
+    const uint64_t lsb = 0x0101010101010101ULL;
+
+    for(long i = 0; i < size; i++)
+    {
+        uint64_t img;
+        memcpy(&img, image_buffer + i * 8, 8);
+        img = (img & ~lsb) | _pdep_u64((unsigned char)data[i], lsb);
+        memcpy(image_buffer + i * 8, &img, 8);
+    }
+}
+
+__attribute__((target("bmi2")))
+static void bmi2_extract(char *data, long size, const char *image_buffer)
+{
+    const uint64_t lsb = 0x0101010101010101ULL;
+
+    for(long i = 0; i < size; i++)
+    {
+        uint64_t img;
+        memcpy(&img, image_buffer + i * 8, 8);
+        data[i] = (char)_pext_u64(img, lsb);
+    }
+}
+
+#endif
+
+// All kernels compiled in, in order of preference
+static const LsbKernel lsb_kernels[] =
+{
+#ifdef LSB_KERNEL_X86
+    {"avx512", avx512_supported, avx512_embed, avx512_extract},
+    {"avx2", avx2_supported, avx2_embed, avx2_extract},
+    {"sse2", sse2_supported, sse2_embed, sse2_extract},
+    {"bmi2", bmi2_supported, bmi2_embed, bmi2_extract},
+#endif
+    {"scalar", scalar_supported, scalar_embed, scalar_extract},
+    {NULL, NULL, NULL, NULL}
+};
+
+// Selected kernel, NULL until the first selection
+static const LsbKernel *lsb_kernel_selected;
+
+// Function to select a kernel by name, or LSB_KERNEL env, or the best one for this CPU
+Status select_lsb_kernel(const char *name)
+{
+#ifdef LSB_KERNEL_X86
+    __builtin_cpu_init();
+#endif
+    // STEP1: No name given -> take it from the environment, if set
+    if(name == NULL)
+    {
+        name = getenv(LSB_KERNEL_ENV);
+    }
+
+    // STEP2: Pick the named kernel, or the first supported one in order of preference
+    for(const LsbKernel *kernel = lsb_kernels; kernel->name; kernel++)
+    {
+        if((name == NULL || strcmp(name, kernel->name) == 0) && kernel->supported())
+        {
+            lsb_kernel_selected = kernel;
+            return e_success;
+        }
+    }
+
+    // STEP3: Unknown or unsupported name -> fall back to the best one and report failure
+    printf("INFO: LSB kernel '%s' is not available on this CPU!\n\n", name);
+    for(const LsbKernel *kernel = lsb_kernels; kernel->name; kernel++)
+    {
+        if(kernel->supported())
+        {
+            lsb_kernel_selected = kernel;
+            break;
+        }
+    }
+    return e_failure;
+}
+
+// Function to get the selected kernel
+const LsbKernel *get_lsb_kernel(void)
+{
+    if(lsb_kernel_selected == NULL)
+    {
+        select_lsb_kernel(NULL);
+    }
+    return lsb_kernel_selected;
+}
+
+// Function to get the table of all kernels compiled in
+const LsbKernel *get_lsb_kernel_table(void)
+{
+    return lsb_kernels;
+}
+
+// Function to print the selected kernel and the ones this CPU supports
+void print_lsb_kernel_report(void)
+{
+    printf("INFO: Using '%s' LSB kernel (supported:", get_lsb_kernel()->name);
+    for(const LsbKernel *kernel = lsb_kernels; kernel->name; kernel++)
+    {
+        if(kernel->supported())
+        {
+            printf(" %s", kernel->name);
+        }
+    }
+    printf(").\n\n");
+}
+
+// Function to encode a block of data with the selected kernel
+void encode_bytes_to_lsb(const char *data, long size, char *image_buffer)
+{
+    get_lsb_kernel()->embed(data, size, image_buffer);
+}
+
+// Function to decode a block of data with the selected kernel
+void decode_lsb_to_bytes(char *data, long size, const char *image_buffer)
+{
+    get_lsb_kernel()->extract(data, size, image_buffer);
+}
@@ -0,0 +1,50 @@
+#ifndef LSB_KERNEL_H
+#define LSB_KERNEL_H
+
+#include "types.h" // Contains user defined types
+
+/*
+ * Block kernels that encode/decode many bytes at once, same layout as
+ * encode_byte_to_lsb()/decode_lsb_to_byte(): byte i of data uses
+ * image_buffer[i * 8 .. i * 8 + 7], bit n in the LSB of byte n
+ *
+ * One ISA variant is selected once (first use or select_lsb_kernel())
+ * Override with --kernel <name> or the LSB_KERNEL environment variable
+ */
+
+/* Name of the environment variable that forces a kernel */
+#define LSB_KERNEL_ENV "LSB_KERNEL"
+
+typedef void (*LsbEmbedFn)(const char *data, long size, char *image_buffer);
+typedef void (*LsbExtractFn)(char *data, long size, const char *image_buffer);
+
+typedef struct _LsbKernel
+{
+    const char *name;           // Variant name (scalar, sse2, avx2, avx512, bmi2)
+    int (*supported)(void);     // Returns 1 if this CPU can run the variant
+    LsbEmbedFn embed;           // Encode size bytes into size * 8 image bytes
+    LsbExtractFn extract;       // Decode size bytes from size * 8 image bytes
+} LsbKernel;
+
+
+/* LSB kernel function prototype */
+
+/* Select a kernel by name, NULL picks LSB_KERNEL env or the best supported one */
+Status select_lsb_kernel(const char *name);
+
+/* Get the selected kernel (selects the default one on first use) */
+const LsbKernel *get_lsb_kernel(void);
+
+/* Get the table of all kernels compiled in, terminated by a NULL name */
+const LsbKernel *get_lsb_kernel_table(void);
+
+/* Print the selected kernel and all kernels supported by this CPU */
+void print_lsb_kernel_report(void);
+
+/* Encode a block of data into the LSB of image data array with the selected kernel */
+void encode_bytes_to_lsb(const char *data, long size, char *image_buffer);
+
+/* Decode a block of data from the LSB of image data array with the selected kernel */
+void decode_lsb_to_bytes(char *data, long size, const char *image_buffer);
+
+#endif
@@ -0,0 +1,645 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+// User-defined header files
+#include "lsb_mode.h"
+#include "encode.h"
+#include "decode.h"
+#include "admission.h"
+#include "progress.h"
+#include "pool.h"
+#include "probes.h"
+#include "types.h"
+#include "common.h"
+
+/* Function Definitions */
+
+// Channels in a mask, and the pixels and stream bytes of one group
+#define LSB_POPCOUNT(mask) (((mask) & 1) + (((mask) >> 1) & 1) + (((mask) >> 2) & 1) + (((mask) >> 3) & 1))
+#define LSB_GROUP_PIXELS(mask, bits) ((LSB_POPCOUNT(mask) * (bits)) % 8 == 0 ? 1 : \
+                                      (LSB_POPCOUNT(mask) * (bits)) % 4 == 0 ? 2 : \
+                                      (LSB_POPCOUNT(mask) * (bits)) % 2 == 0 ? 4 : 8)
+#define LSB_GROUP_BYTES(mask, bits) (LSB_POPCOUNT(mask) * (bits) * LSB_GROUP_PIXELS(mask, bits) / 8)
+
+/*
+ * Generic group loops, only ever called with constant pixel_size,
+ * channels, bits and order: once inlined into a generated kernel the
+ * channel tests and loops fold away and only the shifts and masks are left
+ */
+static inline __attribute__((always_inline))
+void embed_mode_groups(const char *data, long groups, char *pixels, const int pixel_size, const int channels, const int bits, const int msb_first)
+{
+    const int group_pixels = LSB_GROUP_PIXELS(channels, bits);
+    const int group_bytes = LSB_GROUP_BYTES(channels, bits);
+    const unsigned char low = (1 << bits) - 1;
+    unsigned char *pixel = (unsigned char *)pixels;
+
+    for(long g = 0; g < groups; g++, data += group_bytes)
+    {
+        // A group is at most 32 stream bits, LSB first from the bottom of the word or MSB first from the top
+        uint32_t word = 0;
+        #pragma GCC unroll 4
+        for(int b = 0; b < group_bytes; b++)
+        {
+            word |= (uint32_t)(unsigned char)data[b] << (msb_first ? 24 - 8 * b : 8 * b);
+        }
+        #pragma GCC unroll 8
+        for(int p = 0; p < group_pixels; p++, pixel += pixel_size)
+        {
+            #pragma GCC unroll 4
+            for(int c = 0; c < pixel_size; c++)
+            {
+                if(channels & (1 << c))
+                {
+                    unsigned char slot = msb_first ? word >> (32 - bits) : word & low;
+                    pixel[c] = (pixel[c] & ~low) | slot;
+                    word = msb_first ? word << bits : word >> bits;
+                }
+            }
+        }
+    }
+}
+
+static inline __attribute__((always_inline))
+void extract_mode_groups(char *data, long groups, const char *pixels, const int pixel_size, const int channels, const int bits, const int msb_first)
+{
+    const int group_pixels = LSB_GROUP_PIXELS(channels, bits);
+    const int group_bytes = LSB_GROUP_BYTES(channels, bits);
+    const unsigned char low = (1 << bits) - 1;
+    const unsigned char *pixel = (const unsigned char *)pixels;
+
+    for(long g = 0; g < groups; g++, data += group_bytes)
+    {
+        uint32_t word = 0;
+        int shift = 0;
+        #pragma GCC unroll 8
+        for(int p = 0; p < group_pixels; p++, pixel += pixel_size)
+        {
+            #pragma GCC unroll 4
+            for(int c = 0; c < pixel_size; c++)
+            {
+                if(channels & (1 << c))
+                {
+                    word |= (uint32_t)(pixel[c] & low) << (msb_first ? 32 - bits - shift : shift);
+                    shift += bits;
+                }
+            }
+        }
+        #pragma GCC unroll 4
+        for(int b = 0; b < group_bytes; b++)
+        {
+            data[b] = (word >> (msb_first ? 24 - 8 * b : 8 * b)) & 0xFF;
+        }
+    }
+}
+
+/* Every supported layout: X(bpp, channel names, mask, bits, order name, msb_first, name prefix) */
+#define LSB_MODE_ORDERS(X, bpp, names, mask, bits, prefix) \
+    X(bpp, names, mask, bits, lsb, 0, prefix) X(bpp, names, mask, bits, msb, 1, prefix)
+#define LSB_MODE_BITS(X, bpp, names, mask, prefix) \
+    LSB_MODE_ORDERS(X, bpp, names, mask, 1, prefix) \
+    LSB_MODE_ORDERS(X, bpp, names, mask, 2, prefix) \
+    LSB_MODE_ORDERS(X, bpp, names, mask, 4, prefix)
+#define LSB_MODE_LIST(X) \
+    LSB_MODE_BITS(X, 0, flat, 0x1, "flat") \
+    LSB_MODE_BITS(X, 24, bgr, 0x7, "24/bgr") \
+    LSB_MODE_BITS(X, 24, b, 0x1, "24/b") \
+    LSB_MODE_BITS(X, 32, bgr, 0x7, "32/bgr") \
+    LSB_MODE_BITS(X, 32, bgra, 0xF, "32/bgra") \
+    LSB_MODE_BITS(X, 32, b, 0x1, "32/b")
+
+// Flat modes have one byte "pixels" with one channel
+#define LSB_PIXEL_SIZE(bpp) ((bpp) ? (bpp) / 8 : 1)
+
+// One embed/extract pair per entry
+#define LSB_MODE_KERNELS(bpp, names, mask, bits, order, msb_first, prefix) \
+    static void embed_##bpp##_##names##_##bits##_##order(const char *data, long groups, char *pixels) \
+    { \
+        embed_mode_groups(data, groups, pixels, LSB_PIXEL_SIZE(bpp), mask, bits, msb_first); \
+    } \
+    static void extract_##bpp##_##names##_##bits##_##order(char *data, long groups, const char *pixels) \
+    { \
+        extract_mode_groups(data, groups, pixels, LSB_PIXEL_SIZE(bpp), mask, bits, msb_first); \
+    }
+
+#define LSB_MODE_ENTRY(bpp, names, mask, bits, order, msb_first, prefix) \
+    {prefix "/" #bits "/" #order, bpp, LSB_PIXEL_SIZE(bpp), mask, bits, msb_first, \
+     LSB_GROUP_PIXELS(mask, bits), LSB_GROUP_BYTES(mask, bits), \
+     embed_##bpp##_##names##_##bits##_##order, extract_##bpp##_##names##_##bits##_##order},
+
+LSB_MODE_LIST(LSB_MODE_KERNELS)
+
+// Dispatch table, searched once per job
+static const LsbMode lsb_modes[] =
+{
+    LSB_MODE_LIST(LSB_MODE_ENTRY)
+    {NULL, 0, 0, 0, 0, 0, 0, 0, NULL, NULL}
+};
+
+// Function to read --bits k
+Status parse_lsb_bits(const char *arg, int *bits)
+{
+    if(arg == NULL || (strcmp(arg, "1") && strcmp(arg, "2") && strcmp(arg, "4")))
+    {
+        printf("INFO: --bits must be 1, 2 or 4!\n\n");
+        return e_failure;
+    }
+    *bits = atoi(arg);
+    return e_success;
+}
+
+// Function to read --channels list into a channel mask, every channel at most once
+Status parse_lsb_channels(const char *arg, int *channels)
+{
+    const char *names = "bgra";
+
+    *channels = 0;
+    for(const char *ptr = arg; ptr && *ptr; ptr++)
+    {
+        const char *name = strchr(names, *ptr);
+        if(name == NULL || (*channels & (1 << (name - names))))
+        {
+            *channels = 0;
+            break;
+        }
+        *channels |= 1 << (name - names);
+    }
+    if(*channels == 0)
+    {
+        printf("INFO: --channels takes the letters b, g, r and a!\n\n");
+        return e_failure;
+    }
+    return e_success;
+}
+
+// Function to get the kernel for bpp, channel mask, bits and order
+const LsbMode *find_lsb_mode(int bpp, int channels, int bits, int msb_first)
+{
+    for(const LsbMode *mode = lsb_modes; mode->name; mode++)
+    {
+        if(mode->bpp == bpp && mode->channels == channels && mode->bits == bits && mode->msb_first == msb_first)
+        {
+            return mode;
+        }
+    }
+    return NULL;
+}
+
+// Function to get the table of all mode kernels
+const LsbMode *get_lsb_mode_table(void)
+{
+    return lsb_modes;
+}
+
+// Function to take stream bit s of groups from its channel byte one bit at a time, independent of the mode kernels
+void extract_lsb_mode_reference(const LsbMode *mode, char *data, long groups, const char *pixels)
+{
+    int channels = __builtin_popcount(mode->channels);
+    long size = groups * mode->group_bytes;
+
+    memset(data, 0, size);
+    for(long s = 0; s < size * 8; s++)
+    {
+        long slot = s / mode->bits;
+        int nth = slot % channels, c = 0;
+        while(nth > 0 || !(mode->channels & (1 << c)))
+        {
+            nth -= (mode->channels >> c) & 1;
+            c++;
+        }
+        unsigned char byte = pixels[(slot / channels) * mode->pixel_size + c];
+        // MSB first: the high bit of a slot is the earlier stream bit, and stream bit 7 of a byte comes first
+        int bit = mode->msb_first ? mode->bits - 1 - s % mode->bits : s % mode->bits;
+        data[s / 8] |= ((byte >> bit) & 1) << (mode->msb_first ? 7 - s % 8 : s % 8);
+    }
+}
+
+// Function to get a little endian value of size bytes
+static long get_header_value(const unsigned char *ptr, int size)
+{
+    unsigned long value = 0;
+    for(int i = size - 1; i >= 0; i--)
+    {
+        value = value << 8 | ptr[i];
+    }
+    return value;
+}
+
+// Function to read the header fields of fptr_image into the layout
+Status read_lsb_header(FILE *fptr_image, LsbLayout *layout)
+{
+    unsigned char header[54];
+
+    memset(layout, 0, sizeof(LsbLayout));
+    rewind(fptr_image);
+    if(fread(header, 1, sizeof(header), fptr_image) != sizeof(header) || header[0] != 'B' || header[1] != 'M')
+    {
+        return e_failure;
+    }
+    layout->bpp = get_header_value(header + 28, 2);
+    layout->compression = get_header_value(header + 30, 4);
+    layout->pixel_offset = get_header_value(header + 10, 4);
+    layout->width = (int32_t)get_header_value(header + 18, 4);
+    layout->height = (int32_t)get_header_value(header + 22, 4);
+    if(layout->height < 0)
+    {
+        // Top-down image, same rows in the other order
+        layout->height = -layout->height;
+    }
+    fseek(fptr_image, 0, SEEK_END);
+    layout->file_size = ftell(fptr_image);
+    return e_success;
+}
+
+// Function to set up the geometry of a layout with header fields for mode, from offset (0 for the pixel data offset)
+Status set_lsb_layout(LsbLayout *layout, const LsbMode *mode, long offset)
+{
+    layout->mode = mode;
+    layout->data_offset = offset ? offset : layout->pixel_offset;
+    if(layout->data_offset < 54 || layout->data_offset >= layout->file_size)
+    {
+        return e_failure;
+    }
+
+    // STEP1: Flat -> every byte to the end of the file, in rows of LSB_FLAT_ROW_SIZE
+    if(mode->bpp == 0)
+    {
+        long available = layout->file_size - layout->data_offset;
+        layout->width = layout->row_size = LSB_FLAT_ROW_SIZE;
+        layout->height = (available + LSB_FLAT_ROW_SIZE - 1) / LSB_FLAT_ROW_SIZE;
+        layout->last_row_size = available - (layout->height - 1) * LSB_FLAT_ROW_SIZE;
+    }
+    // STEP2: Pixels -> only uncompressed ones of the header's bpp (bit fields keep the byte order for 32 bpp), the rows must be in the file
+    else
+    {
+        layout->row_size = (layout->width * mode->bpp + 31) / 32 * 4;
+        layout->last_row_size = layout->row_size;
+        if(mode->bpp != layout->bpp || !(layout->compression == 0 || (layout->compression == 3 && mode->bpp == 32)) ||
+           layout->width <= 0 || layout->height <= 0 ||
+           layout->data_offset + layout->row_size * layout->height > layout->file_size)
+        {
+            return e_failure;
+        }
+    }
+
+    // STEP3: Whole groups per row, the pixels left over are not used (only a flat last row is shorter, pixel rows stop before the padding)
+    layout->row_groups = layout->width / mode->group_pixels;
+    layout->row_bytes = layout->row_groups * mode->group_bytes;
+    layout->last_row_groups = mode->bpp == 0 ? layout->last_row_size / mode->pixel_size / mode->group_pixels : layout->row_groups;
+    layout->capacity = layout->row_bytes * (layout->height - 1) + layout->last_row_groups * mode->group_bytes;
+    return layout->row_bytes > 0 ? e_success : e_failure;
+}
+
+// Function to read the bmp header and set up the layout for channels (0 for flat), bits and order
+Status read_lsb_layout(FILE *fptr_image, int bits, int channels, int msb_first, long offset, LsbLayout *layout)
+{
+    // STEP1: Header fields
+    if(read_lsb_header(fptr_image, layout) == e_failure)
+    {
+        printf("INFO: The image has no bmp header!\n\n");
+        return e_failure;
+    }
+
+    // STEP2: Kernel for this bpp
+    const LsbMode *mode = channels ? find_lsb_mode(layout->bpp, channels, bits, msb_first) : find_lsb_mode(0, 0x1, bits, msb_first);
+    if(mode == NULL)
+    {
+        printf("INFO: No LSB kernel for %d bpp images with these channels and %d bits!\n\n", layout->bpp, bits);
+        return e_failure;
+    }
+
+    // STEP3: Geometry
+    if(set_lsb_layout(layout, mode, offset) == e_failure)
+    {
+        printf("INFO: The %s layout does not fit this image (compression, size or row width)!\n\n", mode->name);
+        return e_failure;
+    }
+    fseek(fptr_image, layout->data_offset, SEEK_SET);
+    return e_success;
+}
+
+// Function to get the bytes of row r
+static long get_row_size(const LsbLayout *layout, long r)
+{
+    return r == layout->height - 1 ? layout->last_row_size : layout->row_size;
+}
+
+// Function to get the groups of row r
+static long get_row_groups(const LsbLayout *layout, long r)
+{
+    return r == layout->height - 1 ? layout->last_row_groups : layout->row_groups;
+}
+
+// Function to extract the first size stream bytes of a layout from the image bytes in prefix
+Status extract_layout_prefix(const LsbLayout *layout, const char *prefix, long prefix_offset, long prefix_size, char *data, long size)
+{
+    const LsbMode *mode = layout->mode;
+    char bytes[64 * 4];
+
+    for(long r = 0; size > 0; r++)
+    {
+        // STEP1: Only the groups still needed, they must be in the prefix
+        long start = layout->data_offset + r * layout->row_size - prefix_offset;
+        long groups = (size + mode->group_bytes - 1) / mode->group_bytes;
+        groups = groups < get_row_groups(layout, r) ? groups : get_row_groups(layout, r);
+        if(r == layout->height || start < 0 || start + groups * mode->group_pixels * mode->pixel_size > prefix_size)
+        {
+            return e_failure;
+        }
+
+        // STEP2: A few groups at a time, the last one may hold more bytes than needed
+        for(long g = 0; g < groups && size > 0; g += 64)
+        {
+            long count = groups - g < 64 ? groups - g : 64;
+            mode->extract(bytes, count, prefix + start + g * mode->group_pixels * mode->pixel_size);
+            count = count * mode->group_bytes < size ? count * mode->group_bytes : size;
+            memcpy(data, bytes, count);
+            data += count;
+            size -= count;
+        }
+    }
+    return e_success;
+}
+
+// Function to get the row buffers from the pool
+static Status get_layout_buffers(LsbLayout *layout)
+{
+    layout->row = get_pool_buffer(layout->row_size);
+    layout->bytes = get_pool_buffer(layout->row_bytes);
+    layout->check = get_pool_buffer(layout->row_bytes);
+    return layout->row && layout->bytes && layout->check ? e_success : e_failure;
+}
+
+// Function to give the row buffers back
+static void put_layout_buffers(LsbLayout *layout)
+{
+    put_pool_buffer(layout->row);
+    put_pool_buffer(layout->bytes);
+    put_pool_buffer(layout->check);
+    layout->row = layout->bytes = layout->check = NULL;
+}
+
+// Function to embed the filled bytes into the next row and write it, a partial last group is zero padded
+static Status flush_layout_row(LsbLayout *layout, EncodeInfo *encInfo)
+{
+    const LsbMode *mode = layout->mode;
+    long groups = (layout->used + mode->group_bytes - 1) / mode->group_bytes;
+    long row_size = get_row_size(layout, layout->rows_done);
+
+    if(layout->rows_done == layout->height ||
+       fread(layout->row, 1, row_size, encInfo->fptr_src_image) != (size_t)row_size)
+    {
+        return e_failure;
+    }
+    memset(layout->bytes + layout->used, 0, groups * mode->group_bytes - layout->used);
+    // Every row before this one holds row_bytes stream bytes
+    long offset = layout->rows_done * layout->row_bytes;
+    PROBE3(embed__enter, progress.job_id, offset, layout->used);
+    mode->embed(layout->bytes, groups, layout->row);
+    PROBE3(embed__leave, progress.job_id, offset, layout->used);
+
+    // With --verify, extract the row again bit by bit before it is written, not with the mode's own extract kernel
+    if(encInfo->verify)
+    {
+        PROBE3(extract__enter, progress.job_id, offset, layout->used);
+        extract_lsb_mode_reference(mode, layout->check, groups, layout->row);
+        PROBE3(extract__leave, progress.job_id, offset, layout->used);
+        if(memcmp(layout->check, layout->bytes, layout->used) != 0)
+        {
+            printf("INFO: Verification failed in row %ld!\n\n", layout->rows_done);
+            return e_failure;
+        }
+        encInfo->verified_size += layout->used;
+    }
+    if(fwrite(layout->row, 1, row_size, encInfo->fptr_stego_image) != (size_t)row_size)
+    {
+        return e_failure;
+    }
+    layout->used = 0;
+    layout->rows_done++;
+    return e_success;
+}
+
+// Function to add stream bytes to the layout, writing every row that fills up
+static Status put_layout_bytes(LsbLayout *layout, const char *data, long size, EncodeInfo *encInfo)
+{
+    while(size > 0)
+    {
+        long row_bytes = get_row_groups(layout, layout->rows_done) * layout->mode->group_bytes;
+        long count = row_bytes - layout->used < size ? row_bytes - layout->used : size;
+        memcpy(layout->bytes + layout->used, data, count);
+        layout->used += count;
+        data += count;
+        size -= count;
+        if(layout->used == row_bytes && flush_layout_row(layout, encInfo) == e_failure)
+        {
+            return e_failure;
+        }
+    }
+    return e_success;
+}
+
+// Function to take stream bytes from the layout, reading and extracting rows as needed
+static Status get_layout_bytes(LsbLayout *layout, char *data, long size, FILE *fptr_image)
+{
+    while(size > 0)
+    {
+        if(layout->used == layout->filled)
+        {
+            long row_size = get_row_size(layout, layout->rows_done);
+            long row_groups = get_row_groups(layout, layout->rows_done);
+            if(layout->rows_done == layout->height ||
+               fread(layout->row, 1, row_size, fptr_image) != (size_t)row_size)
+            {
+                return e_failure;
+            }
+            layout->filled = row_groups * layout->mode->group_bytes;
+            PROBE3(extract__enter, progress.job_id, layout->rows_done * layout->row_bytes, layout->filled);
+            layout->mode->extract(layout->bytes, row_groups, layout->row);
+            PROBE3(extract__leave, progress.job_id, layout->rows_done * layout->row_bytes, layout->filled);
+            layout->used = 0;
+            layout->rows_done++;
+        }
+        long count = layout->filled - layout->used < size ? layout->filled - layout->used : size;
+        memcpy(data, layout->bytes + layout->used, count);
+        layout->used += count;
+        data += count;
+        size -= count;
+    }
+    return e_success;
+}
+
+// Function to copy the bytes before the pixel data
+static Status copy_image_prefix(FILE *fptr_src_image, FILE *fptr_stego_image, long size)
+{
+    char arr[MAX_BLOCK_SIZE];
+
+    rewind(fptr_src_image);
+    while(size > 0)
+    {
+        long block = size < MAX_BLOCK_SIZE ? size : MAX_BLOCK_SIZE;
+        if(fread(arr, 1, block, fptr_src_image) != (size_t)block || fwrite(arr, 1, block, fptr_stego_image) != (size_t)block)
+        {
+            return e_failure;
+        }
+        size -= block;
+    }
+    return e_success;
+}
+
+// Function to encode the header bytes, the stream and the rows it touches
+Status encode_mode_stream(EncodeInfo *encInfo)
+{
+    char header[64];
+    char secret_data[MAX_BLOCK_SIZE];
+    LsbLayout layout;
+    Status ret = e_success;
+
+    // STEP1: Layout from the header, row buffers from the pool
+    if(read_lsb_layout(encInfo->fptr_src_image, encInfo->lsb_bits, encInfo->lsb_channels, encInfo->lsb_msb_first, 0, &layout) == e_failure ||
+       get_layout_buffers(&layout) == e_failure)
+    {
+        put_layout_buffers(&layout);
+        return e_failure;
+    }
+    printf("INFO: Embedding with the %s kernel, %ld stream bytes per row.\n\n", layout.mode->name, layout.row_bytes);
+
+    // STEP2: Everything up to the pixel data as it is
+    long header_size = build_stream_header(header, encInfo->extn_secret_file, encInfo->size_secret_file);
+    start_progress_stage("data", header_size + encInfo->size_secret_file);
+    if(copy_image_prefix(encInfo->fptr_src_image, encInfo->fptr_stego_image, layout.data_offset) == e_failure ||
+       put_layout_bytes(&layout, header, header_size, encInfo) == e_failure)
+    {
+        ret = e_failure;
+    }
+
+    // STEP3: Secret data block by block
+    for(long done = 0; ret == e_success && done < encInfo->size_secret_file; )
+    {
+        long block = encInfo->size_secret_file - done < MAX_BLOCK_SIZE ? encInfo->size_secret_file - done : MAX_BLOCK_SIZE;
+        if(fread(secret_data, 1, block, encInfo->fptr_secret) != (size_t)block ||
+           put_layout_bytes(&layout, secret_data, block, encInfo) == e_failure)
+        {
+            ret = e_failure;
+            break;
+        }
+        done += block;
+        if(report_progress(header_size + done) == e_failure)
+        {
+            printf("INFO: Cancelled at secret byte %ld!\n\n", done);
+            ret = e_failure;
+        }
+    }
+
+    // STEP4: Last row with the tail of the stream, copy_remaining_img_data() takes the rows after it
+    if(ret == e_success && layout.used > 0)
+    {
+        ret = flush_layout_row(&layout, encInfo);
+    }
+    put_layout_buffers(&layout);
+    return ret;
+}
+
+// Function to get a 32 bit stream value through the layout
+static Status get_layout_uint(LsbLayout *layout, long *value, FILE *fptr_image)
+{
+    unsigned char bytes[4];
+    if(get_layout_bytes(layout, (char *)bytes, 4, fptr_image) == e_failure)
+    {
+        return e_failure;
+    }
+    *value = get_header_value(bytes, 4);
+    return e_success;
+}
+
+// Function to check the magic string and decode the header fields through the layout
+Status decode_mode_stream(DecodeInfo *decInfo)
+{
+    char magic[sizeof(MAGIC_STRING)];
+    long magic_size = strlen(MAGIC_STRING);
+
+    // STEP1: Layout lives in the job arena, it is read again by write_mode_data()
+    LsbLayout *layout = decInfo->lsb_layout = arena_alloc(sizeof(LsbLayout));
+    if(layout == NULL ||
+       read_lsb_layout(decInfo->fptr_enc_image, decInfo->lsb_bits, decInfo->lsb_channels, decInfo->lsb_msb_first,
+                       decInfo->lsb_offset, layout) == e_failure ||
+       get_layout_buffers(layout) == e_failure)
+    {
+        return e_failure;
+    }
+
+    // STEP2: Magic string
+    if(get_layout_bytes(layout, magic, magic_size, decInfo->fptr_enc_image) == e_failure ||
+       memcmp(magic, MAGIC_STRING, magic_size) != 0)
+    {
+        printf("INFO: The magic string does not match the %s layout!\n\n", layout->mode->name);
+        return e_failure;
+    }
+    printf("INFO: The magic string has successfully matched (%s kernel).\n\n", layout->mode->name);
+
+    // STEP3: Extension size and extension, untrusted, checked against the layout capacity
+    if(get_layout_uint(layout, &decInfo->extn_file_size, decInfo->fptr_enc_image) == e_failure ||
+       decInfo->extn_file_size <= 0 || decInfo->extn_file_size > MAX_DECODE_EXTN_SIZE ||
+       magic_size + 8 + decInfo->extn_file_size > layout->capacity)
+    {
+        printf("INFO: The extension size %ld is corrupted!\n\n", decInfo->extn_file_size);
+        return e_failure;
+    }
+    if(admit_allocation(decInfo->extn_file_size + 1) == e_failure)
+    {
+        return e_failure;
+    }
+    decInfo->extn_secret_file = arena_alloc(decInfo->extn_file_size + 1);
+    if(decInfo->extn_secret_file == NULL ||
+       get_layout_bytes(layout, decInfo->extn_secret_file, decInfo->extn_file_size, decInfo->fptr_enc_image) == e_failure)
+    {
+        return e_failure;
+    }
+    decInfo->extn_secret_file[decInfo->extn_file_size] = '\0';
+    if(add_secret_file_extn(decInfo) == e_failure)
+    {
+        return e_failure;
+    }
+
+    // STEP4: Secret size, the data must fit the layout and the byte budget
+    if(get_layout_uint(layout, &decInfo->size_secret_file, decInfo->fptr_enc_image) == e_failure)
+    {
+        return e_failure;
+    }
+    if(decInfo->size_secret_file > layout->capacity - (magic_size + 8 + decInfo->extn_file_size))
+    {
+        printf("INFO: The secret size %ld does not fit the image!\n\n", decInfo->size_secret_file);
+        return e_failure;
+    }
+    return admit_output_bytes(decInfo->size_secret_file);
+}
+
+// Function to write the secret data through the layout
+Status write_mode_data(DecodeInfo *decInfo)
+{
+    char secret_data[MAX_BLOCK_SIZE];
+    LsbLayout *layout = decInfo->lsb_layout;
+    Status ret = e_success;
+
+    start_progress_stage("data", decInfo->size_secret_file);
+    for(long done = 0; done < decInfo->size_secret_file; )
+    {
+        long block = decInfo->size_secret_file - done < MAX_BLOCK_SIZE ? decInfo->size_secret_file - done : MAX_BLOCK_SIZE;
+        if(get_layout_bytes(layout, secret_data, block, decInfo->fptr_enc_image) == e_failure ||
+           fwrite(secret_data, 1, block, decInfo->fptr_secret) != (size_t)block)
+        {
+            ret = e_failure;
+            break;
+        }
+        done += block;
+        if(report_progress(done) == e_failure)
+        {
+            printf("INFO: Cancelled at secret byte %ld!\n\n", done);
+            ret = e_failure;
+            break;
+        }
+    }
+    put_layout_buffers(layout);
+    return ret;
+}
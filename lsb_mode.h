@@ -0,0 +1,128 @@
+#ifndef LSB_MODE_H
+#define LSB_MODE_H
+
+#include <stdio.h>
+#include "types.h" // Contains user defined types
+#include "encode.h"
+#include "decode.h"
+
+/*
+ * Pixel aware embedding modes (--bits k, --channels list, --msb-first)
+ *
+ * Instead of one bit in every byte after the 54 byte header, the stream
+ * goes into the k low bits of the selected channels of every pixel,
+ * starting at the pixel data offset of the header, row by row, never in
+ * the row padding. Channels are named b, g, r, a (byte 0 to 3 of a pixel),
+ * default bgr; k is 1, 2 or 4, default 1.
+ *
+ * A pixel carries channels * k stream bits, so group_pixels pixels carry
+ * a whole number of stream bytes (group_bytes), LSB first. A row holds
+ * width / group_pixels groups, the pixels left over at the end of a row
+ * are not used. The stream is the same as the default layout: magic
+ * string | extension size | extension | secret size | data.
+ *
+ * With --msb-first the stream bits are taken most significant first and
+ * the first bit of a k bit slot is its high bit, as some other tools do.
+ *
+ * The flat modes use every byte from some offset, padding included, k
+ * bits each. They are not selected by flags: the decoder probe (see
+ * layout_probe.h) picks them for images from other encoders. Flat with
+ * k = 1, LSB first, from byte 54 is the default layout.
+ *
+ * One embed/extract kernel pair is generated at compile time for every
+ * supported bpp, channel mask, k and bit order, so the pixel size, the
+ * channel tests and the bit masks are constants and the inner loop has
+ * no branches. The job picks its kernel from the table once, from the
+ * bpp in the header
+ */
+
+#define LSB_MODE_DEFAULT_CHANNELS 0x7   // b, g and r
+#define LSB_FLAT_ROW_SIZE 4096          // Flat layouts are read in rows of this many bytes, the last one shorter
+
+/* Embed groups * group_bytes data bytes into groups * group_pixels pixels, extract the reverse */
+typedef void (*LsbModeEmbedFn)(const char *data, long groups, char *pixels);
+typedef void (*LsbModeExtractFn)(char *data, long groups, const char *pixels);
+
+typedef struct _LsbMode
+{
+    const char *name;           // bpp/channels/k/order, e.g. 32/bgr/2/lsb or flat/1/lsb
+    int bpp;                    // 24 or 32, 0 for the flat modes
+    int pixel_size;             // Bytes per pixel, 1 for the flat modes
+    int channels;               // Channel mask, bit 0 blue .. bit 3 alpha
+    int bits;                   // Bits per channel byte
+    int msb_first;              // Stream bits most significant first
+    int group_pixels;           // Pixels per group
+    int group_bytes;            // Stream bytes per group
+    LsbModeEmbedFn embed;
+    LsbModeExtractFn extract;
+} LsbMode;
+
+typedef struct _LsbLayout
+{
+    /* Header fields (read_lsb_header) */
+    int bpp;
+    long compression;
+    long pixel_offset;          // Pixel data offset from the header
+    long file_size;
+
+    /* Geometry for the mode (set_lsb_layout) */
+    const LsbMode *mode;        // Kernel for the header's bpp and the selected channels, bits and order
+    long data_offset;           // First byte of the stream
+    long width, height;         // Pixels per row and rows, LSB_FLAT_ROW_SIZE bytes per row for flat modes
+    long row_size;              // Bytes per row, padding included
+    long row_groups;            // Groups per row
+    long row_bytes;             // Stream bytes per row
+    long last_row_size;         // Bytes and groups of the last row, only shorter for flat modes
+    long last_row_groups;
+    long capacity;              // Stream bytes in the whole image
+
+    /* Row being filled (encode) or consumed (decode) */
+    char *row;                  // row_size pixel bytes (pool buffer)
+    char *bytes;                // Stream bytes of the row (pool buffer)
+    char *check;                // Extracted again for --verify (pool buffer)
+    long filled;                // Stream bytes the current row holds (decode)
+    long used;                  // Stream bytes of the row filled or consumed
+    long rows_done;
+
+} LsbLayout;  // Datatype of the structure
+
+
+/* LSB mode function prototype */
+
+/* Read --bits k */
+Status parse_lsb_bits(const char *arg, int *bits);
+
+/* Read --channels list (letters b, g, r, a) into a channel mask */
+Status parse_lsb_channels(const char *arg, int *channels);
+
+/* Get the kernel for bpp (0 for flat), channel mask, bits and order, NULL if none is compiled in */
+const LsbMode *find_lsb_mode(int bpp, int channels, int bits, int msb_first);
+
+/* Get the table of all mode kernels, terminated by a NULL name */
+const LsbMode *get_lsb_mode_table(void);
+
+/* Extract groups of a mode one bit at a time, the reference for --verify and the self-test */
+void extract_lsb_mode_reference(const LsbMode *mode, char *data, long groups, const char *pixels);
+
+/* Read the header fields of fptr_image into the layout */
+Status read_lsb_header(FILE *fptr_image, LsbLayout *layout);
+
+/* Set up the geometry of a layout with header fields for mode, from offset (0 for the pixel data offset) */
+Status set_lsb_layout(LsbLayout *layout, const LsbMode *mode, long offset);
+
+/* Read the header and set up the layout for channels (0 for flat), bits and order, fptr_image left at the stream */
+Status read_lsb_layout(FILE *fptr_image, int bits, int channels, int msb_first, long offset, LsbLayout *layout);
+
+/* Extract the first size stream bytes of a layout from the image bytes in prefix, read from prefix_offset */
+Status extract_layout_prefix(const LsbLayout *layout, const char *prefix, long prefix_offset, long prefix_size, char *data, long size);
+
+/* Encode the header bytes, the stream and the rows it touches (replaces the header and data steps) */
+Status encode_mode_stream(EncodeInfo *encInfo);
+
+/* Check the magic string and decode the header fields through the layout */
+Status decode_mode_stream(DecodeInfo *decInfo);
+
+/* Write the secret data through the layout */
+Status write_mode_data(DecodeInfo *decInfo);
+
+#endif
@@ -8,12 +8,42 @@
 * (.bmp) file and then that media (.bmp) file is decoded to obtain secret data.
 *
 * Sample Input: 
-* For Encoding: ./a.out -e beautiful.bmp secret.txt [Destination_image_file]
-* For Decoding: ./a.out -d output.bmp [output_file_name]
+* For Encoding: ./a.out -e beautiful.bmp secret.txt [Destination_image_file] [--verify] [--direct] [--journal | --fec[=parity] | --bits k --channels bgra --msb-first]
+* For Decoding: ./a.out -d output.bmp [output_file_name] [--range offset:length | --journal | --bits k --channels bgra --msb-first | --no-probe]
+* For Archiving: ./a.out -c beautiful.bmp archive.bmp file1 [file2 ...]
+* For Listing: ./a.out -l archive.bmp
+* For Extracting: ./a.out -x archive.bmp entry_name [output_file_name]
+* For Appending: ./a.out -a output.bmp more_data_file
+* For Self-test: ./a.out -t [seed] [iterations]
+* For Analyzing: ./a.out -s [--threads N] image1.bmp [image2.bmp ...]
+* For Planning: ./a.out -p cover_dir index_file manifest_file secret1.txt [secret2.txt ...]
+* For Broadcasting: ./a.out -b secret.txt output_dir [--threads N] cover1.bmp [cover2.bmp ...]
+* For Transcoding: ./a.out -r output.bmp new_cover.bmp new_output.bmp
+* For Running: ./a.out -j manifest_file [workers]
+* For Generating: ./a.out -g workload_file output_dir
+* For Watching: ./a.out -w spool_dir output_dir [workers] [--decode]
+* For Tar streams: ./a.out -T [secret.txt | --decode] [encode/decode options] < in.tar > out.tar
+* Any operation: [--kernel scalar|sse2|avx2|avx512|bmi2] (or LSB_KERNEL env)
+* Any operation: [--max-mem bytes[K|M|G]] [--max-bytes bytes[K|M|G]] (budgets per job)
+* Encode/decode: [--progress | --progress=json] [--progress-interval ms] (on stderr, SIGINT/SIGTERM cancel)
+* Encode (also -j, -w): [--cache dir] [--cache-size bytes[K|M|G]] (result cache, default 1G, LRU)
 *
 * Sample Output:
 * For Encoding: Destination_image.bmp
 * For Decoding: output_file.txt
+* For Archiving: archive.bmp
+* For Listing: Entry table (name, offset, length, checksum)
+* For Extracting: entry_name
+* For Appending: output.bmp (updated in place)
+* For Self-test: Pass/fail of every engine and kernel against the reference
+* For Analyzing: LSB popcount, chi-square and detection score per image
+* For Planning: index_file (cover capacities) and manifest_file (one -e job per secret)
+* For Broadcasting: output_dir/cover1.bmp ...
+* For Transcoding: new_output.bmp
+* For Running: Every job's output, one status line per job, latency per size class
+* For Generating: output_dir/ covers, secrets, encode.manifest and decode.manifest
+* For Watching: output_dir/name.bmp (or the decoded file) per job, one status line per job, backlog and throughput reports
+* For Tar streams: A tar stream of name.bmp (or the decoded file) per job on stdout, failures and a report on stderr
 ********************************************************************************/
 
 #include <stdio.h>
@@ -23,15 +53,42 @@
 // User-defined header files
 #include "encode.h"
 #include "decode.h"
+#include "archive.h"
+#include "append.h"
+#include "lsb_kernel.h"
+#include "selftest.h"
+#include "analyze.h"
+#include "planner.h"
+#include "broadcast.h"
+#include "transcode.h"
+#include "runner.h"
+#include "generator.h"
+#include "watch.h"
+#include "tar_stream.h"
+#include "admission.h"
+#include "progress.h"
+#include "pool.h"
+#include "cache.h"
 #include "types.h"
 
 
 // Function prototype for atexit function
 void clear_memory_close_fptr(void);
 
-// Globally declare the EncodeInfo and DecodeInfo structure variables
+// Globally declare the structure variables of every operation
 EncodeInfo encInfo;
 DecodeInfo decInfo;
+ArchiveInfo arcInfo;
+AppendInfo appInfo;
+SelfTestInfo testInfo;
+AnalyzeInfo anaInfo;
+PlannerInfo planInfo;
+BroadcastInfo bcInfo;
+TranscodeInfo tcInfo;
+RunnerInfo runInfo;
+GeneratorInfo genInfo;
+WatchInfo watchInfo;
+TarInfo tarInfo;
 
 int main(int argc, char *argv[])
 {
@@ -43,6 +100,66 @@ int main(int argc, char *argv[])
         return 1;
     }
 
+    // Take out the --kernel, budget, cache and progress options (any position) and select the LSB kernel once
+    const char *kernel_name = NULL;
+    int new_argc = 0;
+    for(int i = 0; i < argc; i++)
+    {
+        if(strcmp(argv[i], "--kernel") == 0 && i + 1 < argc)
+        {
+            kernel_name = argv[++i];
+        }
+        else if((strcmp(argv[i], "--max-mem") == 0 || strcmp(argv[i], "--max-bytes") == 0) && i + 1 < argc)
+        {
+            long *budget = strcmp(argv[i], "--max-mem") == 0 ? &admission.max_mem : &admission.max_bytes;
+            if(parse_admission_size(argv[i + 1], budget) == e_failure)
+            {
+                printf("INFO: Give %s as bytes, optionally with K, M or G!\n", argv[i]);
+                return 1;
+            }
+            i++;
+        }
+        else if(strcmp(argv[i], "--cache") == 0 && i + 1 < argc)
+        {
+            if(set_cache_dir(argv[++i]) == e_failure)
+            {
+                return 1;
+            }
+        }
+        else if(strcmp(argv[i], "--cache-size") == 0 && i + 1 < argc)
+        {
+            if(parse_admission_size(argv[i + 1], &cache.max_size) == e_failure)
+            {
+                printf("INFO: Give %s as bytes, optionally with K, M or G!\n", argv[i]);
+                return 1;
+            }
+            i++;
+        }
+        else if(parse_progress_mode(argv[i]) == e_success)
+        {
+            install_progress_signals();
+        }
+        else if(strcmp(argv[i], "--progress-interval") == 0 && i + 1 < argc)
+        {
+            progress.interval_ms = atol(argv[++i]);
+        }
+        else
+        {
+            argv[new_argc++] = argv[i];
+        }
+    }
+    argc = new_argc;
+    argv[argc] = NULL;
+    // -T keeps stdout for its tar stream, every message goes to stderr from here on
+    if(argc > 1 && strcmp(argv[1], "-T") == 0 && take_tar_output(&tarInfo) == e_failure)
+    {
+        return 1;
+    }
+    if(select_lsb_kernel(kernel_name) == e_failure)
+    {
+        return 1;
+    }
+
     // Function to validate number of arguments
     Status args = validate_args(argc, argv);
     if(args == e_failure)
@@ -52,6 +169,7 @@ int main(int argc, char *argv[])
 
     // Function to check the type of operation (encoding or decoding)
     OperationType op_type = check_operation_type(argv[1]);
+    print_lsb_kernel_report();
 
     // STEP1: Check the op_type is e_encode
     // STEP2: If yes -> Start encode, No -> Goto STEP3
@@ -99,10 +217,190 @@ int main(int argc, char *argv[])
             printf("Error: Not Validated, give the correct file extension!!\n");
         }
     }
-    // STEP5: Print error and stop the process
+    // STEP5: Check op_type is e_archive, e_list or e_extract
+    // STEP6: Validate and run the archive operation, No -> Goto STEP7
+    else if(op_type == e_archive || op_type == e_list || op_type == e_extract)
+    {
+        Status val = op_type == e_archive ? read_and_validate_archive_args(argc, argv, &arcInfo)
+                                          : read_and_validate_extract_args(argc, argv, &arcInfo);
+        if(val == e_success)
+        {
+            Status ret = op_type == e_archive ? do_archiving(&arcInfo)
+                       : op_type == e_list ? do_listing(&arcInfo) : do_extracting(&arcInfo);
+            if(ret == e_failure)
+            {
+                return 1;
+            }
+        }
+        else
+        {
+            printf("Error: Not Validated, give the correct file extension!!\n");
+        }
+    }
+    // STEP7: Check op_type is e_append
+    // STEP8: Validate and append to the encoded image, No -> Goto STEP9
+    else if(op_type == e_append)
+    {
+        if(read_and_validate_append_args(argv, &appInfo) == e_success)
+        {
+            if(do_appending(&appInfo) == e_failure)
+            {
+                return 1;
+            }
+        }
+        else
+        {
+            printf("Error: Not Validated, give the correct file extension!!\n");
+        }
+    }
+    // STEP9: Check op_type is e_selftest
+    // STEP10: Run the self-test, No -> Goto STEP11
+    else if(op_type == e_selftest)
+    {
+        if(read_and_validate_selftest_args(argc, argv, &testInfo) == e_success)
+        {
+            if(do_selftest(&testInfo) == e_failure)
+            {
+                return 1;
+            }
+        }
+        else
+        {
+            printf("Error: Not Validated, give the seed and a positive number of iterations!!\n");
+        }
+    }
+    // STEP11: Check op_type is e_analyze
+    // STEP12: Analyze the images, No -> Goto STEP13
+    else if(op_type == e_analyze)
+    {
+        if(read_and_validate_analyze_args(argc, argv, &anaInfo) == e_success)
+        {
+            if(do_analyzing(&anaInfo) == e_failure)
+            {
+                return 1;
+            }
+        }
+        else
+        {
+            printf("Error: Not Validated, give the correct file extension!!\n");
+        }
+    }
+    // STEP13: Check op_type is e_plan
+    // STEP14: Plan the placement, No -> Goto STEP15
+    else if(op_type == e_plan)
+    {
+        if(read_and_validate_planner_args(argc, argv, &planInfo) == e_success)
+        {
+            if(do_planning(&planInfo) == e_failure)
+            {
+                return 1;
+            }
+        }
+        else
+        {
+            printf("Error: Not Validated, give the cover directory, index, manifest and secrets!!\n");
+        }
+    }
+    // STEP15: Check op_type is e_broadcast
+    // STEP16: Encode the secret into every cover, No -> Goto STEP17
+    else if(op_type == e_broadcast)
+    {
+        if(read_and_validate_broadcast_args(argc, argv, &bcInfo) == e_success)
+        {
+            if(do_broadcasting(&bcInfo) == e_failure)
+            {
+                return 1;
+            }
+        }
+        else
+        {
+            printf("Error: Not Validated, give the correct file extension!!\n");
+        }
+    }
+    // STEP17: Check op_type is e_transcode
+    // STEP18: Move the secret into the new cover, No -> Goto STEP19
+    else if(op_type == e_transcode)
+    {
+        if(read_and_validate_transcode_args(argv, &tcInfo) == e_success)
+        {
+            if(do_transcoding(&tcInfo) == e_failure)
+            {
+                return 1;
+            }
+        }
+        else
+        {
+            printf("Error: Not Validated, give the correct file extension!!\n");
+        }
+    }
+    // STEP19: Check op_type is e_run
+    // STEP20: Run the manifest jobs in worker processes, No -> Goto STEP21
+    else if(op_type == e_run)
+    {
+        if(read_and_validate_runner_args(argc, argv, &runInfo) == e_success)
+        {
+            if(do_running(&runInfo) == e_failure)
+            {
+                return 1;
+            }
+        }
+        else
+        {
+            printf("Error: Not Validated, give the number of workers as 1 to %d!!\n", RUNNER_MAX_WORKERS);
+        }
+    }
+    // STEP21: Check op_type is e_generate
+    // STEP22: Write the synthetic corpus and manifests, No -> Goto STEP23
+    else if(op_type == e_generate)
+    {
+        if(read_and_validate_generator_args(argc, argv, &genInfo) == e_success)
+        {
+            if(do_generating(&genInfo) == e_failure)
+            {
+                return 1;
+            }
+        }
+        else
+        {
+            printf("Error: Not Validated, give a valid workload file!!\n");
+        }
+    }
+    // STEP23: Check op_type is e_watch
+    // STEP24: Watch the spool directory until stopped, No -> Goto STEP25
+    else if(op_type == e_watch)
+    {
+        if(read_and_validate_watch_args(argc, argv, &watchInfo) == e_success)
+        {
+            if(do_watching(&watchInfo) == e_failure)
+            {
+                return 1;
+            }
+        }
+        else
+        {
+            printf("Error: Not Validated, give the number of workers as 1 to %d!!\n", WATCH_MAX_WORKERS);
+        }
+    }
+    // STEP25: Check op_type is e_tar
+    // STEP26: Encode/decode the tar stream on stdin to stdout, No -> Goto STEP27
+    else if(op_type == e_tar)
+    {
+        if(read_and_validate_tar_args(argc, argv, &tarInfo) == e_success)
+        {
+            if(do_tar_streaming(&tarInfo) == e_failure)
+            {
+                return 1;
+            }
+        }
+        else
+        {
+            printf("Error: Not Validated, give one secret .txt file or --decode, and the options of -e or -d!!\n");
+        }
+    }
+    // STEP27: Print error and stop the process
     else
     {
-        printf("Error: Enter '-e' or '-d'!!\n");
+        printf("Error: Enter '-e', '-d', '-c', '-l', '-x', '-a', '-t', '-s', '-p', '-b', '-r', '-j', '-g', '-w' or '-T'!!\n");
     }
     return 0;
 }
@@ -114,8 +412,21 @@ Status validate_args(int argc, char *argv[])
     if(argc < 2)
     {
         printf("INFO: Please pass valid arguments.\n\n");
-        printf("INFO: Encoding - minimum 4 arguments. \nUsage :- ./a.out -e source_image_file secret_data_file [Destination_image_file]\n\n");
-        printf("INFO: Decoding - minimum 3 arguments. \nUsage :- ./a.out -d encoded_image [output_file_name]\n");
+        printf("INFO: Encoding - minimum 4 arguments. \nUsage :- ./a.out -e source_image_file secret_data_file [Destination_image_file] [--verify] [--direct] [--journal | --fec[=parity] | --bits k --channels bgra --msb-first]\n\n");
+        printf("INFO: Decoding - minimum 3 arguments. \nUsage :- ./a.out -d encoded_image [output_file_name] [--range offset:length | --journal | --bits k --channels bgra --msb-first | --no-probe]\n\n");
+        printf("INFO: Archiving - minimum 5 arguments. \nUsage :- ./a.out -c source_image_file archive_image_file file1 [file2 ...]\n\n");
+        printf("INFO: Listing - minimum 3 arguments. \nUsage :- ./a.out -l archive_image_file\n\n");
+        printf("INFO: Extracting - minimum 4 arguments. \nUsage :- ./a.out -x archive_image_file entry_name [output_file_name]\n\n");
+        printf("INFO: Appending - minimum 4 arguments. \nUsage :- ./a.out -a encoded_image more_data_file\n\n");
+        printf("INFO: Self-test - minimum 2 arguments. \nUsage :- ./a.out -t [seed] [iterations]\n\n");
+        printf("INFO: Analyzing - minimum 3 arguments. \nUsage :- ./a.out -s [--threads N] image1.bmp [image2.bmp ...]\n\n");
+        printf("INFO: Planning - minimum 6 arguments. \nUsage :- ./a.out -p cover_dir index_file manifest_file secret1.txt [secret2.txt ...]\n\n");
+        printf("INFO: Broadcasting - minimum 5 arguments. \nUsage :- ./a.out -b secret_data_file output_dir [--threads N] cover1.bmp [cover2.bmp ...]\n\n");
+        printf("INFO: Transcoding - minimum 5 arguments. \nUsage :- ./a.out -r encoded_image new_cover_image new_destination_image\n\n");
+        printf("INFO: Running - minimum 3 arguments. \nUsage :- ./a.out -j manifest_file [workers]\n\n");
+        printf("INFO: Generating - minimum 4 arguments. \nUsage :- ./a.out -g workload_file output_dir\n\n");
+        printf("INFO: Watching - minimum 4 arguments. \nUsage :- ./a.out -w spool_dir output_dir [workers] [--decode]\n\n");
+        printf("INFO: Tar streaming - minimum 2 arguments. \nUsage :- ./a.out -T [secret.txt | --decode] [encode/decode options] < in.tar > out.tar\n");
         return e_failure;
     }
 
@@ -137,6 +448,105 @@ Status validate_args(int argc, char *argv[])
             return e_failure;
         }
     }
+    // If Archiving is selected and the arguments entered are less than 5
+    else if(strcmp(argv[1], "-c") == e_success)
+    {
+        if(argc < 5)
+        {
+            printf("INFO: For Archiving please pass minimum 5 arguments like ./a.out -c source_file.bmp archive.bmp file1 [file2 ...]\n");
+            return e_failure;
+        }
+    }
+    // If Listing is selected and the arguments entered are less than 3
+    else if(strcmp(argv[1], "-l") == e_success)
+    {
+        if(argc < 3)
+        {
+            printf("INFO: For Listing please pass minimum 3 arguments like ./a.out -l archive.bmp\n");
+            return e_failure;
+        }
+    }
+    // If Extracting is selected and the arguments entered are less than 4
+    else if(strcmp(argv[1], "-x") == e_success)
+    {
+        if(argc < 4)
+        {
+            printf("INFO: For Extracting please pass minimum 4 arguments like ./a.out -x archive.bmp entry_name [Output_file_name]\n");
+            return e_failure;
+        }
+    }
+    // If Analyzing is selected and the arguments entered are less than 3
+    else if(strcmp(argv[1], "-s") == e_success)
+    {
+        if(argc < 3)
+        {
+            printf("INFO: For Analyzing please pass minimum 3 arguments like ./a.out -s image1.bmp [image2.bmp ...]\n");
+            return e_failure;
+        }
+    }
+    // If Planning is selected and the arguments entered are less than 6
+    else if(strcmp(argv[1], "-p") == e_success)
+    {
+        if(argc < 6)
+        {
+            printf("INFO: For Planning please pass minimum 6 arguments like ./a.out -p cover_dir index.tsv manifest.tsv secret1.txt [secret2.txt ...]\n");
+            return e_failure;
+        }
+    }
+    // If Broadcasting is selected and the arguments entered are less than 5
+    else if(strcmp(argv[1], "-b") == e_success)
+    {
+        if(argc < 5)
+        {
+            printf("INFO: For Broadcasting please pass minimum 5 arguments like ./a.out -b secret.txt output_dir cover1.bmp [cover2.bmp ...]\n");
+            return e_failure;
+        }
+    }
+    // If Transcoding is selected and the arguments entered are less than 5
+    else if(strcmp(argv[1], "-r") == e_success)
+    {
+        if(argc < 5)
+        {
+            printf("INFO: For Transcoding please pass minimum 5 arguments like ./a.out -r encoded_image.bmp new_cover.bmp new_output.bmp\n");
+            return e_failure;
+        }
+    }
+    // If Running is selected and the arguments entered are less than 3
+    else if(strcmp(argv[1], "-j") == e_success)
+    {
+        if(argc < 3)
+        {
+            printf("INFO: For Running please pass minimum 3 arguments like ./a.out -j manifest.tsv [workers]\n");
+            return e_failure;
+        }
+    }
+    // If Generating is selected and the arguments entered are less than 4
+    else if(strcmp(argv[1], "-g") == e_success)
+    {
+        if(argc < 4)
+        {
+            printf("INFO: For Generating please pass minimum 4 arguments like ./a.out -g workload.txt output_dir\n");
+            return e_failure;
+        }
+    }
+    // If Watching is selected and the arguments entered are less than 4
+    else if(strcmp(argv[1], "-w") == e_success)
+    {
+        if(argc < 4)
+        {
+            printf("INFO: For Watching please pass minimum 4 arguments like ./a.out -w spool_dir output_dir [workers] [--decode]\n");
+            return e_failure;
+        }
+    }
+    // If Appending is selected and the arguments entered are less than 4
+    else if(strcmp(argv[1], "-a") == e_success)
+    {
+        if(argc < 4)
+        {
+            printf("INFO: For Appending please pass minimum 4 arguments like ./a.out -a encoded_image.bmp more_data.txt\n");
+            return e_failure;
+        }
+    }
     // Return success if no errors
     return e_success;
 }
@@ -156,7 +566,61 @@ OperationType check_operation_type(char *argv)
     {
         return e_decode;
     }
-    // STEP5: return e_unsupported
+    // STEP5: Compare argv with -c, -l and -x
+    // STEP6: If yes -> return e_archive, e_list or e_extract, no Goto STEP7
+    else if(strcmp(argv, "-c") == e_success)
+    {
+        return e_archive;
+    }
+    else if(strcmp(argv, "-l") == e_success)
+    {
+        return e_list;
+    }
+    else if(strcmp(argv, "-x") == e_success)
+    {
+        return e_extract;
+    }
+    else if(strcmp(argv, "-a") == e_success)
+    {
+        return e_append;
+    }
+    else if(strcmp(argv, "-t") == e_success)
+    {
+        return e_selftest;
+    }
+    else if(strcmp(argv, "-s") == e_success)
+    {
+        return e_analyze;
+    }
+    else if(strcmp(argv, "-p") == e_success)
+    {
+        return e_plan;
+    }
+    else if(strcmp(argv, "-b") == e_success)
+    {
+        return e_broadcast;
+    }
+    else if(strcmp(argv, "-r") == e_success)
+    {
+        return e_transcode;
+    }
+    else if(strcmp(argv, "-j") == e_success)
+    {
+        return e_run;
+    }
+    else if(strcmp(argv, "-g") == e_success)
+    {
+        return e_generate;
+    }
+    else if(strcmp(argv, "-w") == e_success)
+    {
+        return e_watch;
+    }
+    else if(strcmp(argv, "-T") == e_success)
+    {
+        return e_tar;
+    }
+    // STEP7: return e_unsupported
     else
     {
         return e_unsupported;
@@ -166,22 +630,42 @@ OperationType check_operation_type(char *argv)
 // Function to free the dynamically allocated memory and close file pointers at the end
 void clear_memory_close_fptr(void)
 {
-    // Free allocated memory for encoding
-    if(encInfo.src_image_fname) free(encInfo.src_image_fname);
-    if(encInfo.secret_fname) free(encInfo.secret_fname);
-    if(encInfo.stego_image_fname) free(encInfo.stego_image_fname);
-
-    // Close file pointers for encoding if they are open
+    // Close file pointers for encoding if they are open, file names live in the job arena
     if(encInfo.fptr_secret) fclose(encInfo.fptr_secret);
     if(encInfo.fptr_src_image) fclose(encInfo.fptr_src_image);
     if(encInfo.fptr_stego_image) fclose(encInfo.fptr_stego_image);
 
-    // Free allocated memory for decoding
-    if(decInfo.enc_image_fname) free(decInfo.enc_image_fname);
-    if(decInfo.extn_secret_file) free(decInfo.extn_secret_file);
-    if(decInfo.secret_fname) free(decInfo.secret_fname);
-
-    // Close file pointers for decoding if they are open
+    // Close file pointers for decoding if they are open, names and the FEC stream live in the pool
     if(decInfo.fptr_enc_image) fclose(decInfo.fptr_enc_image);
     if(decInfo.fptr_secret) fclose(decInfo.fptr_secret);
+
+    // Free the entry table and close file pointers for archiving
+    clear_archive_info(&arcInfo);
+
+    // Close file pointers for appending
+    clear_append_info(&appInfo);
+
+    // Free analyze results
+    clear_analyze_info(&anaInfo);
+
+    // Free planner memory
+    clear_planner_info(&planInfo);
+
+    // Free the broadcast plane and results
+    clear_broadcast_info(&bcInfo);
+
+    // Close file pointers for transcoding
+    clear_transcode_info(&tcInfo);
+
+    // Free the jobs and shared memory of the runner
+    clear_runner_info(&runInfo);
+
+    // Free the spool entries, descriptors and shared memory of the watcher
+    clear_watch_info(&watchInfo);
+
+    // Free the shared secret and close the output of the tar stream
+    clear_tar_info(&tarInfo);
+
+    // Free the buffer pool and job arena, after every file above is closed
+    clear_pool();
 }
\ No newline at end of file
@@ -0,0 +1,339 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <sys/stat.h>
+// User-defined header files
+#include "planner.h"
+#include "encode.h"
+#include "types.h"
+
+/* Function Definitions */
+
+// Function to read and validate command line arguments entered by user after -p
+Status read_and_validate_planner_args(int argc, char *argv[], PlannerInfo *planInfo)
+{
+    // STEP1: Store the cover directory, index file and manifest file
+    planInfo->cover_dirname = argv[2];
+    planInfo->index_fname = argv[3];
+    planInfo->manifest_fname = argv[4];
+
+    // STEP2: Every remaining argument is a secret to be placed
+    planInfo->secret_count = argc - 5;
+    planInfo->secrets = calloc(planInfo->secret_count, sizeof(PlannerSecret));
+    if(!planInfo->secrets)
+    {
+        return e_failure;
+    }
+    for(int i = 0; i < planInfo->secret_count; i++)
+    {
+        planInfo->secrets[i].path = argv[5 + i];
+    }
+    return e_success;
+}
+
+// Compare covers by path, for looking up the old index
+static int compare_cover_path(const void *a, const void *b)
+{
+    return strcmp(((const PlannerCover *)a)->path, ((const PlannerCover *)b)->path);
+}
+
+// Compare covers by capacity, smallest first
+static int compare_cover_capacity(const void *a, const void *b)
+{
+    uint x = ((const PlannerCover *)a)->image_capacity;
+    uint y = ((const PlannerCover *)b)->image_capacity;
+    return x < y ? -1 : x > y;
+}
+
+// Compare secrets by needed image bytes, largest first
+static int compare_secret_needed(const void *a, const void *b)
+{
+    unsigned long long x = ((const PlannerSecret *)a)->needed;
+    unsigned long long y = ((const PlannerSecret *)b)->needed;
+    return x > y ? -1 : x < y;
+}
+
+// Function to add a cover to a growing array
+static Status add_cover(PlannerCover **covers, int *count, int *allocated, PlannerCover *cover)
+{
+    if(*count == *allocated)
+    {
+        int size = *allocated ? *allocated * 2 : 256;
+        PlannerCover *grown = realloc(*covers, size * sizeof(PlannerCover));
+        if(!grown)
+        {
+            return e_failure;
+        }
+        *covers = grown;
+        *allocated = size;
+    }
+    (*covers)[(*count)++] = *cover;
+    return e_success;
+}
+
+// Function to load the old index, missing file means an empty index
+static Status load_cover_index(const char *index_fname, PlannerCover **covers, int *count)
+{
+    char line[PLANNER_MAX_PATH + 64];
+    int allocated = 0;
+    int used;
+    PlannerCover cover;
+
+    FILE *fptr_index = fopen(index_fname, "r");
+    if(fptr_index == NULL)
+    {
+        return e_success;
+    }
+    memset(&cover, 0, sizeof(cover));
+    while(fgets(line, sizeof(line), fptr_index))
+    {
+        line[strcspn(line, "\n")] = '\0';
+        if(sscanf(line, "%u\t%ld\t%ld\t%n", &cover.image_capacity, &cover.file_size, &cover.mtime, &used) != 3)
+        {
+            continue;
+        }
+        cover.path = strdup(line + used);
+        if(!cover.path || add_cover(covers, count, &allocated, &cover) == e_failure)
+        {
+            free(cover.path);
+            fclose(fptr_index);
+            return e_failure;
+        }
+    }
+    fclose(fptr_index);
+    qsort(*covers, *count, sizeof(PlannerCover), compare_cover_path);
+    return e_success;
+}
+
+// Function to write the index to a temporary file and rename it over the old one
+static Status save_cover_index(PlannerInfo *planInfo)
+{
+    char tmp_fname[PLANNER_MAX_PATH];
+
+    snprintf(tmp_fname, sizeof(tmp_fname), "%s.tmp", planInfo->index_fname);
+    FILE *fptr_index = fopen(tmp_fname, "w");
+    if(fptr_index == NULL)
+    {
+        perror("fopen");
+        fprintf(stderr, "ERROR: Unable to open file %s\n", tmp_fname);
+        return e_failure;
+    }
+    for(int i = 0; i < planInfo->cover_count; i++)
+    {
+        PlannerCover *cover = &planInfo->covers[i];
+        fprintf(fptr_index, "%u\t%ld\t%ld\t%s\n", cover->image_capacity, cover->file_size, cover->mtime, cover->path);
+    }
+    if(fclose(fptr_index) != 0 || rename(tmp_fname, planInfo->index_fname) != 0)
+    {
+        perror("rename");
+        return e_failure;
+    }
+    return e_success;
+}
+
+// Function to scan the cover directory, only new or changed covers have their header read
+Status build_cover_index(PlannerInfo *planInfo)
+{
+    PlannerCover *old_covers = NULL;
+    int old_count = 0;
+    int allocated = 0;
+    struct dirent *entry;
+    Status ret = e_success;
+
+    // STEP1: Load the old index
+    if(load_cover_index(planInfo->index_fname, &old_covers, &old_count) == e_failure)
+    {
+        return e_failure;
+    }
+
+    // STEP2: Walk the directory for .bmp files
+    DIR *dir = opendir(planInfo->cover_dirname);
+    if(dir == NULL)
+    {
+        perror("opendir");
+        fprintf(stderr, "ERROR: Unable to open directory %s\n", planInfo->cover_dirname);
+        ret = e_failure;
+    }
+    while(ret == e_success && (entry = readdir(dir)) != NULL)
+    {
+        char path[PLANNER_MAX_PATH];
+        struct stat st;
+        size_t len = strlen(entry->d_name);
+        PlannerCover cover;
+
+        if(len < 4 || strcmp(entry->d_name + len - 4, ".bmp") != 0)
+        {
+            continue;
+        }
+        snprintf(path, sizeof(path), "%s/%s", planInfo->cover_dirname, entry->d_name);
+        if(stat(path, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size < 54)
+        {
+            continue;
+        }
+        memset(&cover, 0, sizeof(cover));
+        cover.path = path;
+        cover.file_size = st.st_size;
+        cover.mtime = st.st_mtime;
+
+        // STEP3: Unchanged since indexed -> reuse capacity, else read the header
+        PlannerCover *old = bsearch(&cover, old_covers, old_count, sizeof(PlannerCover), compare_cover_path);
+        if(old && old->file_size == cover.file_size && old->mtime == cover.mtime)
+        {
+            cover.image_capacity = old->image_capacity;
+        }
+        else
+        {
+            FILE *fptr_image = fopen(path, "r");
+            if(fptr_image == NULL)
+            {
+                continue;
+            }
+            cover.image_capacity = get_image_size_for_bmp(fptr_image);
+            fclose(fptr_image);
+            // A header claiming more pixels than the file holds would fail mid encode
+            if(cover.image_capacity > cover.file_size - 54)
+            {
+                cover.image_capacity = cover.file_size - 54;
+            }
+            planInfo->indexed_count++;
+        }
+
+        cover.path = strdup(path);
+        if(!cover.path || add_cover(&planInfo->covers, &planInfo->cover_count, &allocated, &cover) == e_failure)
+        {
+            free(cover.path);
+            ret = e_failure;
+        }
+    }
+    if(dir) closedir(dir);
+    for(int i = 0; i < old_count; i++)
+    {
+        free(old_covers[i].path);
+    }
+    free(old_covers);
+
+    // STEP4: Save the index and sort the covers by capacity for placing
+    if(ret == e_success)
+    {
+        ret = save_cover_index(planInfo);
+        qsort(planInfo->covers, planInfo->cover_count, sizeof(PlannerCover), compare_cover_capacity);
+    }
+    return ret;
+}
+
+// Function to place every secret, largest first, into the smallest free cover that holds it
+Status place_secrets(PlannerInfo *planInfo)
+{
+    // STEP1: Find the image bytes each secret needs, as check_capacity() would
+    for(int i = 0; i < planInfo->secret_count; i++)
+    {
+        PlannerSecret *secret = &planInfo->secrets[i];
+        struct stat st;
+        const char *extn = get_secret_extension(secret->path);
+
+        // Secrets the encoder would reject (not .txt, unreadable) are never placed
+        if(stat(secret->path, &st) != 0 || strstr(secret->path, ".txt") == NULL || extn == NULL || st.st_size == 0)
+        {
+            secret->needed = ~0ULL;
+            continue;
+        }
+        secret->needed = get_encoded_size(strlen(extn), st.st_size);
+    }
+    qsort(planInfo->secrets, planInfo->secret_count, sizeof(PlannerSecret), compare_secret_needed);
+
+    // STEP2: Best fit, binary search the first cover with capacity > needed, then take the first free one
+    for(int i = 0; i < planInfo->secret_count; i++)
+    {
+        PlannerSecret *secret = &planInfo->secrets[i];
+        int low = 0, high = planInfo->cover_count;
+
+        while(low < high)
+        {
+            int mid = low + (high - low) / 2;
+            if(planInfo->covers[mid].image_capacity > secret->needed)
+            {
+                high = mid;
+            }
+            else
+            {
+                low = mid + 1;
+            }
+        }
+        while(low < planInfo->cover_count && planInfo->covers[low].used)
+        {
+            low++;
+        }
+        if(low < planInfo->cover_count && secret->needed != ~0ULL)
+        {
+            planInfo->covers[low].used = 1;
+            secret->cover = &planInfo->covers[low];
+        }
+    }
+    return e_success;
+}
+
+// Function to write the manifest, one -e job per placed secret
+static Status write_manifest(PlannerInfo *planInfo, int *placed)
+{
+    FILE *fptr_manifest = fopen(planInfo->manifest_fname, "w");
+    if(fptr_manifest == NULL)
+    {
+        perror("fopen");
+        fprintf(stderr, "ERROR: Unable to open file %s\n", planInfo->manifest_fname);
+        return e_failure;
+    }
+
+    *placed = 0;
+    for(int i = 0; i < planInfo->secret_count; i++)
+    {
+        PlannerSecret *secret = &planInfo->secrets[i];
+        if(secret->cover == NULL)
+        {
+            printf("INFO: No cover can hold %s!\n", secret->path);
+            continue;
+        }
+        // Stego image is the secret path with its extension replaced
+        int stem = strrchr(secret->path, '.') - secret->path;
+        fprintf(fptr_manifest, "-e\t%s\t%s\t%.*s%s\n", secret->cover->path, secret->path, stem, secret->path, PLANNER_STEGO_SUFFIX);
+        (*placed)++;
+    }
+    return fclose(fptr_manifest) == 0 ? e_success : e_failure;
+}
+
+// Function to build the index, place the secrets and write the manifest
+Status do_planning(PlannerInfo *planInfo)
+{
+    int placed;
+
+    // STEP1: Index the cover pool from headers only
+    if(build_cover_index(planInfo) == e_failure)
+    {
+        printf("INFO: The cover index could not be built!\n\n");
+        return e_failure;
+    }
+    printf("INFO: %d covers indexed, %d headers read.\n\n", planInfo->cover_count, planInfo->indexed_count);
+
+    // STEP2: Place the secrets
+    place_secrets(planInfo);
+
+    // STEP3: Write the manifest
+    if(write_manifest(planInfo, &placed) == e_failure)
+    {
+        printf("INFO: The manifest could not be written!\n\n");
+        return e_failure;
+    }
+    printf("INFO: %d of %d secrets placed, manifest written to %s.\n", placed, planInfo->secret_count, planInfo->manifest_fname);
+    return placed == planInfo->secret_count ? e_success : e_failure;
+}
+
+// Function to free planner memory
+void clear_planner_info(PlannerInfo *planInfo)
+{
+    for(int i = 0; i < planInfo->cover_count; i++)
+    {
+        free(planInfo->covers[i].path);
+    }
+    if(planInfo->covers) free(planInfo->covers);
+    if(planInfo->secrets) free(planInfo->secrets);
+}
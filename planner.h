@@ -0,0 +1,69 @@
+#ifndef PLANNER_H
+#define PLANNER_H
+
+#include "types.h" // Contains user defined types
+
+/*
+ * Structures to store information required for
+ * planning which cover image carries which secret
+ *
+ * Index file (one cover per line, tab separated, header fields only):
+ * image_capacity  file_size  mtime  path
+ *
+ * Manifest file (one job per line, tab separated):
+ * -e  cover.bmp  secret.txt  stego.bmp
+ */
+
+#define PLANNER_MAX_PATH 4096
+#define PLANNER_STEGO_SUFFIX ".stego.bmp"
+
+typedef struct _PlannerCover
+{
+    char *path;                 // Cover image path
+    uint image_capacity;        // width * height * 3 from the bmp header
+    long file_size;             // File size when indexed
+    long mtime;                 // Modification time when indexed
+    int used;                   // Already assigned to a secret
+} PlannerCover;
+
+typedef struct _PlannerSecret
+{
+    char *path;                 // Secret file path, points into argv
+    unsigned long long needed;  // Image bytes needed, see get_encoded_size()
+    PlannerCover *cover;        // Assigned cover, NULL if none fits
+} PlannerSecret;
+
+typedef struct _PlannerInfo
+{
+    char *cover_dirname;        // Directory with the cover pool
+    char *index_fname;          // Persistent capacity index
+    char *manifest_fname;       // Batch manifest written by the planner
+
+    PlannerCover *covers;       // Covers sorted by capacity
+    int cover_count;
+    int indexed_count;          // Covers whose header had to be read (not in index)
+
+    PlannerSecret *secrets;     // Secrets to be placed
+    int secret_count;
+
+} PlannerInfo;  // Datatype of the structure
+
+
+/* Planner function prototype */
+
+/* Read and validate planner args from argv */
+Status read_and_validate_planner_args(int argc, char *argv[], PlannerInfo *planInfo);
+
+/* Build the index, place the secrets and write the manifest */
+Status do_planning(PlannerInfo *planInfo);
+
+/* Scan the cover directory, reusing index entries of unchanged files */
+Status build_cover_index(PlannerInfo *planInfo);
+
+/* Best fit: each secret, largest first, gets the smallest free cover that holds it */
+Status place_secrets(PlannerInfo *planInfo);
+
+/* Free planner memory */
+void clear_planner_info(PlannerInfo *planInfo);
+
+#endif
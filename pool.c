@@ -0,0 +1,191 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+// User-defined header files
+#include "pool.h"
+#include "types.h"
+
+PoolInfo pool;
+
+/* Function Definitions */
+
+// Function to find the smallest buffer class holding size bytes, -1 if none does
+static int get_buffer_class(long size)
+{
+    for(int c = 0; c < POOL_CLASSES; c++)
+    {
+        if(size <= 1L << (POOL_MIN_SHIFT + c))
+        {
+            return c;
+        }
+    }
+    return -1;
+}
+
+// Function to get an aligned buffer of at least size bytes, from the cache if one is free
+void *get_pool_buffer(long size)
+{
+    void *buffer = NULL;
+    int c = get_buffer_class(size);
+    int slot = 0;
+
+    // STEP1: The job must have a free slot to hold it
+    while(slot < POOL_MAX_OUTSTANDING && pool.outstanding[slot])
+    {
+        slot++;
+    }
+    if(c < 0 || slot == POOL_MAX_OUTSTANDING)
+    {
+        return NULL;
+    }
+
+    // STEP2: Reuse a cached buffer of the class, else allocate one
+    if(pool.free_count[c] > 0)
+    {
+        buffer = pool.free_buffers[c][--pool.free_count[c]];
+        pool.buffer_reuses++;
+    }
+    else if(posix_memalign(&buffer, POOL_ALIGNMENT, 1L << (POOL_MIN_SHIFT + c)) == 0)
+    {
+        pool.heap_allocs++;
+    }
+    else
+    {
+        return NULL;
+    }
+
+    pool.outstanding[slot] = buffer;
+    pool.outstanding_class[slot] = c;
+    return buffer;
+}
+
+// Function to give a buffer back to its class before the job ends
+void put_pool_buffer(void *buffer)
+{
+    for(int slot = 0; buffer && slot < POOL_MAX_OUTSTANDING; slot++)
+    {
+        if(pool.outstanding[slot] == buffer)
+        {
+            int c = pool.outstanding_class[slot];
+            pool.outstanding[slot] = NULL;
+            if(pool.free_count[c] < POOL_MAX_FREE)
+            {
+                pool.free_buffers[c][pool.free_count[c]++] = buffer;
+            }
+            else
+            {
+                free(buffer);
+            }
+            return;
+        }
+    }
+}
+
+// Function to allocate a chunk with size usable bytes
+static ArenaChunk *new_arena_chunk(long size)
+{
+    ArenaChunk *chunk = malloc(sizeof(ArenaChunk) + size);
+    if(chunk)
+    {
+        chunk->next = NULL;
+        chunk->size = size;
+        chunk->used = 0;
+        pool.heap_allocs++;
+    }
+    return chunk;
+}
+
+// Function to bump size bytes from the job arena
+void *arena_alloc(long size)
+{
+    size = (size + 15) & ~15L;
+    pool.arena_bytes += size;
+
+    // STEP1: Requests bigger than a chunk get their own, freed at job end
+    if(size > ARENA_CHUNK_SIZE)
+    {
+        ArenaChunk *chunk = new_arena_chunk(size);
+        if(!chunk)
+        {
+            return NULL;
+        }
+        chunk->next = pool.oversized;
+        pool.oversized = chunk;
+        return chunk->data;
+    }
+
+    // STEP2: Move to the next kept chunk when the current one is full, allocate one past the end
+    if(!pool.arena && !(pool.arena = new_arena_chunk(ARENA_CHUNK_SIZE)))
+    {
+        return NULL;
+    }
+    if(!pool.current)
+    {
+        pool.current = pool.arena;
+    }
+    while(pool.current->used + size > pool.current->size)
+    {
+        if(!pool.current->next && !(pool.current->next = new_arena_chunk(ARENA_CHUNK_SIZE)))
+        {
+            return NULL;
+        }
+        pool.current = pool.current->next;
+    }
+
+    // STEP3: Bump
+    void *ptr = pool.current->data + pool.current->used;
+    pool.current->used += size;
+    return ptr;
+}
+
+// Function to copy a string into the job arena
+char *arena_strdup(const char *str)
+{
+    char *copy = arena_alloc(strlen(str) + 1);
+    if(copy)
+    {
+        strcpy(copy, str);
+    }
+    return copy;
+}
+
+// Function to return every buffer of the job and rewind the arena
+void release_job_memory(void)
+{
+    for(int slot = 0; slot < POOL_MAX_OUTSTANDING; slot++)
+    {
+        put_pool_buffer(pool.outstanding[slot]);
+    }
+    while(pool.oversized)
+    {
+        ArenaChunk *next = pool.oversized->next;
+        free(pool.oversized);
+        pool.oversized = next;
+    }
+    for(ArenaChunk *chunk = pool.arena; chunk; chunk = chunk->next)
+    {
+        chunk->used = 0;
+    }
+    pool.current = pool.arena;
+    pool.arena_bytes = 0;
+}
+
+// Function to free everything the pool holds
+void clear_pool(void)
+{
+    release_job_memory();
+    for(int c = 0; c < POOL_CLASSES; c++)
+    {
+        while(pool.free_count[c] > 0)
+        {
+            free(pool.free_buffers[c][--pool.free_count[c]]);
+        }
+    }
+    while(pool.arena)
+    {
+        ArenaChunk *next = pool.arena->next;
+        free(pool.arena);
+        pool.arena = next;
+    }
+    pool.current = NULL;
+}
@@ -0,0 +1,84 @@
+#ifndef POOL_H
+#define POOL_H
+
+#include "types.h" // Contains user defined types
+
+/*
+ * Per-process memory reused across jobs: a pool of aligned I/O buffers
+ * and a bump arena for the small allocations of a job (file names,
+ * decoded extension, open file state)
+ *
+ * Buffers come in power of two classes from POOL_MIN_BUFFER up, are
+ * POOL_ALIGNMENT aligned (usable for O_DIRECT) and not zeroed. A job
+ * takes them with get_pool_buffer() and may give them back early with
+ * put_pool_buffer(); release_job_memory() at job end returns the rest
+ * and rewinds the arena in one shot. Up to POOL_MAX_FREE buffers per
+ * class stay cached, so once a worker has seen a job of some shape the
+ * next ones reuse its memory and make no heap allocations.
+ *
+ * Each runner worker is a process with its own pool. Not thread safe:
+ * only the job path (encode, decode, FEC, direct output, chunks) uses it
+ */
+
+#define POOL_ALIGNMENT 4096
+#define POOL_MIN_SHIFT 12               // Smallest buffer class, 4 KiB
+#define POOL_CLASSES 20                 // Largest buffer class, 2 GiB
+#define POOL_MAX_FREE 4                 // Cached buffers per class
+#define POOL_MAX_OUTSTANDING 32         // Buffers a job may hold at once
+#define POOL_IO_BUFFER_SIZE (256 * 1024)    // I/O block of the chunk engine
+#define ARENA_CHUNK_SIZE (64 * 1024)    // Arena grows by this, bigger requests get their own chunk
+
+typedef struct _ArenaChunk
+{
+    struct _ArenaChunk *next;
+    long size;                  // Usable bytes in data
+    long used;
+    unsigned char data[];
+
+} ArenaChunk;
+
+typedef struct _PoolInfo
+{
+    /* Buffers */
+    void *free_buffers[POOL_CLASSES][POOL_MAX_FREE];
+    int free_count[POOL_CLASSES];
+    void *outstanding[POOL_MAX_OUTSTANDING];       // Buffers held by the current job
+    int outstanding_class[POOL_MAX_OUTSTANDING];
+
+    /* Arena */
+    ArenaChunk *arena;          // Chunks of ARENA_CHUNK_SIZE, kept across jobs
+    ArenaChunk *current;        // Chunk being bumped
+    ArenaChunk *oversized;      // Chunks for big requests, freed at job end
+
+    /* Stats */
+    long heap_allocs;           // Heap allocations made by the pool and the arena
+    long buffer_reuses;         // Buffers served from the cache
+    long arena_bytes;           // Arena bytes handed out in the current job
+
+} PoolInfo;  // Datatype of the structure
+
+/* Pool of the current process */
+extern PoolInfo pool;
+
+
+/* Pool function prototype */
+
+/* Get an aligned buffer of at least size bytes, not zeroed, NULL if out of memory */
+void *get_pool_buffer(long size);
+
+/* Give a buffer back before the job ends */
+void put_pool_buffer(void *buffer);
+
+/* Get size bytes from the job arena, 16 byte aligned, NULL if out of memory */
+void *arena_alloc(long size);
+
+/* Copy a string into the job arena */
+char *arena_strdup(const char *str);
+
+/* Job end: return every buffer to the pool and rewind the arena */
+void release_job_memory(void);
+
+/* Free everything the pool holds */
+void clear_pool(void);
+
+#endif
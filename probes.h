@@ -0,0 +1,52 @@
+#ifndef PROBES_H
+#define PROBES_H
+
+/*
+ * USDT (static user space) tracepoints, provider "stego"
+ *
+ * Compiled in when <sys/sdt.h> is available (systemtap-sdt-dev), each
+ * probe is a single nop plus a note in the ELF until bpftrace/perf
+ * attaches to it, so the probes stay in production builds. Without
+ * <sys/sdt.h>, or with -DNO_PROBES, the macros compile to nothing.
+ * readelf -n a.out lists every probe (NT_STAPSDT) with its arguments
+ *
+ *   job__start     (job_id, name)
+ *   job__end       (job_id, event, elapsed_ms)        event: done, failed or cancelled
+ *   stage__start   (job_id, stage, total)
+ *   stage__end     (job_id, stage, done)
+ *   embed__enter   (job_id, secret_offset, bytes)     block enters the embed kernel
+ *   embed__leave   (job_id, secret_offset, bytes)
+ *   extract__enter (job_id, secret_offset, bytes)     block enters the extract kernel
+ *   extract__leave (job_id, secret_offset, bytes)
+ *   io__submit     (job_id, dir, file_offset, bytes)  dir: PROBE_IO_READ or PROBE_IO_WRITE
+ *   io__complete   (job_id, dir, file_offset, bytes)  bytes actually transferred
+ *
+ * Job ID is progress.job_id: the manifest line in a runner worker, else 0
+ * Offsets are -1 where the caller does not track them (decode_image_to_block())
+ *
+ *   bpftrace -e 'usdt:./a.out:stego:io__submit { @s[tid] = nsecs; }
+ *                usdt:./a.out:stego:io__complete /@s[tid]/ { @us = hist((nsecs - @s[tid]) / 1000); }'
+ */
+
+#if !defined(NO_PROBES) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define PROBES_ENABLED 1
+#endif
+#endif
+
+#define PROBE_IO_READ 0
+#define PROBE_IO_WRITE 1
+
+#ifdef PROBES_ENABLED
+#define PROBE2(name, a1, a2) STAP_PROBE2(stego, name, a1, a2)
+#define PROBE3(name, a1, a2, a3) STAP_PROBE3(stego, name, a1, a2, a3)
+#define PROBE4(name, a1, a2, a3, a4) STAP_PROBE4(stego, name, a1, a2, a3, a4)
+#else
+// Arguments are plain values, casting them to void only keeps "set but not used" quiet
+#define PROBE2(name, a1, a2) do { (void)(a1); (void)(a2); } while(0)
+#define PROBE3(name, a1, a2, a3) do { (void)(a1); (void)(a2); (void)(a3); } while(0)
+#define PROBE4(name, a1, a2, a3, a4) do { (void)(a1); (void)(a2); (void)(a3); (void)(a4); } while(0)
+#endif
+
+#endif
@@ -0,0 +1,190 @@
+#include <stdio.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+// User-defined header files
+#include "progress.h"
+#include "types.h"
+#include "probes.h"
+
+// Progress of the current process, off until --progress
+ProgressInfo progress = { .mode = e_progress_off, .interval_ms = PROGRESS_DEFAULT_INTERVAL_MS, .callback = print_progress_event };
+
+/* Function Definitions */
+
+// Function to read --progress or --progress=json
+Status parse_progress_mode(const char *arg)
+{
+    if(strcmp(arg, "--progress") == 0)
+    {
+        progress.mode = e_progress_line;
+    }
+    else if(strcmp(arg, "--progress=json") == 0)
+    {
+        progress.mode = e_progress_json;
+    }
+    else
+    {
+        return e_failure;
+    }
+    return e_success;
+}
+
+// Signal handler, the job stops at the next block
+static void handle_cancel_signal(int signum)
+{
+    (void)signum;
+    cancel_progress();
+}
+
+// Function to cancel SIGINT and SIGTERM at the next block instead of killing the job
+void install_progress_signals(void)
+{
+    struct sigaction action;
+
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = handle_cancel_signal;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+}
+
+// Milliseconds from start to now
+static long get_progress_ms(struct timespec *start, struct timespec *now)
+{
+    return (now->tv_sec - start->tv_sec) * 1000L + (now->tv_nsec - start->tv_nsec) / 1000000;
+}
+
+// Function to send an event to the callback
+static Status emit_progress(const char *event)
+{
+    if(progress.mode == e_progress_off || progress.callback == NULL)
+    {
+        return e_success;
+    }
+    if(progress.callback(&progress, event) == e_failure)
+    {
+        cancel_progress();
+        return e_failure;
+    }
+    return e_success;
+}
+
+// Function to start a job
+void start_progress_job(const char *job_name)
+{
+    progress.job_name = job_name;
+    progress.stage = "start";
+    progress.done = progress.total = progress.last_done = 0;
+    progress.mb_per_s = 0;
+    progress.elapsed_ms = 0;
+    clock_gettime(CLOCK_MONOTONIC, &progress.start);
+    progress.last = progress.start;
+    PROBE2(job__start, progress.job_id, job_name);
+    emit_progress("start");
+}
+
+// Function to start a stage of total bytes
+void start_progress_stage(const char *stage, long total)
+{
+    PROBE3(stage__end, progress.job_id, progress.stage, progress.done);
+    PROBE3(stage__start, progress.job_id, stage, total);
+    progress.stage = stage;
+    progress.done = progress.last_done = 0;
+    progress.total = total;
+    progress.mb_per_s = 0;
+    clock_gettime(CLOCK_MONOTONIC, &progress.last);
+    progress.elapsed_ms = get_progress_ms(&progress.start, &progress.last);
+    emit_progress("stage");
+}
+
+// Function to report the bytes done in the stage, called between blocks
+Status report_progress(long done)
+{
+    struct timespec now;
+
+    progress.done = done;
+    if(progress.cancelled)
+    {
+        return e_failure;
+    }
+    if(progress.mode == e_progress_off)
+    {
+        return e_success;
+    }
+
+    // At most one event per interval, and one when the stage completes
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    long since_ms = get_progress_ms(&progress.last, &now);
+    if(since_ms < progress.interval_ms && done < progress.total)
+    {
+        return e_success;
+    }
+    long since_us = (now.tv_sec - progress.last.tv_sec) * 1000000L + (now.tv_nsec - progress.last.tv_nsec) / 1000;
+    progress.mb_per_s = since_us > 0 ? (double)(done - progress.last_done) / since_us : 0;
+    progress.elapsed_ms = get_progress_ms(&progress.start, &now);
+    progress.last = now;
+    progress.last_done = done;
+    return emit_progress("progress");
+}
+
+// Function to end the job
+void finish_progress_job(Status status)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    progress.elapsed_ms = get_progress_ms(&progress.start, &now);
+    const char *event = progress.cancelled ? "cancelled" : status == e_success ? "done" : "failed";
+    PROBE3(stage__end, progress.job_id, progress.stage, progress.done);
+    PROBE3(job__end, progress.job_id, event, progress.elapsed_ms);
+    emit_progress(event);
+}
+
+// Function to cancel the job at the next block, safe from a signal handler
+void cancel_progress(void)
+{
+    progress.cancelled = 1;
+}
+
+// Default callback: a progress line or a JSON event on stderr
+Status print_progress_event(ProgressInfo *progress, const char *event)
+{
+    if(progress->mode == e_progress_json)
+    {
+        fprintf(stderr, "{\"event\":\"%s\",\"job\":\"", event);
+        for(const char *ptr = progress->job_name ? progress->job_name : ""; *ptr; ptr++)
+        {
+            if(*ptr == '"' || *ptr == '\\')
+            {
+                fputc('\\', stderr);
+            }
+            fputc(*ptr, stderr);
+        }
+        fprintf(stderr, "\",\"stage\":\"%s\",\"done\":%ld,\"total\":%ld,\"mb_per_s\":%.1f,\"elapsed_ms\":%ld}\n",
+                progress->stage, progress->done, progress->total, progress->mb_per_s, progress->elapsed_ms);
+        return e_success;
+    }
+
+    // Line mode: rewrite one line per stage, end it when the next stage starts or the job ends
+    static int line_open = 0;
+    if(strcmp(event, "progress") == 0)
+    {
+        line_open = 1;
+        fprintf(stderr, "\r%-8s %12ld / %-12ld bytes %5.1f%% %9.1f MB/s", progress->stage, progress->done, progress->total,
+                progress->total ? 100.0 * progress->done / progress->total : 100.0, progress->mb_per_s);
+    }
+    else if(strcmp(event, "start") != 0)
+    {
+        if(line_open)
+        {
+            fputc('\n', stderr);
+            line_open = 0;
+        }
+        if(strcmp(event, "stage") != 0)
+        {
+            fprintf(stderr, "%s %s after %ld ms\n", progress->job_name ? progress->job_name : "", event, progress->elapsed_ms);
+        }
+    }
+    return e_success;
+}
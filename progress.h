@@ -0,0 +1,79 @@
+#ifndef PROGRESS_H
+#define PROGRESS_H
+
+#include <signal.h>
+#include <time.h>
+#include "types.h" // Contains user defined types
+
+/*
+ * Progress events and cooperative cancellation for long jobs
+ *
+ * The block loops call report_progress() between blocks. At most every
+ * interval_ms it hands the stage, bytes done, total and MB/s since the
+ * last event to the callback (a progress line or JSON events on stderr
+ * by default). A cancelled job (SIGINT/SIGTERM, or a callback returning
+ * e_failure) stops at the next block and returns e_failure
+ */
+
+#define PROGRESS_DEFAULT_INTERVAL_MS 500
+
+typedef enum
+{
+    e_progress_off,
+    e_progress_line,            // --progress: one line on stderr, rewritten in place
+    e_progress_json             // --progress=json: one JSON event per line on stderr
+} ProgressMode;
+
+typedef struct _ProgressInfo
+{
+    ProgressMode mode;
+    long interval_ms;           // Minimum time between progress events (--progress-interval)
+    Status (*callback)(struct _ProgressInfo *progress, const char *event);   // e_failure cancels the job
+
+    /* Current job */
+    long job_id;                // Job ID in the trace probes, set by the runner
+    const char *job_name;       // Output or input file of the job
+    const char *stage;          // Stage the block loop is in
+    long done;                  // Bytes of the stage processed
+    long total;                 // Bytes of the stage
+    double mb_per_s;            // Throughput since the last event
+    long elapsed_ms;            // Since the job started
+    volatile sig_atomic_t cancelled;
+
+    /* Last event */
+    struct timespec start, last;
+    long last_done;
+
+} ProgressInfo;  // Datatype of the structure
+
+/* Progress of the current process, set once from the command line */
+extern ProgressInfo progress;
+
+
+/* Progress function prototype */
+
+/* Read --progress[=json] */
+Status parse_progress_mode(const char *arg);
+
+/* Cancel SIGINT and SIGTERM at the next block instead of killing the job */
+void install_progress_signals(void);
+
+/* A job starts */
+void start_progress_job(const char *job_name);
+
+/* A stage of total bytes starts */
+void start_progress_stage(const char *stage, long total);
+
+/* Bytes done in the stage, e_failure if the job was cancelled */
+Status report_progress(long done);
+
+/* The job ended with status */
+void finish_progress_job(Status status);
+
+/* Cancel the job at the next block, safe from a signal handler */
+void cancel_progress(void);
+
+/* Default callback, renders the line or JSON event */
+Status print_progress_event(ProgressInfo *progress, const char *event);
+
+#endif
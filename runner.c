@@ -0,0 +1,443 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+// User-defined header files
+#include "runner.h"
+#include "scheduler.h"
+#include "encode.h"
+#include "decode.h"
+#include "types.h"
+#include "common.h"
+#include "admission.h"
+#include "progress.h"
+#include "pool.h"
+
+/* Function Definitions */
+
+// Function to read and validate command line arguments entered by user after -j
+Status read_and_validate_runner_args(int argc, char *argv[], RunnerInfo *runInfo)
+{
+    // STEP1: Store the manifest file name
+    runInfo->manifest_fname = argv[2];
+
+    // STEP2: Optional number of workers, default one per online CPU
+    if(argc > 3)
+    {
+        runInfo->workers = atoi(argv[3]);
+        if(runInfo->workers <= 0 || runInfo->workers > RUNNER_MAX_WORKERS)
+        {
+            return e_failure;
+        }
+    }
+    else
+    {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        runInfo->workers = cpus <= 0 ? 1 : cpus > RUNNER_MAX_WORKERS ? RUNNER_MAX_WORKERS : cpus;
+    }
+    return e_success;
+}
+
+// Function to read the manifest into jobs, empty lines and # comments are skipped
+Status load_runner_manifest(RunnerInfo *runInfo)
+{
+    char line[RUNNER_MAX_LINE];
+    int allocated = 0, line_number = 0;
+
+    FILE *fptr_manifest = fopen(runInfo->manifest_fname, "r");
+    if(fptr_manifest == NULL)
+    {
+        perror("fopen");
+        fprintf(stderr, "ERROR: Unable to open file %s\n", runInfo->manifest_fname);
+        return e_failure;
+    }
+
+    while(fgets(line, sizeof(line), fptr_manifest))
+    {
+        line_number++;
+        line[strcspn(line, "\r\n")] = '\0';
+        if(line[0] == '\0' || line[0] == '#')
+        {
+            continue;
+        }
+
+        // STEP1: Grow the job array
+        if(runInfo->job_count == allocated)
+        {
+            int size = allocated ? allocated * 2 : 256;
+            RunnerJob *grown = realloc(runInfo->jobs, size * sizeof(RunnerJob));
+            if(!grown)
+            {
+                fclose(fptr_manifest);
+                return e_failure;
+            }
+            runInfo->jobs = grown;
+            allocated = size;
+        }
+
+        // STEP2: Split the line on tabs into an argv for the encode/decode argument readers
+        RunnerJob *job = &runInfo->jobs[runInfo->job_count];
+        memset(job, 0, sizeof(RunnerJob));
+        job->line = strdup(line);
+        job->line_number = line_number;
+        if(!job->line)
+        {
+            fclose(fptr_manifest);
+            return e_failure;
+        }
+        runInfo->job_count++;
+        job->argv[job->argc++] = "./a.out";
+        for(char *field = strtok(job->line, "\t"); field; field = strtok(NULL, "\t"))
+        {
+            if(job->argc == RUNNER_MAX_ARGS + 2)
+            {
+                printf("INFO: %s:%d has too many arguments!\n\n", runInfo->manifest_fname, line_number);
+                fclose(fptr_manifest);
+                return e_failure;
+            }
+            job->argv[job->argc++] = field;
+        }
+
+        // STEP3: Only encode and decode jobs, with their minimum arguments
+        if(!((job->argc >= 4 && strcmp(job->argv[1], "-e") == 0) || (job->argc >= 3 && strcmp(job->argv[1], "-d") == 0)))
+        {
+            printf("INFO: %s:%d is not an -e or -d job!\n\n", runInfo->manifest_fname, line_number);
+            fclose(fptr_manifest);
+            return e_failure;
+        }
+    }
+    fclose(fptr_manifest);
+    return runInfo->job_count > 0 ? e_success : e_failure;
+}
+
+// Take a task from the head of a slice, the owner's end, the task is recorded in claim before it is dequeued
+static int take_runner_task(unsigned long long *queue, int *claim)
+{
+    unsigned long long old = __atomic_load_n(queue, __ATOMIC_ACQUIRE);
+    for(;;)
+    {
+        unsigned long long head = old >> 32, tail = old & 0xFFFFFFFF;
+        if(head >= tail)
+        {
+            return -1;
+        }
+        __atomic_store_n(claim, (int)head, __ATOMIC_SEQ_CST);
+        if(__atomic_compare_exchange_n(queue, &old, ((head + 1) << 32) | tail, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+        {
+            return head;
+        }
+    }
+}
+
+// Take a task from the tail of a slice, the thief's end, the task is recorded in claim before it is dequeued
+static int steal_runner_task(unsigned long long *queue, int *claim)
+{
+    unsigned long long old = __atomic_load_n(queue, __ATOMIC_ACQUIRE);
+    for(;;)
+    {
+        unsigned long long head = old >> 32, tail = old & 0xFFFFFFFF;
+        if(head >= tail)
+        {
+            return -1;
+        }
+        __atomic_store_n(claim, (int)(tail - 1), __ATOMIC_SEQ_CST);
+        if(__atomic_compare_exchange_n(queue, &old, (head << 32) | (tail - 1), 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+        {
+            return tail - 1;
+        }
+    }
+}
+
+// Function to take the next task of a worker, stealing from other workers when its own slice is empty
+// current[worker] holds the task from before it leaves the queue until it is done, so a worker
+// that dies in between never loses a job (see is_runner_task_lost())
+int next_runner_task(RunnerInfo *runInfo, int worker)
+{
+    int *claim = &runInfo->shared->current[worker];
+    int task = take_runner_task(&runInfo->shared->queues[worker], claim);
+
+    for(int i = 1; task < 0 && i < runInfo->workers; i++)
+    {
+        task = steal_runner_task(&runInfo->shared->queues[(worker + i) % runInfo->workers], claim);
+    }
+    if(task < 0)
+    {
+        __atomic_store_n(claim, -1, __ATOMIC_RELEASE);
+    }
+    return task;
+}
+
+// Function to check whether the task a dead worker claimed is lost: it left the queue and no other worker claims it
+// A claim is recorded before the dequeue, so the dead worker may have died before taking it, or another worker
+// may have taken it since, then it is still run
+static int is_runner_task_lost(RunnerInfo *runInfo, int dead, int task)
+{
+    for(int w = 0; w < runInfo->workers; w++)
+    {
+        unsigned long long queue = __atomic_load_n(&runInfo->shared->queues[w], __ATOMIC_SEQ_CST);
+        if((unsigned long long)task >= queue >> 32 && (unsigned long long)task < (queue & 0xFFFFFFFF))
+        {
+            return 0;
+        }
+    }
+    for(int w = 0; w < runInfo->workers; w++)
+    {
+        if(w != dead && __atomic_load_n(&runInfo->shared->current[w], __ATOMIC_SEQ_CST) == task)
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// Function to run one job with the encode/decode core
+Status run_runner_job(RunnerJob *job)
+{
+    Status ret = e_failure;
+
+    // STEP1: Encode job, same argument reader and steps as ./a.out -e
+    if(strcmp(job->argv[1], "-e") == 0)
+    {
+        EncodeInfo encInfo;
+        memset(&encInfo, 0, sizeof(encInfo));
+        if(read_and_validate_encode_args(job->argc, job->argv, &encInfo) == e_success)
+        {
+            ret = do_encoding(&encInfo);
+        }
+        if(encInfo.fptr_secret) fclose(encInfo.fptr_secret);
+        if(encInfo.fptr_src_image) fclose(encInfo.fptr_src_image);
+        if(encInfo.fptr_stego_image && fclose(encInfo.fptr_stego_image) != 0) ret = e_failure;
+    }
+    // STEP2: Decode job, same argument reader and steps as ./a.out -d
+    else
+    {
+        DecodeInfo decInfo;
+        memset(&decInfo, 0, sizeof(decInfo));
+        if(read_and_validate_decode_args(job->argc, job->argv, &decInfo) == e_success)
+        {
+            ret = do_decoding(&decInfo);
+        }
+        if(decInfo.fptr_enc_image) fclose(decInfo.fptr_enc_image);
+        if(decInfo.fptr_secret && fclose(decInfo.fptr_secret) != 0) ret = e_failure;
+    }
+    return ret;
+}
+
+// Microseconds from start to now
+static long get_elapsed_us(struct timespec *start)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) * 1000000L + (now.tv_nsec - start->tv_nsec) / 1000;
+}
+
+// Function to add a finished job to the result ring, only the first status of a job counts
+static void finish_runner_job(RunnerInfo *runInfo, int job, int status, int worker)
+{
+    int pending = RUNNER_PENDING;
+
+    if(__atomic_compare_exchange_n(&runInfo->results[job].status, &pending, status, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+    {
+        runInfo->results[job].worker = worker;
+        runInfo->results[job].latency_us = get_elapsed_us(&runInfo->start);
+        runInfo->done_ring[__atomic_fetch_add(&runInfo->shared->done_count, 1, __ATOMIC_ACQ_REL)] = job;
+    }
+}
+
+// Worker process, runs tasks until every slice is empty, never returns
+static void run_worker(RunnerInfo *runInfo, int worker)
+{
+    struct timespec start;
+    int task;
+
+    // Step messages of many workers would interleave, only the coordinator prints
+    step_delay = 0;
+    if(freopen("/dev/null", "w", stdout) == NULL)
+    {
+        _exit(1);
+    }
+
+    while((task = next_runner_task(runInfo, worker)) >= 0)
+    {
+        int job = runInfo->tasks[task].job;
+        RunnerResult *result = &runInfo->results[job];
+
+        // A chunked job is done when its last chunk is, every task starts a new memory budget
+        reset_admission();
+        progress.job_id = runInfo->jobs[job].line_number;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        long heap_allocs = pool.heap_allocs;
+        Status ret = runInfo->jobs[job].chunks > 1 ? run_encode_chunk(&runInfo->jobs[job], runInfo->tasks[task].chunk)
+                                                   : run_runner_job(&runInfo->jobs[job]);
+        release_job_memory();
+        __atomic_fetch_add(&result->elapsed_us, get_elapsed_us(&start), __ATOMIC_RELAXED);
+        __atomic_fetch_add(&result->heap_allocs, pool.heap_allocs - heap_allocs, __ATOMIC_RELAXED);
+        if(ret == e_failure)
+        {
+            __atomic_store_n(&result->chunk_failed, 1, __ATOMIC_RELEASE);
+        }
+        if(__atomic_sub_fetch(&result->chunks_left, 1, __ATOMIC_ACQ_REL) == 0)
+        {
+            finish_runner_job(runInfo, job, __atomic_load_n(&result->chunk_failed, __ATOMIC_ACQUIRE) ? RUNNER_FAILED : RUNNER_OK, worker);
+        }
+        __atomic_store_n(&runInfo->shared->current[worker], -1, __ATOMIC_RELEASE);
+    }
+    // _exit, the atexit handler and stdio buffers belong to the coordinator
+    _exit(0);
+}
+
+// Function to fork one worker
+static Status start_worker(RunnerInfo *runInfo, int worker)
+{
+    fflush(stdout);
+    pid_t pid = fork();
+    if(pid < 0)
+    {
+        perror("fork");
+        return e_failure;
+    }
+    if(pid == 0)
+    {
+        run_worker(runInfo, worker);
+    }
+    runInfo->pids[worker] = pid;
+    return e_success;
+}
+
+// Function to fork the workers, restart crashed ones and report every job
+Status do_running(RunnerInfo *runInfo)
+{
+    int running = 0, ok = 0, failed = 0, crashed = 0, allocating = 0;
+    long heap_allocs = 0;
+    int status;
+    pid_t pid;
+
+    // STEP1: Load the manifest
+    if(load_runner_manifest(runInfo) == e_failure)
+    {
+        printf("INFO: The manifest could not be loaded!\n\n");
+        return e_failure;
+    }
+
+    // STEP2: Shared memory for the queue, results and result ring, inherited by every fork
+    runInfo->shared = mmap(NULL, sizeof(RunnerShared), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    runInfo->results = mmap(NULL, runInfo->job_count * sizeof(RunnerResult), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    runInfo->done_ring = mmap(NULL, runInfo->job_count * sizeof(int), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if(runInfo->shared == MAP_FAILED || runInfo->results == MAP_FAILED || runInfo->done_ring == MAP_FAILED)
+    {
+        perror("mmap");
+        return e_failure;
+    }
+
+    // STEP3: Split and order the jobs by cost, at most one worker per task
+    if(build_task_order(runInfo) == e_failure)
+    {
+        return e_failure;
+    }
+    for(int i = 0; i < runInfo->job_count; i++)
+    {
+        runInfo->results[i].chunks_left = runInfo->jobs[i].chunks;
+    }
+
+    // STEP4: Worker w owns the tasks build_task_order() dealt to it, the same split as below
+    for(int w = 0; w < runInfo->workers; w++)
+    {
+        unsigned long long head = 0, tail;
+        for(int v = 0; v < w; v++)
+        {
+            head += (runInfo->task_count - v + runInfo->workers - 1) / runInfo->workers;
+        }
+        tail = head + (runInfo->task_count - w + runInfo->workers - 1) / runInfo->workers;
+        runInfo->shared->queues[w] = (head << 32) | tail;
+        runInfo->shared->current[w] = -1;
+    }
+    printf("INFO: %d jobs (%d tasks) from %s on %d workers.\n\n", runInfo->job_count, runInfo->task_count,
+           runInfo->manifest_fname, runInfo->workers);
+
+    // STEP5: Fork the workers
+    clock_gettime(CLOCK_MONOTONIC, &runInfo->start);
+    for(int w = 0; w < runInfo->workers; w++)
+    {
+        if(start_worker(runInfo, w) == e_success)
+        {
+            running++;
+        }
+    }
+
+    // STEP6: Reap workers, a worker killed in the middle of a task loses only that task's job
+    while(running > 0 && (pid = wait(&status)) > 0)
+    {
+        int w = 0;
+        while(w < runInfo->workers && runInfo->pids[w] != pid)
+        {
+            w++;
+        }
+        if(w == runInfo->workers)
+        {
+            continue;
+        }
+        running--;
+        if(WIFEXITED(status) && WEXITSTATUS(status) == 0)
+        {
+            continue;
+        }
+
+        int task = __atomic_load_n(&runInfo->shared->current[w], __ATOMIC_ACQUIRE);
+        if(task >= 0 && is_runner_task_lost(runInfo, w, task))
+        {
+            finish_runner_job(runInfo, runInfo->tasks[task].job, RUNNER_CRASHED, w);
+        }
+        runInfo->shared->current[w] = -1;
+
+        // Every restart follows a lost job or a failed start, so restarts are bounded
+        if(runInfo->restarts < runInfo->job_count + runInfo->workers && start_worker(runInfo, w) == e_success)
+        {
+            runInfo->restarts++;
+            running++;
+        }
+    }
+
+    // STEP7: Report the jobs in the order they finished, then the latency of every size class
+    printf("%-8s %6s %12s %12s %6s %6s %6s  %s\n", "STATUS", "LINE", "TIME_MS", "LATENCY_MS", "CHUNKS", "WORKER", "ALLOCS", "JOB");
+    for(int i = 0; i < runInfo->shared->done_count; i++)
+    {
+        int job = runInfo->done_ring[i];
+        RunnerResult *result = &runInfo->results[job];
+        printf("%-8s %6d %12.3f %12.3f %6d %6d %6ld  %s %s\n",
+               result->status == RUNNER_OK ? "ok" : result->status == RUNNER_FAILED ? "FAILED" : "CRASHED",
+               runInfo->jobs[job].line_number, result->elapsed_us / 1000.0, result->latency_us / 1000.0,
+               runInfo->jobs[job].chunks, result->worker, result->heap_allocs,
+               runInfo->jobs[job].argv[1], runInfo->jobs[job].argv[2]);
+    }
+    for(int job = 0; job < runInfo->job_count; job++)
+    {
+        ok += runInfo->results[job].status == RUNNER_OK;
+        failed += runInfo->results[job].status == RUNNER_FAILED;
+        crashed += runInfo->results[job].status == RUNNER_CRASHED;
+        allocating += runInfo->results[job].heap_allocs > 0;
+        heap_allocs += runInfo->results[job].heap_allocs;
+    }
+    printf("INFO: %d of %d jobs succeeded, %d failed, %d crashed, %d workers restarted.\n",
+           ok, runInfo->job_count, failed, crashed, runInfo->restarts);
+    printf("INFO: %ld heap allocations in %d jobs, the other %d ran on pooled memory.\n",
+           heap_allocs, allocating, runInfo->job_count - allocating);
+    print_latency_report(runInfo);
+    return ok == runInfo->job_count ? e_success : e_failure;
+}
+
+// Function to free jobs and unmap shared memory
+void clear_runner_info(RunnerInfo *runInfo)
+{
+    for(int i = 0; i < runInfo->job_count; i++)
+    {
+        free(runInfo->jobs[i].line);
+    }
+    if(runInfo->jobs) free(runInfo->jobs);
+    if(runInfo->tasks) free(runInfo->tasks);
+    if(runInfo->shared && runInfo->shared != MAP_FAILED) munmap(runInfo->shared, sizeof(RunnerShared));
+    if(runInfo->results && runInfo->results != MAP_FAILED) munmap(runInfo->results, runInfo->job_count * sizeof(RunnerResult));
+    if(runInfo->done_ring && runInfo->done_ring != MAP_FAILED) munmap(runInfo->done_ring, runInfo->job_count * sizeof(int));
+}
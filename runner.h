@@ -0,0 +1,115 @@
+#ifndef RUNNER_H
+#define RUNNER_H
+
+#include <sys/types.h>
+#include <time.h>
+#include "types.h" // Contains user defined types
+
+/*
+ * Structure to store information required for
+ * running a manifest of encode/decode jobs in forked worker processes
+ *
+ * Manifest line: the arguments after ./a.out, separated by tabs
+ * (-e<TAB>cover.bmp<TAB>secret.txt<TAB>stego.bmp, as written by -p)
+ *
+ * Jobs are split into tasks and ordered by the scheduler (scheduler.h).
+ * Each worker owns a slice of the task queue in shared memory and takes
+ * tasks from its head, an idle worker steals from the tail of another
+ * slice. A crashed worker's job is marked crashed and the worker is
+ * forked again. Every worker keeps its buffer pool and job arena
+ * (pool.h) across tasks, the report counts the heap allocations of each
+ */
+
+#define RUNNER_MAX_WORKERS 64
+#define RUNNER_MAX_LINE 4096
+#define RUNNER_MAX_ARGS 8
+
+/* Job result status */
+#define RUNNER_PENDING 0
+#define RUNNER_OK 1
+#define RUNNER_FAILED 2
+#define RUNNER_CRASHED 3
+
+typedef struct _RunnerJob
+{
+    char *line;                 // Manifest line, tabs replaced by '\0'
+    int line_number;            // Line number in the manifest
+    int argc;
+    char *argv[RUNNER_MAX_ARGS + 3];   // "./a.out", operation, arguments, NULL
+
+    /* Scheduling Info, see scheduler.h */
+    long long cost;             // Image and secret bytes the job touches
+    int size_class;             // 0 small, 1 medium, 2 large
+    int chunks;                 // Tasks the job is split into
+    long file_size;             // Carrier file size (chunked jobs)
+    long secret_size;           // Secret file size (chunked jobs)
+    char stream_header[32];     // Stream bytes before the data (chunked jobs)
+    long header_size;
+
+} RunnerJob;
+
+typedef struct _RunnerResult
+{
+    int status;                 // RUNNER_PENDING, RUNNER_OK, RUNNER_FAILED or RUNNER_CRASHED
+    int worker;                 // Worker that finished the job
+    long elapsed_us;            // Wall time of the job, summed over its chunks
+    long heap_allocs;           // Heap allocations of the worker's pool and arena during the job
+    long latency_us;            // Batch start to job done
+    int chunks_left;            // Chunks not finished yet
+    int chunk_failed;           // A chunk of the job failed
+
+} RunnerResult;
+
+/* Lives in shared memory, written by every worker */
+typedef struct _RunnerShared
+{
+    unsigned long long queues[RUNNER_MAX_WORKERS];  // Task slice of each worker, head << 32 | tail
+    int current[RUNNER_MAX_WORKERS];                // Task being run by each worker, -1 if none
+    int done_count;                                 // Jobs written to the result ring
+
+} RunnerShared;
+
+typedef struct _RunnerInfo
+{
+    /* Manifest Info */
+    char *manifest_fname;       // Manifest file name
+    RunnerJob *jobs;
+    int job_count;
+    struct _SchedTask *tasks;   // Chunks of every job, in queue order
+    int task_count;
+    struct timespec start;      // Batch start, for latencies
+
+    /* Worker Info */
+    int workers;                // Number of worker processes
+    pid_t pids[RUNNER_MAX_WORKERS];
+    int restarts;               // Workers forked again after a crash
+
+    /* Shared memory */
+    RunnerShared *shared;
+    RunnerResult *results;      // One result per job
+    int *done_ring;             // Jobs in the order they finished
+
+} RunnerInfo;  // Datatype of the structure
+
+
+/* Runner function prototype */
+
+/* Read and validate runner args from argv */
+Status read_and_validate_runner_args(int argc, char *argv[], RunnerInfo *runInfo);
+
+/* Read the manifest into jobs */
+Status load_runner_manifest(RunnerInfo *runInfo);
+
+/* Take the next task of a worker, stealing from other workers when its own slice is empty */
+int next_runner_task(RunnerInfo *runInfo, int worker);
+
+/* Run one job with the encode/decode core */
+Status run_runner_job(RunnerJob *job);
+
+/* Fork the workers, restart crashed ones and report every job */
+Status do_running(RunnerInfo *runInfo);
+
+/* Free jobs and unmap shared memory */
+void clear_runner_info(RunnerInfo *runInfo);
+
+#endif
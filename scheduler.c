@@ -0,0 +1,293 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+// User-defined header files
+#include "scheduler.h"
+#include "runner.h"
+#include "encode.h"
+#include "lsb_kernel.h"
+#include "progress.h"
+#include "probes.h"
+#include "pool.h"
+#include "types.h"
+#include "common.h"
+
+// Image bytes per chunk, SCHED_CHUNK_SIZE unless the self-test makes it small to cross chunk boundaries
+long sched_chunk_size = SCHED_CHUNK_SIZE;
+
+/* Function Definitions */
+
+// Function to estimate the cost of a job: image bytes from the carrier header plus secret bytes
+long long estimate_job_cost(RunnerJob *job)
+{
+    struct stat st;
+    long long cost = 0;
+
+    // STEP1: Image bytes, an unreadable carrier costs nothing (the job fails at once)
+    FILE *fptr_image = fopen(job->argv[2], "r");
+    if(fptr_image == NULL)
+    {
+        return 0;
+    }
+    cost = get_image_size_for_bmp(fptr_image) + 54LL;
+    fclose(fptr_image);
+
+    // STEP2: Encode also reads the secret
+    if(strcmp(job->argv[1], "-e") == 0 && stat(job->argv[3], &st) == 0)
+    {
+        cost += st.st_size;
+    }
+    return cost;
+}
+
+// Function to find the size class of a cost
+int get_size_class(long long cost)
+{
+    return cost < SCHED_MEDIUM_COST ? 0 : cost < SCHED_LARGE_COST ? 1 : 2;
+}
+
+// Function to split a large plain encode into chunks, checks what do_encoding() would check first
+Status plan_job_chunks(RunnerJob *job)
+{
+    struct stat st;
+
+    // STEP1: Only -e cover.bmp secret.txt stego.bmp, options keep the normal path
+    job->chunks = 1;
+    if(job->size_class < 2 || job->argc != 5 || strcmp(job->argv[1], "-e") != 0 ||
+       !strstr(job->argv[2], ".bmp") || !strstr(job->argv[3], ".txt") || !strstr(job->argv[4], ".bmp") ||
+       job->argv[4][0] == '-' || stat(job->argv[3], &st) != 0 || st.st_size == 0)
+    {
+        return e_failure;
+    }
+
+    // STEP2: Capacity, as check_capacity() computes it
+    FILE *fptr_src_image = fopen(job->argv[2], "r");
+    if(fptr_src_image == NULL)
+    {
+        return e_failure;
+    }
+    uint image_capacity = get_image_size_for_bmp(fptr_src_image);
+    job->file_size = get_file_size(fptr_src_image);
+    fclose(fptr_src_image);
+    const char *extn = get_secret_extension(job->argv[3]);
+    if(strlen(extn) >= MAX_FILE_SUFFIX + 1 || image_capacity <= get_encoded_size(strlen(extn), st.st_size) ||
+       job->file_size < 54 + (long)image_capacity)
+    {
+        return e_failure;
+    }
+
+    // STEP3: Stream header once, chunks read the data straight from the secret
+    job->secret_size = st.st_size;
+    job->header_size = build_stream_header(job->stream_header, extn, st.st_size);
+
+    // STEP4: Create the stego image at its final size, chunks write their ranges in place
+    int fd = open(job->argv[4], O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if(fd < 0)
+    {
+        perror("open");
+        fprintf(stderr, "ERROR: Unable to open file %s\n", job->argv[4]);
+        return e_failure;
+    }
+    if(ftruncate(fd, job->file_size) != 0)
+    {
+        close(fd);
+        return e_failure;
+    }
+    close(fd);
+    job->chunks = (job->file_size - 54 + sched_chunk_size - 1) / sched_chunk_size;
+    return e_success;
+}
+
+// Compare tasks by key, then by job so chunks of one job stay in order
+static int compare_task_key(const void *a, const void *b)
+{
+    const SchedTask *x = a, *y = b;
+    if(x->key != y->key)
+    {
+        return x->key < y->key ? -1 : 1;
+    }
+    if(x->job != y->job)
+    {
+        return x->job - y->job;
+    }
+    return x->chunk - y->chunk;
+}
+
+// Function to build the tasks of every job, ordered by key and dealt out to the worker slices
+Status build_task_order(RunnerInfo *runInfo)
+{
+    int count = 0;
+
+    // STEP1: Cost, size class and chunks of every job
+    for(int i = 0; i < runInfo->job_count; i++)
+    {
+        RunnerJob *job = &runInfo->jobs[i];
+        job->cost = estimate_job_cost(job);
+        job->size_class = get_size_class(job->cost);
+        plan_job_chunks(job);
+        count += job->chunks;
+    }
+
+    // STEP2: One task per chunk, keyed by the work done once it finishes
+    SchedTask *tasks = malloc(count * sizeof(SchedTask));
+    runInfo->tasks = malloc(count * sizeof(SchedTask));
+    if(!tasks || !runInfo->tasks)
+    {
+        free(tasks);
+        return e_failure;
+    }
+    runInfo->task_count = 0;
+    for(int i = 0; i < runInfo->job_count; i++)
+    {
+        RunnerJob *job = &runInfo->jobs[i];
+        for(int c = 0; c < job->chunks; c++)
+        {
+            SchedTask *task = &tasks[runInfo->task_count++];
+            task->job = i;
+            task->chunk = c;
+            task->key = job->chunks > 1 ? (c + 1) * (long long)sched_chunk_size : job->cost;
+        }
+    }
+    qsort(tasks, count, sizeof(SchedTask), compare_task_key);
+
+    // STEP3: Deal round robin, so every worker slice is in key order and as cheap as the others
+    if(runInfo->workers > count)
+    {
+        runInfo->workers = count;
+    }
+    int next = 0;
+    for(int w = 0; w < runInfo->workers; w++)
+    {
+        for(int t = w; t < count; t += runInfo->workers)
+        {
+            runInfo->tasks[next++] = tasks[t];
+        }
+    }
+    free(tasks);
+    return e_success;
+}
+
+// Function to encode image range [lo, hi) of a chunked job in place
+Status run_encode_chunk(RunnerJob *job, int chunk)
+{
+    char *image = get_pool_buffer(POOL_IO_BUFFER_SIZE);
+    char *stream = get_pool_buffer(POOL_IO_BUFFER_SIZE / 8);
+    long stream_end = 54 + 8 * (job->header_size + job->secret_size);
+    Status ret = e_success;
+
+    // STEP1: Chunk c covers [54 + c * size, 54 + (c + 1) * size), chunk 0 also the header
+    long lo = 54 + chunk * sched_chunk_size;
+    long hi = lo + sched_chunk_size < job->file_size ? lo + sched_chunk_size : job->file_size;
+    start_progress_job(job->argv[4]);
+    start_progress_stage("chunk", hi - lo);
+    int fd_src = open(job->argv[2], O_RDONLY);
+    int fd_secret = open(job->argv[3], O_RDONLY);
+    int fd_stego = open(job->argv[4], O_WRONLY);
+    if(!image || !stream || fd_src < 0 || fd_secret < 0 || fd_stego < 0)
+    {
+        ret = e_failure;
+    }
+    if(ret == e_success && chunk == 0 &&
+       (pread(fd_src, image, 54, 0) != 54 || pwrite(fd_stego, image, 54, 0) != 54))
+    {
+        ret = e_failure;
+    }
+
+    // STEP2: Block by block, every block starts on a stream byte since lo - 54 is a multiple of 8
+    for(long pos = lo; ret == e_success && pos < hi; pos += POOL_IO_BUFFER_SIZE)
+    {
+        long size = hi - pos < POOL_IO_BUFFER_SIZE ? hi - pos : POOL_IO_BUFFER_SIZE;
+        PROBE4(io__submit, progress.job_id, PROBE_IO_READ, pos, size);
+        long done = pread(fd_src, image, size, pos);
+        PROBE4(io__complete, progress.job_id, PROBE_IO_READ, pos, done);
+        if(done != size)
+        {
+            ret = e_failure;
+            break;
+        }
+
+        // STEP3: Stream bytes of this block come from the header, then the secret data
+        if(pos < stream_end)
+        {
+            long first = (pos - 54) / 8;
+            long count = ((pos + size < stream_end ? pos + size : stream_end) - pos) / 8;
+            long i = 0;
+            for(; i < count && first + i < job->header_size; i++)
+            {
+                stream[i] = job->stream_header[first + i];
+            }
+            if(i < count && pread(fd_secret, stream + i, count - i, first + i - job->header_size) != count - i)
+            {
+                ret = e_failure;
+                break;
+            }
+            PROBE3(embed__enter, progress.job_id, first - job->header_size, count);
+            encode_bytes_to_lsb(stream, count, image);
+            PROBE3(embed__leave, progress.job_id, first - job->header_size, count);
+        }
+
+        // STEP4: Write the block at the same offset
+        PROBE4(io__submit, progress.job_id, PROBE_IO_WRITE, pos, size);
+        done = pwrite(fd_stego, image, size, pos);
+        PROBE4(io__complete, progress.job_id, PROBE_IO_WRITE, pos, done);
+        if(done != size)
+        {
+            ret = e_failure;
+        }
+        if(report_progress(pos + size - lo) == e_failure)
+        {
+            ret = e_failure;
+        }
+    }
+
+    if(fd_src >= 0) close(fd_src);
+    if(fd_secret >= 0) close(fd_secret);
+    if(fd_stego >= 0) close(fd_stego);
+    put_pool_buffer(image);
+    put_pool_buffer(stream);
+    finish_progress_job(ret);
+    return ret;
+}
+
+// Compare latencies, smallest first
+static int compare_latency(const void *a, const void *b)
+{
+    long x = *(const long *)a, y = *(const long *)b;
+    return x < y ? -1 : x > y;
+}
+
+// Function to print p50, p99 and max latency (batch start to job done) of every size class
+void print_latency_report(RunnerInfo *runInfo)
+{
+    const char *names[SCHED_SIZE_CLASSES] = { "small", "medium", "large" };
+    long *latencies = malloc(runInfo->job_count * sizeof(long));
+    if(!latencies)
+    {
+        return;
+    }
+
+    printf("%-8s %6s %12s %12s %12s\n", "CLASS", "JOBS", "P50_MS", "P99_MS", "MAX_MS");
+    for(int size_class = 0; size_class < SCHED_SIZE_CLASSES; size_class++)
+    {
+        int count = 0;
+        for(int i = 0; i < runInfo->job_count; i++)
+        {
+            if(runInfo->jobs[i].size_class == size_class && runInfo->results[i].status != RUNNER_PENDING)
+            {
+                latencies[count++] = runInfo->results[i].latency_us;
+            }
+        }
+        if(count == 0)
+        {
+            continue;
+        }
+        qsort(latencies, count, sizeof(long), compare_latency);
+        printf("%-8s %6d %12.3f %12.3f %12.3f\n", names[size_class], count,
+               latencies[(count - 1) / 2] / 1000.0, latencies[(count * 99 + 99) / 100 - 1] / 1000.0,
+               latencies[count - 1] / 1000.0);
+    }
+    free(latencies);
+}
@@ -0,0 +1,56 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include "types.h" // Contains user defined types
+#include "runner.h"
+
+/*
+ * Size-aware ordering of runner jobs
+ *
+ * Cost of a job is the image bytes it touches, read from the carrier
+ * header, plus the secret size (the inputs check_capacity() uses).
+ * A plain encode costing SCHED_LARGE_COST or more is split into image
+ * ranges of sched_chunk_size bytes that different workers run in place.
+ * Every task is keyed by the work done once it finishes (chunk c of a
+ * large job: (c + 1) * chunk cost), so small jobs are interleaved with
+ * the first chunks of large ones instead of waiting behind all of them
+ */
+
+#define SCHED_CHUNK_SIZE (16L << 20)    // Image bytes per chunk of a large encode
+#define SCHED_LARGE_COST (64LL << 20)   // Jobs costing this much or more are chunked
+#define SCHED_MEDIUM_COST (1LL << 20)   // Small < 1 MiB <= medium < 64 MiB <= large
+#define SCHED_SIZE_CLASSES 3
+
+typedef struct _SchedTask
+{
+    int job;                    // Index of the job in RunnerInfo
+    int chunk;                  // Chunk of the job, 0 for unchunked jobs
+    long long key;              // Work done when the task finishes, smallest first
+
+} SchedTask;
+
+/* Image bytes per chunk, a multiple of 8 so every chunk starts on a stream byte */
+extern long sched_chunk_size;
+
+
+/* Scheduler function prototype */
+
+/* Estimate the cost of a job from the carrier header and secret size */
+long long estimate_job_cost(RunnerJob *job);
+
+/* Size class of a cost: 0 small, 1 medium, 2 large */
+int get_size_class(long long cost);
+
+/* Split a large plain encode into chunks, creates the output at its final size */
+Status plan_job_chunks(RunnerJob *job);
+
+/* Build the tasks of every job, ordered by key and dealt out to the worker slices (at most one worker per task) */
+Status build_task_order(RunnerInfo *runInfo);
+
+/* Encode one image range of a chunked job in place */
+Status run_encode_chunk(RunnerJob *job, int chunk);
+
+/* Print p50, p99 and max latency of every size class */
+void print_latency_report(RunnerInfo *runInfo);
+
+#endif
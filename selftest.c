@@ -0,0 +1,653 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+// User-defined header files
+#include "selftest.h"
+#include "encode.h"
+#include "decode.h"
+#include "append.h"
+#include "broadcast.h"
+#include "lsb_kernel.h"
+#include "fec.h"
+#include "lsb_mode.h"
+#include "runner.h"
+#include "scheduler.h"
+#include "types.h"
+#include "common.h"
+
+/* Function Definitions */
+
+/*
+ * An engine writes the 4 byte size field and the payload into a copy of
+ * the cover, starting skip bytes after the 54 byte header
+ */
+typedef Status (*SelfTestEngineFn)(const char *cover, long image_size, long skip,
+                                   const char *payload, long size, char *stego);
+
+typedef struct _SelfTestEngine
+{
+    const char *name;
+    SelfTestEngineFn encode;
+} SelfTestEngine;
+
+// Function to get the next pseudo random number (xorshift64*)
+static unsigned long long get_random(SelfTestInfo *testInfo)
+{
+    testInfo->state ^= testInfo->state >> 12;
+    testInfo->state ^= testInfo->state << 25;
+    testInfo->state ^= testInfo->state >> 27;
+    return testInfo->state * 2685821657736338717ULL;
+}
+
+// Function to get a pseudo random number in [0, limit)
+static long get_random_below(SelfTestInfo *testInfo, long limit)
+{
+    return limit > 0 ? (long)(get_random(testInfo) % (unsigned long long)limit) : 0;
+}
+
+// Function to build a 24 bpp bmp of random size with random, gradient or flat pixels
+static char *make_random_bmp(SelfTestInfo *testInfo, long *image_size)
+{
+    uint width = 1 + get_random_below(testInfo, SELFTEST_MAX_WIDTH);
+    uint height = 1 + get_random_below(testInfo, SELFTEST_MAX_HEIGHT);
+    long pixels = (long)width * height * 3;
+
+    *image_size = 54 + pixels;
+    char *image = calloc(*image_size, 1);
+    if(!image)
+    {
+        return NULL;
+    }
+
+    // Header fields read by get_image_size_for_bmp() and the bmp viewers
+    image[0] = 'B';
+    image[1] = 'M';
+    put_stream_uint(image + 2, *image_size);
+    put_stream_uint(image + 10, 54);
+    put_stream_uint(image + 14, 40);
+    put_stream_uint(image + 18, width);
+    put_stream_uint(image + 22, height);
+    image[26] = 1;
+    image[28] = 24;
+
+    long mode = get_random_below(testInfo, 3);
+    for(long i = 0; i < pixels; i++)
+    {
+        if(mode == 0)
+        {
+            image[54 + i] = get_random(testInfo) & 0xFF;
+        }
+        else if(mode == 1)
+        {
+            image[54 + i] = (i / 3) & 0xFF;
+        }
+        else
+        {
+            image[54 + i] = (char)0xFF;
+        }
+    }
+    return image;
+}
+
+// Reference encoder, the per byte functions straight on the image buffer
+static void reference_encode(char *stego, long skip, const char *payload, long size)
+{
+    char *image_buffer = stego + 54 + skip;
+
+    encode_size_to_lsb(size, image_buffer);
+    for(long i = 0; i < size; i++)
+    {
+        encode_byte_to_lsb(payload[i], image_buffer + 32 + i * 8);
+    }
+}
+
+// Function to copy bytes between two files
+static Status copy_selftest_bytes(FILE *fptr_src, FILE *fptr_dest, long size)
+{
+    char arr[MAX_BLOCK_SIZE];
+
+    while(size > 0)
+    {
+        long block = size < MAX_BLOCK_SIZE ? size : MAX_BLOCK_SIZE;
+        if(fread(arr, 1, block, fptr_src) != (size_t)block || fwrite(arr, 1, block, fptr_dest) != (size_t)block)
+        {
+            return e_failure;
+        }
+        size -= block;
+    }
+    return e_success;
+}
+
+// Stream engine, encode_block_to_image() from a source file to a destination file
+static Status stream_engine(const char *cover, long image_size, long skip, const char *payload, long size, char *stego)
+{
+    FILE *fptr_src = tmpfile();
+    FILE *fptr_dest = tmpfile();
+    Status ret = e_failure;
+    char field[4];
+
+    put_stream_uint(field, size);
+    if(fptr_src && fptr_dest && fwrite(cover, 1, image_size, fptr_src) == (size_t)image_size)
+    {
+        rewind(fptr_src);
+        if(copy_selftest_bytes(fptr_src, fptr_dest, 54 + skip) == e_success &&
+           encode_block_to_image(field, 4, fptr_src, fptr_dest) == e_success &&
+           encode_block_to_image(payload, size, fptr_src, fptr_dest) == e_success &&
+           copy_selftest_bytes(fptr_src, fptr_dest, image_size - ftell(fptr_src)) == e_success)
+        {
+            rewind(fptr_dest);
+            ret = fread(stego, 1, image_size, fptr_dest) == (size_t)image_size ? e_success : e_failure;
+        }
+    }
+    if(fptr_src) fclose(fptr_src);
+    if(fptr_dest) fclose(fptr_dest);
+    return ret;
+}
+
+// In place engine, encode_block_in_place() on a single read/write file
+static Status in_place_engine(const char *cover, long image_size, long skip, const char *payload, long size, char *stego)
+{
+    FILE *fptr_image = tmpfile();
+    Status ret = e_failure;
+    char field[4];
+
+    put_stream_uint(field, size);
+    if(fptr_image && fwrite(cover, 1, image_size, fptr_image) == (size_t)image_size)
+    {
+        fseek(fptr_image, 54 + skip, SEEK_SET);
+        if(encode_block_in_place(field, 4, fptr_image) == e_success &&
+           encode_block_in_place(payload, size, fptr_image) == e_success)
+        {
+            rewind(fptr_image);
+            ret = fread(stego, 1, image_size, fptr_image) == (size_t)image_size ? e_success : e_failure;
+        }
+    }
+    if(fptr_image) fclose(fptr_image);
+    return ret;
+}
+
+// Buffer engine, the selected kernel straight on the image buffer
+static Status buffer_engine(const char *cover, long image_size, long skip, const char *payload, long size, char *stego)
+{
+    char field[4];
+
+    put_stream_uint(field, size);
+    memcpy(stego, cover, image_size);
+    encode_bytes_to_lsb(field, 4, stego + 54 + skip);
+    encode_bytes_to_lsb(payload, size, stego + 54 + skip + 32);
+    return e_success;
+}
+
+// Plane engine, the payload pre-expanded into a 0/1 plane and applied with apply_lsb_plane()
+static Status plane_engine(const char *cover, long image_size, long skip, const char *payload, long size, char *stego)
+{
+    char *plane = calloc((size + 4) * 8 + 1, 1);
+    char field[4];
+
+    if(!plane)
+    {
+        return e_failure;
+    }
+    put_stream_uint(field, size);
+    encode_bytes_to_lsb(field, 4, plane);
+    encode_bytes_to_lsb(payload, size, plane + 32);
+    memcpy(stego, cover, image_size);
+    apply_lsb_plane(stego + 54 + skip, plane, (size + 4) * 8);
+    free(plane);
+    return e_success;
+}
+
+// Function to create a temporary file from template with size bytes of data, grown to file_size, returns its descriptor
+static int make_selftest_file(char *template, const char *data, long size, long file_size)
+{
+    int fd = mkstemp(template);
+    if(fd < 0)
+    {
+        return -1;
+    }
+    if((size > 0 && write(fd, data, size) != size) || ftruncate(fd, file_size) != 0)
+    {
+        close(fd);
+        unlink(template);
+        return -1;
+    }
+    return fd;
+}
+
+// Function to close and remove a temporary file made by make_selftest_file()
+static void remove_selftest_file(int fd, const char *name)
+{
+    if(fd >= 0)
+    {
+        close(fd);
+        unlink(name);
+    }
+}
+
+// Chunk engine, run_encode_chunk() of the runner on every chunk of sched_chunk_size bytes, last chunk first
+static Status chunk_engine(const char *cover, long image_size, long skip, const char *payload, long size, char *stego)
+{
+    char cover_name[] = "/tmp/selftest_cover_XXXXXX";
+    char secret_name[] = "/tmp/selftest_secret_XXXXXX";
+    char stego_name[] = "/tmp/selftest_stego_XXXXXX";
+    RunnerJob job;
+    Status ret = e_failure;
+
+    // STEP1: Chunks start the stream at byte 54, so it holds the skipped LSBs of the cover, the size field and the payload
+    long bits = skip + 32 + size * 8;
+    long stream_size = (bits + 7) / 8;
+    long file_size = 54 + stream_size * 8 > image_size ? 54 + stream_size * 8 : image_size;
+    char *stream = calloc(stream_size, 1);
+    if(!stream)
+    {
+        return e_failure;
+    }
+    for(long t = 0; t < stream_size * 8; t++)
+    {
+        int bit;
+        if(t < skip || t >= bits)
+        {
+            bit = 54 + t < image_size ? cover[54 + t] & 1 : 0;
+        }
+        else if(t < skip + 32)
+        {
+            bit = ((unsigned long)size >> (t - skip)) & 1;
+        }
+        else
+        {
+            bit = (payload[(t - skip - 32) / 8] >> ((t - skip - 32) % 8)) & 1;
+        }
+        stream[t / 8] |= bit << (t % 8);
+    }
+
+    // STEP2: Cover (padded to whole stream bytes), secret and a stego file of the final size, as plan_job_chunks() leaves them
+    int fd_cover = make_selftest_file(cover_name, cover, image_size, file_size);
+    int fd_secret = make_selftest_file(secret_name, stream, stream_size, stream_size);
+    int fd_stego = make_selftest_file(stego_name, NULL, 0, file_size);
+    if(fd_cover >= 0 && fd_secret >= 0 && fd_stego >= 0)
+    {
+        memset(&job, 0, sizeof(job));
+        job.argv[2] = cover_name;
+        job.argv[3] = secret_name;
+        job.argv[4] = stego_name;
+        job.file_size = file_size;
+        job.secret_size = stream_size;
+        job.header_size = 0;
+        job.chunks = (file_size - 54 + sched_chunk_size - 1) / sched_chunk_size;
+
+        // STEP3: Every chunk in place, in reverse order so none relies on the one before
+        ret = e_success;
+        for(int c = job.chunks - 1; c >= 0 && ret == e_success; c--)
+        {
+            ret = run_encode_chunk(&job, c);
+        }
+        if(ret == e_success && pread(fd_stego, stego, image_size, 0) != image_size)
+        {
+            ret = e_failure;
+        }
+    }
+    remove_selftest_file(fd_cover, cover_name);
+    remove_selftest_file(fd_secret, secret_name);
+    remove_selftest_file(fd_stego, stego_name);
+    free(stream);
+    return ret;
+}
+
+// All engines, each one is run with every kernel this CPU supports
+static const SelfTestEngine selftest_engines[] =
+{
+    {"buffer", buffer_engine},
+    {"stream", stream_engine},
+    {"in-place", in_place_engine},
+    {"plane", plane_engine},
+    {"chunk", chunk_engine},
+    {NULL, NULL}
+};
+
+// Function to decode the reference stego image with the oracle and with every kernel
+static Status check_selftest_decoding(SelfTestInfo *testInfo, const char *stego, long image_size, long skip,
+                                      const char *payload, long size, char *decoded)
+{
+    const char *image_buffer = stego + 54 + skip;
+    long decoded_size;
+    char field[4];
+
+    put_stream_uint(field, size);
+
+    // STEP1: Oracle decode of the size field and the payload
+    decode_size_from_lsb(&decoded_size, (char *)image_buffer);
+    if(decoded_size != size)
+    {
+        printf("ERROR: Reference size field decoded as %ld instead of %ld!\n", decoded_size, size);
+        return e_failure;
+    }
+    for(long i = 0; i < size; i++)
+    {
+        decode_lsb_to_byte(decoded + i, (char *)image_buffer + 32 + i * 8);
+    }
+    if(memcmp(decoded, payload, size) != 0)
+    {
+        printf("ERROR: Reference payload does not round trip!\n");
+        return e_failure;
+    }
+
+    // STEP2: Every kernel through decode_image_to_block() from a file
+    FILE *fptr_image = tmpfile();
+    if(!fptr_image || fwrite(stego, 1, image_size, fptr_image) != (size_t)image_size)
+    {
+        if(fptr_image) fclose(fptr_image);
+        return e_failure;
+    }
+    for(const LsbKernel *kernel = get_lsb_kernel_table(); kernel->name; kernel++)
+    {
+        if(!kernel->supported())
+        {
+            continue;
+        }
+        select_lsb_kernel(kernel->name);
+        memset(decoded, 0, size + 4);
+        fseek(fptr_image, 54 + skip, SEEK_SET);
+        if(decode_image_to_block(decoded, 4 + size, fptr_image) == e_failure ||
+           memcmp(decoded + 4, payload, size) != 0 ||
+           memcmp(decoded, field, 4) != 0)
+        {
+            printf("ERROR: Kernel '%s' decode does not match the reference!\n", kernel->name);
+            fclose(fptr_image);
+            return e_failure;
+        }
+        testInfo->checks++;
+    }
+    fclose(fptr_image);
+    return e_success;
+}
+
+// Function to protect the payload with a random parity, damage it within what the parity fixes,
+// and repair it with every FEC kernel (the scalar kernel gives the reference parity)
+static Status check_selftest_fec(SelfTestInfo *testInfo, const char *payload, long size)
+{
+    FecInfo fec;
+    Status ret = e_success;
+
+    memset(&fec, 0, sizeof(fec));
+    fec.parity = 2 + 2 * get_random_below(testInfo, FEC_MAX_PARITY / 2);
+    fec.data_size = size + 1;
+    fec.columns = get_fec_columns(fec.data_size, fec.parity);
+    long total = fec.columns * FEC_CODEWORD_SIZE;
+    unsigned char *reference = calloc(total, 1);
+    unsigned char *damaged = malloc(total);
+    fec.stream = malloc(total);
+    if(!reference || !damaged || !fec.stream)
+    {
+        free(reference);
+        free(damaged);
+        free(fec.stream);
+        return e_failure;
+    }
+    memcpy(reference, payload, size);
+    reference[size] = 0xA5;
+    const FecKernel *scalar = get_fec_kernel_table();
+    while(strcmp(scalar->name, "scalar") != 0)
+    {
+        scalar++;
+    }
+    memcpy(fec.stream, reference, total);
+    fec_encode(&fec, scalar);
+    memcpy(reference, fec.stream, total);
+
+    // Damage: the tail is cut as erasures, then errors in what is left, 2 * errors + erasures <= parity per codeword
+    long erased_rows = get_random_below(testInfo, fec.parity + 1);
+    long errors = get_random_below(testInfo, (fec.parity - erased_rows) / 2 + 1);
+    memcpy(damaged, reference, total);
+    fec.available = total - erased_rows * fec.columns;
+    memset(damaged + fec.available, 0, total - fec.available);
+    for(long column = 0; column < fec.columns; column++)
+    {
+        for(long e = 0; e < errors; e++)
+        {
+            long row = get_random_below(testInfo, FEC_CODEWORD_SIZE - erased_rows);
+            damaged[row * fec.columns + column] ^= 1 + get_random_below(testInfo, 255);
+        }
+    }
+
+    for(const FecKernel *kernel = get_fec_kernel_table(); kernel->name && ret == e_success; kernel++)
+    {
+        if(!kernel->supported())
+        {
+            continue;
+        }
+        memcpy(fec.stream, reference, total);
+        memset(fec.stream + (FEC_CODEWORD_SIZE - fec.parity) * fec.columns, 0xEE, fec.parity * fec.columns);
+        if(fec_encode(&fec, kernel) == e_failure || memcmp(fec.stream, reference, total) != 0)
+        {
+            printf("ERROR: FEC kernel '%s' parity differs from the reference (parity %d)!\n", kernel->name, fec.parity);
+            ret = e_failure;
+            break;
+        }
+        memcpy(fec.stream, damaged, total);
+        if(fec_decode(&fec, kernel) == e_failure || memcmp(fec.stream, reference, total) != 0)
+        {
+            printf("ERROR: FEC kernel '%s' could not repair %ld errors and %ld erasures per codeword (parity %d)!\n",
+                   kernel->name, errors, erased_rows, fec.parity);
+            ret = e_failure;
+            break;
+        }
+        testInfo->checks++;
+    }
+    free(reference);
+    free(damaged);
+    free(fec.stream);
+    return ret;
+}
+
+// Function to put stream bit s of payload into its channel byte one bit at a time, the reference for the mode kernels
+static void reference_mode_embed(const LsbMode *mode, const char *payload, long size, unsigned char *pixels)
+{
+    int channels = __builtin_popcount(mode->channels);
+
+    for(long s = 0; s < size * 8; s++)
+    {
+        long slot = s / mode->bits;
+        int nth = slot % channels, c = 0;
+        while(nth > 0 || !(mode->channels & (1 << c)))
+        {
+            nth -= (mode->channels >> c) & 1;
+            c++;
+        }
+        unsigned char *byte = pixels + (slot / channels) * mode->pixel_size + c;
+        // MSB first: stream bit 7 of a byte comes first and goes to the high bit of its slot
+        int bit = mode->msb_first ? mode->bits - 1 - s % mode->bits : s % mode->bits;
+        int value = (payload[s / 8] >> (mode->msb_first ? 7 - s % 8 : s % 8)) & 1;
+        *byte = (*byte & ~(1 << bit)) | (value << bit);
+    }
+}
+
+// Function to embed and extract the payload with every mode kernel against the bit by bit reference
+static Status check_selftest_modes(SelfTestInfo *testInfo, const char *cover, long image_size, const char *payload, long size)
+{
+    long pixel_bytes = image_size - 54;
+    unsigned char *reference = malloc(pixel_bytes);
+    char *pixels = malloc(pixel_bytes);
+    char *decoded = malloc(size + 4);
+    Status ret = e_success;
+
+    for(const LsbMode *mode = get_lsb_mode_table(); mode->name && reference && pixels && decoded; mode++)
+    {
+        // Whole groups of the payload that fit the cover
+        long groups = size / mode->group_bytes;
+        long fit = pixel_bytes / (mode->group_pixels * mode->pixel_size);
+        groups = groups < fit ? groups : fit;
+
+        memcpy(reference, cover + 54, pixel_bytes);
+        memcpy(pixels, cover + 54, pixel_bytes);
+        reference_mode_embed(mode, payload, groups * mode->group_bytes, reference);
+        mode->embed(payload, groups, pixels);
+        mode->extract(decoded, groups, pixels);
+        if(memcmp(pixels, reference, pixel_bytes) != 0 || memcmp(decoded, payload, groups * mode->group_bytes) != 0)
+        {
+            printf("ERROR: LSB mode kernel '%s' differs from the reference (%ld groups)!\n", mode->name, groups);
+            ret = e_failure;
+            break;
+        }
+
+        // The bit by bit extract --verify uses must read the reference image back too
+        extract_lsb_mode_reference(mode, decoded, groups, (const char *)reference);
+        if(memcmp(decoded, payload, groups * mode->group_bytes) != 0)
+        {
+            printf("ERROR: Reference extract of LSB mode '%s' does not read the payload back (%ld groups)!\n", mode->name, groups);
+            ret = e_failure;
+            break;
+        }
+        testInfo->checks++;
+    }
+    if(!reference || !pixels || !decoded)
+    {
+        ret = e_failure;
+    }
+    free(reference);
+    free(pixels);
+    free(decoded);
+    return ret;
+}
+
+// Function to run one random image and payload through every engine and kernel
+static Status run_selftest_iteration(SelfTestInfo *testInfo, long iteration)
+{
+    long image_size;
+    Status ret = e_success;
+
+    // STEP1: Random cover, random alignment (skip) and random payload that fits
+    char *cover = make_random_bmp(testInfo, &image_size);
+    long skip = get_random_below(testInfo, 64);
+    long capacity = (image_size - 54 - skip) / 8 - 4;
+    if(capacity < 0)
+    {
+        skip = 0;
+        capacity = (image_size - 54) / 8 - 4;
+    }
+    long size = capacity > 0 ? get_random_below(testInfo, get_random_below(testInfo, 2) ? capacity + 1 : 65) : 0;
+    if(size > capacity)
+    {
+        size = capacity < 0 ? 0 : capacity;
+    }
+
+    char *payload = malloc(size + 1);
+    char *reference = malloc(image_size);
+    char *stego = malloc(image_size);
+    char *decoded = malloc(size + 4);
+    if(!cover || !payload || !reference || !stego || !decoded || capacity < 0)
+    {
+        free(cover);
+        free(payload);
+        free(reference);
+        free(stego);
+        free(decoded);
+        return capacity < 0 ? e_success : e_failure;
+    }
+    for(long i = 0; i < size; i++)
+    {
+        payload[i] = get_random(testInfo) & 0xFF;
+    }
+
+    // STEP2: Reference stego image, and a chunk size that splits the image into 1 to 16 chunks for the chunk engine
+    memcpy(reference, cover, image_size);
+    reference_encode(reference, skip, payload, size);
+    sched_chunk_size = ((image_size - 54) / (1 + get_random_below(testInfo, 16)) + 7) / 8 * 8;
+
+    // STEP3: Every engine with every supported kernel must give byte identical images
+    for(const SelfTestEngine *engine = selftest_engines; engine->name && ret == e_success; engine++)
+    {
+        for(const LsbKernel *kernel = get_lsb_kernel_table(); kernel->name; kernel++)
+        {
+            if(!kernel->supported())
+            {
+                continue;
+            }
+            select_lsb_kernel(kernel->name);
+            memset(stego, 0, image_size);
+            if(engine->encode(cover, image_size, skip, payload, size, stego) == e_failure ||
+               memcmp(stego, reference, image_size) != 0)
+            {
+                printf("ERROR: Engine '%s' with kernel '%s' differs from the reference "
+                       "(seed %llu, iteration %ld, image %ld bytes, skip %ld, payload %ld bytes)!\n",
+                       engine->name, kernel->name, testInfo->seed, iteration, image_size, skip, size);
+                ret = e_failure;
+                break;
+            }
+            testInfo->checks++;
+        }
+    }
+
+    // STEP4: Payload must round trip through the oracle and every kernel
+    if(ret == e_success && check_selftest_decoding(testInfo, reference, image_size, skip, payload, size, decoded) == e_failure)
+    {
+        printf("ERROR: Round trip failed (seed %llu, iteration %ld, image %ld bytes, skip %ld, payload %ld bytes)!\n",
+               testInfo->seed, iteration, image_size, skip, size);
+        ret = e_failure;
+    }
+
+    // STEP5: FEC parity of every kernel must match, and a damaged stream must be repaired
+    if(ret == e_success && check_selftest_fec(testInfo, payload, size) == e_failure)
+    {
+        printf("ERROR: FEC round trip failed (seed %llu, iteration %ld, payload %ld bytes)!\n", testInfo->seed, iteration, size);
+        ret = e_failure;
+    }
+
+    // STEP6: Every bpp, channel and bits kernel must match the bit by bit reference and round trip
+    if(ret == e_success && check_selftest_modes(testInfo, cover, image_size, payload, size) == e_failure)
+    {
+        printf("ERROR: LSB mode round trip failed (seed %llu, iteration %ld, payload %ld bytes)!\n", testInfo->seed, iteration, size);
+        ret = e_failure;
+    }
+
+    free(cover);
+    free(payload);
+    free(reference);
+    free(stego);
+    free(decoded);
+    return ret;
+}
+
+// Function to read and validate command line arguments entered by user after -t
+Status read_and_validate_selftest_args(int argc, char *argv[], SelfTestInfo *testInfo)
+{
+    // STEP1: Seed is argv[2] if given, else the current time
+    testInfo->seed = argc > 2 ? strtoull(argv[2], NULL, 10) : (unsigned long long)time(NULL);
+
+    // STEP2: Number of iterations is argv[3] if given
+    testInfo->iterations = argc > 3 ? atol(argv[3]) : SELFTEST_DEFAULT_ITERATIONS;
+    if(testInfo->iterations <= 0)
+    {
+        return e_failure;
+    }
+    return e_success;
+}
+
+// Function to run the self-test
+Status do_selftest(SelfTestInfo *testInfo)
+{
+    // Remember the selected kernel, every kernel is selected in turn below
+    const char *kernel_name = get_lsb_kernel()->name;
+    Status ret = e_success;
+
+    printf("INFO: Self-test with seed %llu, %ld iterations.\n\n", testInfo->seed, testInfo->iterations);
+    testInfo->state = testInfo->seed ? testInfo->seed : 0x9E3779B97F4A7C15ULL;
+
+    for(long i = 0; i < testInfo->iterations && ret == e_success; i++)
+    {
+        ret = run_selftest_iteration(testInfo, i);
+    }
+    select_lsb_kernel(kernel_name);
+    sched_chunk_size = SCHED_CHUNK_SIZE;
+
+    if(ret == e_success)
+    {
+        printf("INFO: Self-test passed, %ld outputs matched the reference.\n", testInfo->checks);
+    }
+    else
+    {
+        printf("INFO: Self-test failed, rerun with ./a.out -t %llu %ld\n", testInfo->seed, testInfo->iterations);
+    }
+    return ret;
+}
@@ -0,0 +1,34 @@
+#ifndef SELFTEST_H
+#define SELFTEST_H
+
+#include "types.h" // Contains user defined types
+
+/*
+ * Structure to store information required for
+ * the randomized differential self-test of all embed/extract engines
+ * against the per byte reference functions
+ */
+
+#define SELFTEST_DEFAULT_ITERATIONS 200
+#define SELFTEST_MAX_WIDTH 300
+#define SELFTEST_MAX_HEIGHT 300
+
+typedef struct _SelfTestInfo
+{
+    unsigned long long seed;    // Seed of the pseudo random generator, printed for reproducing
+    unsigned long long state;   // Current state of the generator
+    long iterations;            // Number of random images to test
+    long checks;                // Number of engine outputs compared
+
+} SelfTestInfo;  // Datatype of the structure
+
+
+/* Self-test function prototype */
+
+/* Read and validate self-test args from argv */
+Status read_and_validate_selftest_args(int argc, char *argv[], SelfTestInfo *testInfo);
+
+/* Run every engine variant against the reference on random images and payloads */
+Status do_selftest(SelfTestInfo *testInfo);
+
+#endif
@@ -0,0 +1,666 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <stddef.h>
+#include <time.h>
+// User-defined header files
+#include "tar_stream.h"
+#include "encode.h"
+#include "decode.h"
+#include "types.h"
+#include "common.h"
+#include "pool.h"
+
+/* Function Definitions */
+
+// Function to build the argv of one job: the image, the secret (encode), the output name and the options
+static int set_tar_job_args(TarInfo *tarInfo, char *argv[], char *image, char *secret, char *output)
+{
+    int argc = 0;
+    argv[argc++] = "./a.out";
+    argv[argc++] = tarInfo->decode ? "-d" : "-e";
+    argv[argc++] = image;
+    if(!tarInfo->decode)
+    {
+        argv[argc++] = secret;
+    }
+    argv[argc++] = output;
+    for(int i = 0; i < tarInfo->option_count; i++)
+    {
+        argv[argc++] = tarInfo->options[i];
+    }
+    argv[argc] = NULL;
+    return argc;
+}
+
+// Function to keep stdout for the tar stream, printf() goes to stderr from here on
+Status take_tar_output(TarInfo *tarInfo)
+{
+    if(isatty(STDOUT_FILENO))
+    {
+        fprintf(stderr, "ERROR: Refusing to write a tar stream to a terminal\n");
+        return e_failure;
+    }
+    fflush(stdout);
+    int fd = dup(STDOUT_FILENO);
+    if(fd < 0 || (tarInfo->fptr_out = fdopen(fd, "w")) == NULL || dup2(STDERR_FILENO, STDOUT_FILENO) < 0)
+    {
+        perror("dup");
+        if(fd >= 0 && tarInfo->fptr_out == NULL) close(fd);
+        return e_failure;
+    }
+    return e_success;
+}
+
+// Function to read and validate command line arguments entered by user after -T
+Status read_and_validate_tar_args(int argc, char *argv[], TarInfo *tarInfo)
+{
+    // STEP1: Collect --decode, the secret for every carrier and the options of every job
+    for(int i = 2; i < argc; i++)
+    {
+        if(strcmp(argv[i], "--decode") == 0)
+        {
+            tarInfo->decode = 1;
+        }
+        else if(strcmp(argv[i], "--journal") == 0 || strcmp(argv[i], "--direct") == 0 || strcmp(argv[i], "--range") == 0)
+        {
+            printf("INFO: %s needs files, it can not be used with -T!\n\n", argv[i]);
+            return e_failure;
+        }
+        else if(argv[i][0] == '-')
+        {
+            if(tarInfo->option_count + 2 > TAR_MAX_OPTIONS)
+            {
+                return e_failure;
+            }
+            tarInfo->options[tarInfo->option_count++] = argv[i];
+            // --bits and --channels take a value
+            if((strcmp(argv[i], "--bits") == 0 || strcmp(argv[i], "--channels") == 0) && i + 1 < argc)
+            {
+                tarInfo->options[tarInfo->option_count++] = argv[++i];
+            }
+        }
+        else if(tarInfo->secret_fname == NULL && strstr(argv[i], ".txt"))
+        {
+            tarInfo->secret_fname = argv[i];
+        }
+        else
+        {
+            return e_failure;
+        }
+    }
+    if(tarInfo->decode && tarInfo->secret_fname)
+    {
+        printf("INFO: A secret file can not be given with --decode!\n\n");
+        return e_failure;
+    }
+
+    // STEP2: Check the options once, while their messages still reach the terminal
+    char *job_argv[6 + TAR_MAX_OPTIONS];
+    int job_argc = set_tar_job_args(tarInfo, job_argv, "member.bmp", "member.txt", "member.bmp");
+    Status ret;
+    if(tarInfo->decode)
+    {
+        DecodeInfo decInfo;
+        memset(&decInfo, 0, sizeof(decInfo));
+        ret = read_and_validate_decode_args(job_argc, job_argv, &decInfo);
+    }
+    else
+    {
+        EncodeInfo encInfo;
+        memset(&encInfo, 0, sizeof(encInfo));
+        ret = read_and_validate_encode_args(job_argc, job_argv, &encInfo);
+    }
+    release_job_memory();
+    return ret;
+}
+
+// Function to parse a numeric header field, octal or GNU base-256 (high bit set)
+static long parse_tar_number(const char *field, int length)
+{
+    long value = 0;
+    if((unsigned char)field[0] & 0x80)
+    {
+        value = field[0] & 0x3f;
+        for(int i = 1; i < length; i++)
+        {
+            value = (value << 8) | (unsigned char)field[i];
+        }
+        return value;
+    }
+    for(int i = 0; i < length && field[i] != '\0'; i++)
+    {
+        if(field[i] >= '0' && field[i] <= '7')
+        {
+            value = (value << 3) | (field[i] - '0');
+        }
+        else if(field[i] != ' ')
+        {
+            break;
+        }
+    }
+    return value;
+}
+
+// Function to sum a header block with the checksum field taken as spaces
+static long get_tar_checksum(const TarHeader *header)
+{
+    const unsigned char *block = (const unsigned char *)header;
+    long sum = 0;
+    for(int i = 0; i < TAR_BLOCK_SIZE; i++)
+    {
+        int in_chksum = i >= (int)offsetof(TarHeader, chksum) && i < (int)offsetof(TarHeader, typeflag);
+        sum += in_chksum ? ' ' : block[i];
+    }
+    return sum;
+}
+
+// Function to mark the input as broken, no more members are read
+static Status set_tar_stream_error(TarInfo *tarInfo, const char *message)
+{
+    fprintf(stderr, "ERROR: %s\n", message);
+    tarInfo->stream_error = 1;
+    tarInfo->end = 1;
+    return e_failure;
+}
+
+// Function to read size bytes of member data and the padding after it, data NULL -> the data is dropped
+static Status read_tar_data(TarInfo *tarInfo, void *data, long size)
+{
+    char block[TAR_BLOCK_SIZE * 16];
+    long padded = (size + TAR_BLOCK_SIZE - 1) / TAR_BLOCK_SIZE * TAR_BLOCK_SIZE;
+    long done = 0;
+
+    if(data)
+    {
+        if(fread(data, 1, size, tarInfo->fptr_in) != (size_t)size)
+        {
+            return set_tar_stream_error(tarInfo, "The tar stream ends in the middle of a member");
+        }
+        done = size;
+    }
+    // stdin may be a pipe, skip by reading
+    while(done < padded)
+    {
+        long length = padded - done < (long)sizeof(block) ? padded - done : (long)sizeof(block);
+        if(fread(block, 1, length, tarInfo->fptr_in) != (size_t)length)
+        {
+            return set_tar_stream_error(tarInfo, "The tar stream ends in the middle of a member");
+        }
+        done += length;
+    }
+    return e_success;
+}
+
+// Function to read a pax header (path record) or a GNU long name into the name of the next member
+static Status read_tar_long_name(TarInfo *tarInfo, const TarHeader *header, long size)
+{
+    // Nothing but a name is taken from them, bigger ones are dropped
+    if(size > TAR_MAX_PAX_SIZE)
+    {
+        return read_tar_data(tarInfo, NULL, size);
+    }
+    char *data = get_pool_buffer(size + 1);
+    if(data == NULL)
+    {
+        return set_tar_stream_error(tarInfo, "Out of memory for a tar extended header");
+    }
+    if(read_tar_data(tarInfo, data, size) == e_failure)
+    {
+        put_pool_buffer(data);
+        return e_failure;
+    }
+    data[size] = '\0';
+
+    if(header->typeflag == 'L')
+    {
+        snprintf(tarInfo->long_name, sizeof(tarInfo->long_name), "%s", data);
+    }
+    else
+    {
+        // Records are "length key=value\n", the length counts the whole record
+        for(long offset = 0; offset < size; )
+        {
+            char *key;
+            long length = strtol(data + offset, &key, 10);
+            if(length <= 0 || offset + length > size || *key != ' ')
+            {
+                break;
+            }
+            key++;
+            long value_size = data + offset + length - 1 - (key + 5);
+            if(strncmp(key, "path=", 5) == 0 && value_size >= 0 && value_size < TAR_MAX_NAME)
+            {
+                memcpy(tarInfo->long_name, key + 5, value_size);
+                tarInfo->long_name[value_size] = '\0';
+            }
+            offset += length;
+        }
+    }
+    put_pool_buffer(data);
+    return e_success;
+}
+
+// Function to read the header of the next file member
+Status read_tar_member(TarInfo *tarInfo, TarMember *member)
+{
+    static const char zero[TAR_BLOCK_SIZE];
+    TarHeader header;
+
+    while(1)
+    {
+        // STEP1: Next header, a zero block (or no more input) ends the stream
+        size_t header_size = fread(&header, 1, sizeof(header), tarInfo->fptr_in);
+        if(header_size == 0 && feof(tarInfo->fptr_in))
+        {
+            tarInfo->end = 1;
+            return e_success;
+        }
+        if(header_size != sizeof(header))
+        {
+            return set_tar_stream_error(tarInfo, "The tar stream ends in the middle of a header");
+        }
+        if(memcmp(&header, zero, sizeof(header)) == 0)
+        {
+            tarInfo->end = 1;
+            return e_success;
+        }
+
+        // STEP2: The checksum tells a tar header from anything else
+        if(parse_tar_number(header.chksum, sizeof(header.chksum)) != get_tar_checksum(&header))
+        {
+            return set_tar_stream_error(tarInfo, "Bad tar header checksum, the input is not a tar stream");
+        }
+        long size = parse_tar_number(header.size, sizeof(header.size));
+        if(size < 0)
+        {
+            return set_tar_stream_error(tarInfo, "Bad tar member size");
+        }
+
+        // STEP3: pax headers and GNU long names name the member after them
+        if(header.typeflag == 'x' || header.typeflag == 'L')
+        {
+            if(read_tar_long_name(tarInfo, &header, size) == e_failure)
+            {
+                return e_failure;
+            }
+            continue;
+        }
+
+        // STEP4: A regular file is a member, directories, links and global pax headers are dropped
+        if(header.typeflag == '0' || header.typeflag == '\0' || header.typeflag == '7')
+        {
+            if(tarInfo->long_name[0])
+            {
+                strcpy(member->name, tarInfo->long_name);
+            }
+            else if(header.prefix[0])
+            {
+                snprintf(member->name, sizeof(member->name), "%.155s/%.100s", header.prefix, header.name);
+            }
+            else
+            {
+                snprintf(member->name, sizeof(member->name), "%.100s", header.name);
+            }
+            tarInfo->long_name[0] = '\0';
+            member->size = size;
+            member->mode = parse_tar_number(header.mode, sizeof(header.mode));
+            member->mtime = parse_tar_number(header.mtime, sizeof(header.mtime));
+            member->data = NULL;
+            return e_success;
+        }
+        tarInfo->long_name[0] = '\0';
+        if(read_tar_data(tarInfo, NULL, size) == e_failure)
+        {
+            return e_failure;
+        }
+    }
+}
+
+// Function to fill a ustar header, name at most 100 characters and prefix at most 155
+static void set_tar_header(TarHeader *header, const char *prefix, long prefix_size, const char *name,
+                           long mode, long mtime, long size, char typeflag)
+{
+    memset(header, 0, sizeof(*header));
+    memcpy(header->prefix, prefix, prefix_size);
+    memcpy(header->name, name, strlen(name) < sizeof(header->name) ? strlen(name) : sizeof(header->name));
+    snprintf(header->mode, sizeof(header->mode), "%07lo", mode & 07777);
+    snprintf(header->uid, sizeof(header->uid), "%07o", 0);
+    snprintf(header->gid, sizeof(header->gid), "%07o", 0);
+    snprintf(header->size, sizeof(header->size), "%011lo", size);
+    snprintf(header->mtime, sizeof(header->mtime), "%011lo", mtime);
+    header->typeflag = typeflag;
+    memcpy(header->magic, "ustar", 6);
+    memcpy(header->version, "00", 2);
+
+    // Checksum last, six octal digits, a NUL and a space
+    snprintf(header->chksum, sizeof(header->chksum), "%06o", (unsigned int)(get_tar_checksum(header) & 0777777));
+    header->chksum[7] = ' ';
+}
+
+// Function to write a header block, the data and the padding up to the next block
+static Status write_tar_block(TarInfo *tarInfo, const TarHeader *header, const void *data, long size)
+{
+    static const char zero[TAR_BLOCK_SIZE];
+    long padding = (TAR_BLOCK_SIZE - size % TAR_BLOCK_SIZE) % TAR_BLOCK_SIZE;
+
+    if(fwrite(header, 1, sizeof(*header), tarInfo->fptr_out) != sizeof(*header) ||
+       fwrite(data, 1, size, tarInfo->fptr_out) != (size_t)size ||
+       fwrite(zero, 1, padding, tarInfo->fptr_out) != (size_t)padding)
+    {
+        perror("fwrite");
+        fprintf(stderr, "ERROR: Unable to write the tar stream\n");
+        return e_failure;
+    }
+    return e_success;
+}
+
+// Function to write one member to the output stream
+Status write_tar_member(TarInfo *tarInfo, const char *name, long mode, long mtime, const unsigned char *data, long size)
+{
+    TarHeader header;
+    long length = strlen(name);
+    const char *split = NULL;
+
+    // STEP1: A name over 100 characters is split into prefix/name at a '/' ...
+    if(length > (long)sizeof(header.name))
+    {
+        for(const char *slash = strchr(name, '/'); slash; slash = strchr(slash + 1, '/'))
+        {
+            if(slash - name <= (long)sizeof(header.prefix) && length - (slash - name) - 1 <= (long)sizeof(header.name) && slash[1])
+            {
+                split = slash;
+                break;
+            }
+        }
+
+        // STEP2: ... or carried whole by a pax header
+        if(split == NULL)
+        {
+            long record_size = length + 7;  // " path=" and "\n"
+            long total = record_size + 1;
+            while(total != record_size + snprintf(NULL, 0, "%ld", total))
+            {
+                total = record_size + snprintf(NULL, 0, "%ld", total);
+            }
+            char *record = get_pool_buffer(total + 1);
+            if(record == NULL)
+            {
+                return e_failure;
+            }
+            snprintf(record, total + 1, "%ld path=%s\n", total, name);
+            set_tar_header(&header, "", 0, "././@PaxHeader", 0644, mtime, total, 'x');
+            Status ret = write_tar_block(tarInfo, &header, record, total);
+            put_pool_buffer(record);
+            if(ret == e_failure)
+            {
+                return e_failure;
+            }
+        }
+    }
+
+    // STEP3: The member itself
+    if(split)
+    {
+        set_tar_header(&header, name, split - name, split + 1, mode, mtime, size, '0');
+    }
+    else
+    {
+        set_tar_header(&header, "", 0, name, mode, mtime, size, '0');
+    }
+    if(write_tar_block(tarInfo, &header, data, size) == e_failure)
+    {
+        return e_failure;
+    }
+    tarInfo->bytes_out += size;
+    return e_success;
+}
+
+// Function to run one job on in-memory members, the output member is written on success
+Status run_tar_job(TarInfo *tarInfo, TarMember *carrier, const char *secret_name, unsigned char *secret_data, long secret_size)
+{
+    char stem[TAR_MAX_NAME];
+    char *argv[6 + TAR_MAX_OPTIONS];
+    const char *output_name = carrier->name;
+    long output_size = 0;
+    Status ret = e_failure;
+
+    // STEP1: The output buffer is the carrier's size: a stego image is as big, a decoded secret smaller
+    unsigned char *output = get_pool_buffer(carrier->size + 1);
+    FILE *image = fmemopen(carrier->data, carrier->size, "r");
+    FILE *result = output ? fmemopen(output, carrier->size + 1, "w+") : NULL;
+    FILE *secret = NULL;
+    if(image == NULL || result == NULL)
+    {
+        perror("fmemopen");
+        fprintf(stderr, "ERROR: Unable to open member %s\n", carrier->name);
+        if(image) fclose(image);
+        if(result) fclose(result);
+        return e_failure;
+    }
+
+    // STEP2: Encode job, the core gets the members as open streams
+    if(!tarInfo->decode)
+    {
+        EncodeInfo encInfo;
+        memset(&encInfo, 0, sizeof(encInfo));
+        int argc = set_tar_job_args(tarInfo, argv, carrier->name, (char *)secret_name, carrier->name);
+        secret = fmemopen(secret_data, secret_size, "r");
+        if(secret && read_and_validate_encode_args(argc, argv, &encInfo) == e_success)
+        {
+            encInfo.fptr_src_image = image;
+            encInfo.fptr_secret = secret;
+            encInfo.fptr_stego_image = result;
+            ret = do_encoding(&encInfo);
+        }
+    }
+    // STEP3: Decode job, the output is named from the carrier's stem and the decoded extension
+    else
+    {
+        DecodeInfo decInfo;
+        memset(&decInfo, 0, sizeof(decInfo));
+        snprintf(stem, sizeof(stem), "%.*s", (int)strlen(carrier->name) - 4, carrier->name);
+        int argc = set_tar_job_args(tarInfo, argv, carrier->name, NULL, stem);
+        if(read_and_validate_decode_args(argc, argv, &decInfo) == e_success)
+        {
+            decInfo.fptr_enc_image = image;
+            decInfo.fptr_secret = result;
+            ret = do_decoding(&decInfo);
+            output_name = decInfo.secret_fname;
+        }
+    }
+
+    // STEP4: Output size, then the member goes out
+    if(ret == e_success)
+    {
+        fflush(result);
+        fseek(result, 0, SEEK_END);
+        output_size = ftell(result);
+    }
+    fclose(image);
+    fclose(result);
+    if(secret) fclose(secret);
+    if(ret == e_success)
+    {
+        ret = write_tar_member(tarInfo, output_name, carrier->mode, carrier->mtime, output, output_size);
+    }
+    return ret;
+}
+
+// Function to read the secret given for every carrier
+static Status read_tar_secret(TarInfo *tarInfo)
+{
+    FILE *fptr = fopen(tarInfo->secret_fname, "r");
+    if(fptr == NULL)
+    {
+        perror("fopen");
+        fprintf(stderr, "ERROR: Unable to open file %s\n", tarInfo->secret_fname);
+        return e_failure;
+    }
+    fseek(fptr, 0, SEEK_END);
+    tarInfo->secret_size = ftell(fptr);
+    rewind(fptr);
+    tarInfo->secret_data = malloc(tarInfo->secret_size ? tarInfo->secret_size : 1);
+    Status ret = tarInfo->secret_data && fread(tarInfo->secret_data, 1, tarInfo->secret_size, fptr) == (size_t)tarInfo->secret_size ? e_success : e_failure;
+    fclose(fptr);
+    if(ret == e_failure)
+    {
+        fprintf(stderr, "ERROR: Unable to read file %s\n", tarInfo->secret_fname);
+    }
+    return ret;
+}
+
+// Function to check the name of a member ends in suffix
+static int has_tar_suffix(const char *name, const char *suffix)
+{
+    long length = strlen(name), suffix_length = strlen(suffix);
+    return length >= suffix_length && strcmp(name + length - suffix_length, suffix) == 0;
+}
+
+// Function to count a finished job and give its memory back
+static void finish_tar_job(TarInfo *tarInfo, Status ret, const char *name)
+{
+    if(ret == e_success)
+    {
+        tarInfo->ok++;
+    }
+    else
+    {
+        fprintf(stderr, "INFO: %s failed.\n", name);
+        tarInfo->failed++;
+    }
+    release_job_memory();
+}
+
+// Function to handle one member: read it, run its job or keep it for the other file of its pair
+static void handle_tar_member(TarInfo *tarInfo, TarMember *member)
+{
+    TarMember *pending = &tarInfo->pending;
+    int carrier = has_tar_suffix(member->name, ".bmp");
+    int secret = !tarInfo->decode && !tarInfo->secret_data && has_tar_suffix(member->name, ".txt");
+
+    // STEP1: Members that are not part of a job are dropped
+    if(!carrier && !secret)
+    {
+        read_tar_data(tarInfo, NULL, member->size);
+        tarInfo->skipped++;
+        return;
+    }
+
+    // STEP2: The member into memory, one too big to hold fails alone
+    if(member->size > TAR_MAX_MEMBER_SIZE || (member->data = get_pool_buffer(member->size ? member->size : 1)) == NULL)
+    {
+        fprintf(stderr, "ERROR: %s is too large to hold in memory (%ld bytes)\n", member->name, member->size);
+        read_tar_data(tarInfo, NULL, member->size);
+        tarInfo->failed++;
+        return;
+    }
+    if(read_tar_data(tarInfo, member->data, member->size) == e_failure)
+    {
+        return;
+    }
+    tarInfo->bytes_in += member->size;
+
+    // STEP3: Decoding, or one secret for every carrier -> the carrier is a whole job
+    if(tarInfo->decode || tarInfo->secret_data)
+    {
+        finish_tar_job(tarInfo, run_tar_job(tarInfo, member, tarInfo->secret_fname, tarInfo->secret_data, tarInfo->secret_size), member->name);
+        return;
+    }
+
+    // STEP4: A pair is two members next to each other with the same stem, in either order
+    long length = strlen(member->name);
+    if(pending->data && has_tar_suffix(pending->name, ".bmp") != carrier &&
+       (long)strlen(pending->name) == length && strncmp(pending->name, member->name, length - 4) == 0)
+    {
+        TarMember *image = carrier ? member : pending;
+        TarMember *text = carrier ? pending : member;
+        // The secret name only gives the extension, without the directories
+        const char *base = strrchr(text->name, '/') ? strrchr(text->name, '/') + 1 : text->name;
+        Status ret = run_tar_job(tarInfo, image, base, text->data, text->size);
+        pending->data = NULL;
+        finish_tar_job(tarInfo, ret, image->name);
+        return;
+    }
+
+    // STEP5: Otherwise the member waits, the one waiting before it has lost its pair
+    if(pending->data)
+    {
+        fprintf(stderr, "INFO: %s has no %s next to it in the stream.\n", pending->name,
+                has_tar_suffix(pending->name, ".bmp") ? "secret .txt" : "carrier .bmp");
+        put_pool_buffer(pending->data);
+        tarInfo->failed++;
+    }
+    *pending = *member;
+}
+
+// Function to process the tar stream on stdin until its end
+Status do_tar_streaming(TarInfo *tarInfo)
+{
+    static const char zero[TAR_BLOCK_SIZE * 2];
+    struct timespec now;
+
+    // STEP1: The secret given for every carrier is read once
+    if(tarInfo->secret_fname && read_tar_secret(tarInfo) == e_failure)
+    {
+        return e_failure;
+    }
+
+    // STEP2: The core's step messages go to /dev/null, the tar stream has the original stdout (take_tar_output())
+    fflush(stdout);
+    if(freopen("/dev/null", "w", stdout) == NULL)
+    {
+        perror("freopen");
+        return e_failure;
+    }
+    tarInfo->fptr_in = stdin;
+    setvbuf(tarInfo->fptr_in, NULL, _IOFBF, TAR_STREAM_BUFFER_SIZE);
+    setvbuf(tarInfo->fptr_out, NULL, _IOFBF, TAR_STREAM_BUFFER_SIZE);
+    step_delay = 0;
+    clock_gettime(CLOCK_MONOTONIC, &tarInfo->start);
+
+    // STEP3: Every member as it arrives
+    while(read_tar_member(tarInfo, &tarInfo->member) == e_success && !tarInfo->end)
+    {
+        handle_tar_member(tarInfo, &tarInfo->member);
+    }
+
+    // STEP4: A member still waiting has lost its pair
+    if(tarInfo->pending.data)
+    {
+        fprintf(stderr, "INFO: %s has no %s next to it in the stream.\n", tarInfo->pending.name,
+                has_tar_suffix(tarInfo->pending.name, ".bmp") ? "secret .txt" : "carrier .bmp");
+        tarInfo->pending.data = NULL;
+        tarInfo->failed++;
+    }
+    release_job_memory();
+
+    // STEP5: Two zero blocks end the output, it stays a valid tar even if the input was cut short
+    if(fwrite(zero, 1, sizeof(zero), tarInfo->fptr_out) != sizeof(zero) || fflush(tarInfo->fptr_out) != 0)
+    {
+        perror("fwrite");
+        fprintf(stderr, "ERROR: Unable to write the tar stream\n");
+        return e_failure;
+    }
+
+    // STEP6: Report
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    double seconds = (now.tv_sec - tarInfo->start.tv_sec) + (now.tv_nsec - tarInfo->start.tv_nsec) / 1e9;
+    fprintf(stderr, "INFO: Tar stream done, %d jobs ok, %d failed, %d members skipped, %ld bytes in, %ld bytes out, %.1f jobs/s.\n",
+            tarInfo->ok, tarInfo->failed, tarInfo->skipped, tarInfo->bytes_in, tarInfo->bytes_out,
+            seconds > 0 ? tarInfo->ok / seconds : 0.0);
+    return tarInfo->failed == 0 && !tarInfo->stream_error ? e_success : e_failure;
+}
+
+// Function to free the secret and close the output stream
+void clear_tar_info(TarInfo *tarInfo)
+{
+    free(tarInfo->secret_data);
+    tarInfo->secret_data = NULL;
+    if(tarInfo->fptr_out)
+    {
+        fclose(tarInfo->fptr_out);
+        tarInfo->fptr_out = NULL;
+    }
+}
@@ -0,0 +1,125 @@
+#ifndef TAR_STREAM_H
+#define TAR_STREAM_H
+
+#include <stdio.h>
+#include <time.h>
+#include "types.h" // Contains user defined types
+
+/*
+ * Structure to store information required for
+ * encoding/decoding every member of a tar stream on stdin into a tar stream on stdout
+ *
+ * Encode (default): a job is a carrier name.bmp with the secret name.txt
+ * right before or after it in the stream, or with the secret file given
+ * on the command line for every carrier. The output member is name.bmp.
+ * Decode (--decode): a job is every name.bmp, the output member is name
+ * plus the decoded extension. Other members are skipped.
+ *
+ * Members are handled as they arrive: a member is read into a pool
+ * buffer and handed to the encode/decode core as an fmemopen() stream,
+ * the output goes to another pool buffer and is written as soon as the
+ * job ends, so nothing touches the filesystem and memory stays at two or
+ * three members (the largest ones seen) however long the stream is.
+ * Members over TAR_MAX_MEMBER_SIZE are skipped and count as failed.
+ *
+ * Input: ustar, pax (path records) and GNU long names, octal or base-256
+ * sizes. Output: ustar, a pax header for names that do not fit. Output
+ * members keep the mode and mtime of the carrier. Messages go to stderr,
+ * the core's step messages to /dev/null. Encode/decode
+ * options (--fec, --bits, ...) apply to every job, --journal, --direct
+ * and --range need files and are refused
+ */
+
+#define TAR_BLOCK_SIZE 512
+#define TAR_MAX_NAME 4096               // Longest member name
+#define TAR_MAX_MEMBER_SIZE (256L * 1024 * 1024)    // Largest carrier or secret held in memory
+#define TAR_MAX_PAX_SIZE (64 * 1024)    // Largest pax or GNU long name header read
+#define TAR_STREAM_BUFFER_SIZE (256 * 1024)         // stdio buffer of stdin and stdout
+#define TAR_MAX_OPTIONS 16              // Encode/decode options passed to every job
+
+/* ustar header block */
+typedef struct _TarHeader
+{
+    char name[100];
+    char mode[8];
+    char uid[8];
+    char gid[8];
+    char size[12];
+    char mtime[12];
+    char chksum[8];
+    char typeflag;
+    char linkname[100];
+    char magic[6];
+    char version[2];
+    char uname[32];
+    char gname[32];
+    char devmajor[8];
+    char devminor[8];
+    char prefix[155];
+    char pad[12];
+
+} TarHeader;
+
+typedef struct _TarMember
+{
+    char name[TAR_MAX_NAME];
+    long size;
+    long mode;
+    long mtime;
+    unsigned char *data;        // Pool buffer, NULL if the data is not held
+
+} TarMember;
+
+typedef struct _TarInfo
+{
+    /* Options */
+    int decode;                 // --decode
+    char *secret_fname;         // Secret for every carrier, NULL -> name.txt members
+    unsigned char *secret_data; // Its contents, read once
+    long secret_size;
+    char *options[TAR_MAX_OPTIONS];
+    int option_count;
+
+    /* Streams */
+    FILE *fptr_in;              // stdin
+    FILE *fptr_out;             // The original stdout, stdout itself goes to stderr, then /dev/null
+    int end;                    // Trailer (or the end of the input) seen
+    int stream_error;           // The input is cut short or not a tar stream
+
+    /* Members */
+    TarMember member;           // Being read
+    TarMember pending;          // Carrier or secret waiting for the other one
+    char long_name[TAR_MAX_NAME];       // Name for the next member from a pax or GNU header, "" if none
+
+    /* Counters */
+    int ok, failed, skipped;
+    long bytes_in, bytes_out;
+    struct timespec start;
+
+} TarInfo;  // Datatype of the structure
+
+
+/* Tar stream function prototype */
+
+/* Keep stdout for the tar stream and send the messages to stderr, before anything is printed */
+Status take_tar_output(TarInfo *tarInfo);
+
+/* Read and validate tar stream args from argv */
+Status read_and_validate_tar_args(int argc, char *argv[], TarInfo *tarInfo);
+
+/* Read the next file member's header, the data is left in the stream, end is set at the trailer */
+Status read_tar_member(TarInfo *tarInfo, TarMember *member);
+
+/* Write one member to the output stream */
+Status write_tar_member(TarInfo *tarInfo, const char *name, long mode, long mtime, const unsigned char *data, long size);
+
+/* Run one job on in-memory members, the output member is written on success */
+Status run_tar_job(TarInfo *tarInfo, TarMember *carrier, const char *secret_name, unsigned char *secret_data, long secret_size);
+
+/* Process the tar stream on stdin until its end */
+Status do_tar_streaming(TarInfo *tarInfo);
+
+/* Free the secret and close the output stream */
+void clear_tar_info(TarInfo *tarInfo);
+
+#endif
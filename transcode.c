@@ -0,0 +1,165 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+// User-defined header files
+#include "transcode.h"
+#include "encode.h"
+#include "decode.h"
+#include "types.h"
+#include "common.h"
+#include "admission.h"
+
+/* Function Definitions */
+
+// Function to read and validate command line arguments entered by user after -r
+Status read_and_validate_transcode_args(char *argv[], TranscodeInfo *tcInfo)
+{
+    // STEP1: Check argv[2], argv[3] and argv[4] are .bmp or not
+    if(strstr(argv[2], ".bmp") == NULL || strstr(argv[3], ".bmp") == NULL || strstr(argv[4], ".bmp") == NULL)
+    {
+        return e_failure;
+    }
+
+    // STEP2: Store the file names
+    tcInfo->enc_image_fname = argv[2];
+    tcInfo->src_image_fname = argv[3];
+    tcInfo->stego_image_fname = argv[4];
+    return e_success;
+}
+
+// Function to open a file, printing the error like open_files() does
+static FILE *open_transcode_file(const char *fname, const char *mode)
+{
+    FILE *fptr = fopen(fname, mode);
+    if(fptr == NULL)
+    {
+        perror("fopen");
+        fprintf(stderr, "ERROR: Unable to open file %s\n", fname);
+    }
+    return fptr;
+}
+
+// Function to decode the header of the encoded image, leaves it at the first data byte
+Status decode_transcode_header(TranscodeInfo *tcInfo)
+{
+    char arr[32];
+    uint image_capacity = get_image_size_for_bmp(tcInfo->fptr_enc_image);
+
+    // STEP1: Magic string right after the bmp header
+    fseek(tcInfo->fptr_enc_image, 54, SEEK_SET);
+    if(decode_magic_string(MAGIC_STRING, tcInfo->fptr_enc_image) == e_failure)
+    {
+        printf("INFO: The magic string does not match!\n\n");
+        return e_failure;
+    }
+
+    // STEP2: Extension size and extension
+    if(fread(arr, 1, 32, tcInfo->fptr_enc_image) != 32)
+    {
+        return e_failure;
+    }
+    decode_size_from_lsb(&tcInfo->extn_file_size, arr);
+    if(tcInfo->extn_file_size < 0 || tcInfo->extn_file_size > MAX_TRANSCODE_EXTN_SIZE)
+    {
+        printf("INFO: The extension size is corrupted!\n\n");
+        return e_failure;
+    }
+    if(decode_image_to_block(tcInfo->extn_secret_file, tcInfo->extn_file_size, tcInfo->fptr_enc_image) == e_failure)
+    {
+        return e_failure;
+    }
+    tcInfo->extn_secret_file[tcInfo->extn_file_size] = '\0';
+
+    // STEP3: Secret size, the data must lie inside the encoded image
+    //        get_encoded_size() counts the 54 byte bmp header and one spare byte, so the data ends one byte before it
+    if(fread(arr, 1, 32, tcInfo->fptr_enc_image) != 32)
+    {
+        return e_failure;
+    }
+    decode_size_from_lsb(&tcInfo->size_secret_file, arr);
+    if(tcInfo->size_secret_file < 0 ||
+       get_encoded_size(tcInfo->extn_file_size, tcInfo->size_secret_file) - 1 > 54 + (unsigned long long)image_capacity)
+    {
+        printf("INFO: The secret size is corrupted!\n\n");
+        return e_failure;
+    }
+    return admit_output_bytes(tcInfo->size_secret_file);
+}
+
+// Function to move the secret from the encoded image into the new cover
+Status do_transcoding(TranscodeInfo *tcInfo)
+{
+    char data[MAX_BLOCK_SIZE];
+
+    // STEP1: Open all three images
+    tcInfo->fptr_enc_image = open_transcode_file(tcInfo->enc_image_fname, "r");
+    tcInfo->fptr_src_image = tcInfo->fptr_enc_image ? open_transcode_file(tcInfo->src_image_fname, "r") : NULL;
+    if(tcInfo->fptr_src_image == NULL)
+    {
+        printf("INFO: Files could not be opened!\n\n");
+        return e_failure;
+    }
+
+    // STEP2: Decode the header of the encoded image
+    if(decode_transcode_header(tcInfo) == e_failure)
+    {
+        printf("INFO: The encoded image header could not be decoded!\n\n");
+        return e_failure;
+    }
+    printf("INFO: Secret of %ld bytes with extension %s found.\n\n", tcInfo->size_secret_file, tcInfo->extn_secret_file);
+
+    // STEP3: New cover must hold it, checked before the output is created
+    if(get_image_size_for_bmp(tcInfo->fptr_src_image) <= get_encoded_size(tcInfo->extn_file_size, tcInfo->size_secret_file))
+    {
+        printf("INFO: Cover Image does not have enough capacity!\n\n");
+        return e_failure;
+    }
+    tcInfo->fptr_stego_image = open_transcode_file(tcInfo->stego_image_fname, "w");
+    if(tcInfo->fptr_stego_image == NULL)
+    {
+        return e_failure;
+    }
+
+    // STEP4: Header of the new stego image
+    if(copy_bmp_header(tcInfo->fptr_src_image, tcInfo->fptr_stego_image) == e_failure ||
+       encode_magic_string(MAGIC_STRING, tcInfo->fptr_src_image, tcInfo->fptr_stego_image) == e_failure ||
+       encode_secret_file_extn_size(tcInfo->extn_file_size, tcInfo->fptr_src_image, tcInfo->fptr_stego_image) == e_failure ||
+       encode_block_to_image(tcInfo->extn_secret_file, tcInfo->extn_file_size, tcInfo->fptr_src_image, tcInfo->fptr_stego_image) == e_failure ||
+       encode_secret_file_size(tcInfo->size_secret_file, tcInfo->fptr_src_image, tcInfo->fptr_stego_image) == e_failure)
+    {
+        printf("INFO: The header could not be encoded!\n\n");
+        return e_failure;
+    }
+
+    // STEP5: Pipe the data block by block from the encoded image into the cover
+    long remaining = tcInfo->size_secret_file;
+    while(remaining > 0)
+    {
+        long block = remaining < MAX_BLOCK_SIZE ? remaining : MAX_BLOCK_SIZE;
+        if(decode_image_to_block(data, block, tcInfo->fptr_enc_image) == e_failure ||
+           encode_block_to_image(data, block, tcInfo->fptr_src_image, tcInfo->fptr_stego_image) == e_failure)
+        {
+            printf("INFO: The secret file data could not be transcoded!\n\n");
+            return e_failure;
+        }
+        remaining -= block;
+    }
+
+    // STEP6: Rest of the cover, then the size check of check_successful_encoding()
+    if(copy_image_blocks(tcInfo->fptr_src_image, tcInfo->fptr_stego_image, NULL, NULL) == e_failure ||
+       get_file_size(tcInfo->fptr_stego_image) != get_file_size(tcInfo->fptr_src_image))
+    {
+        printf("INFO: The remaining data could not be copied!\n\n");
+        return e_failure;
+    }
+    printf("INFO: Transcoding Completed Successfully.\n");
+    return e_success;
+}
+
+// Function to close transcode file pointers
+void clear_transcode_info(TranscodeInfo *tcInfo)
+{
+    if(tcInfo->fptr_enc_image) fclose(tcInfo->fptr_enc_image);
+    if(tcInfo->fptr_src_image) fclose(tcInfo->fptr_src_image);
+    if(tcInfo->fptr_stego_image) fclose(tcInfo->fptr_stego_image);
+}
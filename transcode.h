@@ -0,0 +1,50 @@
+#ifndef TRANSCODE_H
+#define TRANSCODE_H
+
+#include "types.h" // Contains user defined types
+
+/*
+ * Structure to store information required for
+ * moving a secret from one encoded Image into a new cover Image
+ * The secret only passes through memory, one block at a time
+ */
+
+#define MAX_TRANSCODE_EXTN_SIZE 32
+
+typedef struct _TranscodeInfo
+{
+    /* Encoded (source) Image info */
+    char *enc_image_fname;      // Encoded image holding the secret
+    FILE *fptr_enc_image;       // File pointer of encoded image
+
+    /* Cover Image info */
+    char *src_image_fname;      // New cover image
+    FILE *fptr_src_image;       // File pointer of cover image
+
+    /* Stego Image Info */
+    char *stego_image_fname;    // Output Image file name
+    FILE *fptr_stego_image;     // File pointer of output image
+
+    /* Secret Info, decoded from the encoded image header */
+    long extn_file_size;        // Extension size of secret file
+    char extn_secret_file[MAX_TRANSCODE_EXTN_SIZE + 1];    // Extension of secret file
+    long size_secret_file;      // Secret file size
+
+} TranscodeInfo;  // Datatype of the structure
+
+
+/* Transcode function prototype */
+
+/* Read and validate transcode args from argv */
+Status read_and_validate_transcode_args(char *argv[], TranscodeInfo *tcInfo);
+
+/* Move the secret from the encoded image into the new cover */
+Status do_transcoding(TranscodeInfo *tcInfo);
+
+/* Decode the header of the encoded image, leaves it at the first data byte */
+Status decode_transcode_header(TranscodeInfo *tcInfo);
+
+/* Close transcode file pointers */
+void clear_transcode_info(TranscodeInfo *tcInfo);
+
+#endif
@@ -15,7 +15,20 @@ typedef enum
 {
     e_encode, // 0
     e_decode, // 1
-    e_unsupported  // 2
+    e_archive, // 2
+    e_list, // 3
+    e_extract, // 4
+    e_append, // 5
+    e_selftest, // 6
+    e_analyze, // 7
+    e_plan, // 8
+    e_broadcast, // 9
+    e_transcode, // 10
+    e_run,       // 11
+    e_generate,  // 12
+    e_watch,     // 13
+    e_tar,       // 14
+    e_unsupported  // 15
 } OperationType;
 
 #endif
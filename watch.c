@@ -0,0 +1,565 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <dirent.h>
+#include <limits.h>
+#include <time.h>
+#include <sys/inotify.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+// User-defined header files
+#include "watch.h"
+#include "encode.h"
+#include "decode.h"
+#include "types.h"
+#include "common.h"
+#include "admission.h"
+#include "progress.h"
+#include "pool.h"
+
+// Set by SIGINT/SIGTERM in the coordinator
+static volatile sig_atomic_t watch_stop;
+
+/* Function Definitions */
+
+// Function to read and validate command line arguments entered by user after -w
+Status read_and_validate_watch_args(int argc, char *argv[], WatchInfo *watchInfo)
+{
+    struct stat spool, output;
+
+    // STEP1: Two existing, different directories
+    watchInfo->spool_dir = argv[2];
+    watchInfo->output_dir = argv[3];
+    if(stat(watchInfo->spool_dir, &spool) != 0 || !S_ISDIR(spool.st_mode) ||
+       stat(watchInfo->output_dir, &output) != 0 || !S_ISDIR(output.st_mode))
+    {
+        printf("INFO: The spool and output directories must exist!\n\n");
+        return e_failure;
+    }
+    if(spool.st_dev == output.st_dev && spool.st_ino == output.st_ino)
+    {
+        printf("INFO: The output directory must not be the spool directory!\n\n");
+        return e_failure;
+    }
+
+    // STEP2: Optional number of workers (default one per online CPU) and --decode
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    watchInfo->workers = cpus <= 0 ? 1 : cpus > WATCH_MAX_WORKERS ? WATCH_MAX_WORKERS : cpus;
+    for(int i = 4; i < argc; i++)
+    {
+        if(strcmp(argv[i], "--decode") == 0)
+        {
+            watchInfo->decode = 1;
+        }
+        else
+        {
+            watchInfo->workers = atoi(argv[i]);
+            if(watchInfo->workers <= 0 || watchInfo->workers > WATCH_MAX_WORKERS)
+            {
+                return e_failure;
+            }
+        }
+    }
+    return e_success;
+}
+
+// Function to note a complete file of the spool, queues the job once all its files are there
+void add_watch_file(WatchInfo *watchInfo, const char *fname)
+{
+    // STEP1: Only name.bmp, and name.txt when encoding
+    const char *dot = strrchr(fname, '.');
+    int carrier = dot && strcmp(dot, ".bmp") == 0;
+    int secret = dot && strcmp(dot, ".txt") == 0 && !watchInfo->decode;
+    if(fname[0] == '.' || (!carrier && !secret) || dot - fname >= WATCH_MAX_NAME)
+    {
+        return;
+    }
+
+    // STEP2: Find the entry of the stem or start one
+    WatchEntry *entry = watchInfo->entries;
+    while(entry && (strncmp(entry->name, fname, dot - fname) != 0 || entry->name[dot - fname] != '\0'))
+    {
+        entry = entry->next;
+    }
+    if(entry == NULL)
+    {
+        entry = calloc(1, sizeof(WatchEntry));
+        if(entry == NULL)
+        {
+            return;
+        }
+        memcpy(entry->name, fname, dot - fname);
+        entry->next = watchInfo->entries;
+        watchInfo->entries = entry;
+        watchInfo->waiting++;
+    }
+    entry->has_carrier |= carrier;
+    entry->has_secret |= secret;
+
+    // STEP3: Complete -> to the tail of the backlog, a file written again while queued or running is the same job
+    if(entry->state == WATCH_WAITING && entry->has_carrier && (entry->has_secret || watchInfo->decode))
+    {
+        entry->state = WATCH_QUEUED;
+        entry->queue_next = NULL;
+        if(watchInfo->queue_tail)
+        {
+            watchInfo->queue_tail->queue_next = entry;
+        }
+        else
+        {
+            watchInfo->queue_head = entry;
+        }
+        watchInfo->queue_tail = entry;
+        watchInfo->waiting--;
+        watchInfo->queued++;
+    }
+}
+
+// Function to move an input of the job to the done or failed directory
+static void move_watch_input(WatchInfo *watchInfo, const char *name, const char *extn, Status status)
+{
+    char from[PATH_MAX], to[PATH_MAX];
+
+    snprintf(from, sizeof(from), "%s/%s%s", watchInfo->spool_dir, name, extn);
+    snprintf(to, sizeof(to), "%s/%s/%s%s", watchInfo->spool_dir, status == e_success ? WATCH_DONE_DIR : WATCH_FAILED_DIR, name, extn);
+    if(rename(from, to) != 0)
+    {
+        perror("rename");
+    }
+}
+
+// Function to get the size of a file, 0 if it can not be read
+static long get_watch_file_size(const char *fname)
+{
+    struct stat st;
+    return stat(fname, &st) == 0 ? st.st_size : 0;
+}
+
+// Function to run one job with the encode/decode core, output renamed into place and inputs moved
+Status run_watch_job(WatchInfo *watchInfo, const char *name, long *bytes)
+{
+    char carrier[PATH_MAX], secret[PATH_MAX], temp[PATH_MAX], final[PATH_MAX];
+    Status ret = e_failure;
+
+    snprintf(carrier, sizeof(carrier), "%s/%s.bmp", watchInfo->spool_dir, name);
+    snprintf(secret, sizeof(secret), "%s/%s.txt", watchInfo->spool_dir, name);
+    *bytes = get_watch_file_size(carrier) + (watchInfo->decode ? 0 : get_watch_file_size(secret));
+
+    // STEP1: Encode job into output_dir/.name.part.bmp, then renamed to output_dir/name.bmp
+    if(!watchInfo->decode)
+    {
+        EncodeInfo encInfo;
+        char *argv[] = { "./a.out", "-e", carrier, secret, temp, NULL };
+        snprintf(temp, sizeof(temp), "%s/.%s.part.bmp", watchInfo->output_dir, name);
+        snprintf(final, sizeof(final), "%s/%s.bmp", watchInfo->output_dir, name);
+        memset(&encInfo, 0, sizeof(encInfo));
+        if(read_and_validate_encode_args(5, argv, &encInfo) == e_success)
+        {
+            ret = do_encoding(&encInfo);
+        }
+        if(encInfo.fptr_secret) fclose(encInfo.fptr_secret);
+        if(encInfo.fptr_src_image) fclose(encInfo.fptr_src_image);
+        if(encInfo.fptr_stego_image && fclose(encInfo.fptr_stego_image) != 0) ret = e_failure;
+    }
+    // STEP2: Decode job into output_dir/.name.part plus the decoded extension, then renamed to output_dir/name plus it
+    else
+    {
+        DecodeInfo decInfo;
+        char *argv[] = { "./a.out", "-d", carrier, temp, NULL };
+        snprintf(temp, sizeof(temp), "%s/.%s.part", watchInfo->output_dir, name);
+        memset(&decInfo, 0, sizeof(decInfo));
+        if(read_and_validate_decode_args(4, argv, &decInfo) == e_success)
+        {
+            ret = do_decoding(&decInfo);
+        }
+        if(decInfo.fptr_enc_image) fclose(decInfo.fptr_enc_image);
+        if(decInfo.fptr_secret && fclose(decInfo.fptr_secret) != 0) ret = e_failure;
+        if(decInfo.secret_fname && strncmp(decInfo.secret_fname, temp, strlen(temp)) == 0)
+        {
+            snprintf(final, sizeof(final), "%s/%s%s", watchInfo->output_dir, name, decInfo.secret_fname + strlen(temp));
+            snprintf(temp, sizeof(temp), "%s", decInfo.secret_fname);
+        }
+        else
+        {
+            ret = e_failure;
+        }
+    }
+
+    // STEP3: Readers of output_dir only ever see whole outputs
+    if(ret == e_success && rename(temp, final) != 0)
+    {
+        perror("rename");
+        ret = e_failure;
+    }
+    if(ret == e_failure)
+    {
+        unlink(temp);
+    }
+
+    // STEP4: Inputs out of the spool, a restart does not run them again
+    move_watch_input(watchInfo, name, ".bmp", ret);
+    if(!watchInfo->decode)
+    {
+        move_watch_input(watchInfo, name, ".txt", ret);
+    }
+    return ret;
+}
+
+// Microseconds from start to now
+static long get_watch_elapsed_us(struct timespec *start)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) * 1000000L + (now.tv_nsec - start->tv_nsec) / 1000;
+}
+
+// Worker process, runs jobs from the pipe until the coordinator closes it, never returns
+static void run_watch_worker(WatchInfo *watchInfo, int worker)
+{
+    WatchResult result;
+    char name[WATCH_MAX_NAME];
+    struct timespec start;
+
+    // Only the coordinator prints and handles SIGINT/SIGTERM, the worker finishes the jobs in the pipe
+    step_delay = 0;
+    signal(SIGINT, SIG_IGN);
+    signal(SIGTERM, SIG_IGN);
+    close(watchInfo->job_pipe[1]);
+    close(watchInfo->inotify_fd);
+    if(freopen("/dev/null", "w", stdout) == NULL)
+    {
+        _exit(1);
+    }
+
+    // A record is far below PIPE_BUF, so every read takes exactly one whole job
+    while(read(watchInfo->job_pipe[0], name, sizeof(name)) == sizeof(name))
+    {
+        memset(&result, 0, sizeof(result));
+        strcpy(result.name, name);
+        result.worker = worker;
+        strcpy(watchInfo->shared->current[worker], name);
+
+        reset_admission();
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        result.status = run_watch_job(watchInfo, name, &result.bytes);
+        release_job_memory();
+        result.elapsed_us = get_watch_elapsed_us(&start);
+
+        watchInfo->shared->current[worker][0] = '\0';
+        if(write(watchInfo->result_pipe[1], &result, sizeof(result)) != sizeof(result))
+        {
+            _exit(1);
+        }
+    }
+    // _exit, the atexit handler and stdio buffers belong to the coordinator
+    _exit(0);
+}
+
+// Function to fork one worker
+static Status start_watch_worker(WatchInfo *watchInfo, int worker)
+{
+    fflush(stdout);
+    pid_t pid = fork();
+    if(pid < 0)
+    {
+        perror("fork");
+        return e_failure;
+    }
+    if(pid == 0)
+    {
+        run_watch_worker(watchInfo, worker);
+    }
+    watchInfo->pids[worker] = pid;
+    watchInfo->running_workers++;
+    return e_success;
+}
+
+// Function to remove a finished job's entry
+static void remove_watch_entry(WatchInfo *watchInfo, const char *name)
+{
+    for(WatchEntry **link = &watchInfo->entries; *link; link = &(*link)->next)
+    {
+        if(strcmp((*link)->name, name) == 0 && (*link)->state == WATCH_RUNNING)
+        {
+            WatchEntry *entry = *link;
+            *link = entry->next;
+            free(entry);
+            watchInfo->in_flight--;
+            return;
+        }
+    }
+}
+
+// Function to take the results the workers wrote, one status line per job
+static void read_watch_results(WatchInfo *watchInfo)
+{
+    WatchResult results[16];
+    ssize_t size;
+
+    // Records are written whole and read in multiples of their size
+    while((size = read(watchInfo->result_pipe[0], results, sizeof(results))) > 0)
+    {
+        for(int i = 0; i < size / (ssize_t)sizeof(WatchResult); i++)
+        {
+            WatchResult *result = &results[i];
+            printf("%-8s %12.3f %6d  %s\n", result->status == e_success ? "ok" : "FAILED",
+                   result->elapsed_us / 1000.0, result->worker, result->name);
+            watchInfo->ok += result->status == e_success;
+            watchInfo->failed += result->status != e_success;
+            watchInfo->interval_jobs++;
+            watchInfo->interval_bytes += result->bytes;
+            remove_watch_entry(watchInfo, result->name);
+        }
+    }
+    fflush(stdout);
+}
+
+// Function to reap exited workers, the job of a crashed one fails and the worker is forked again
+static void reap_watch_workers(WatchInfo *watchInfo, int restart)
+{
+    int status;
+    pid_t pid;
+
+    while((pid = waitpid(-1, &status, WNOHANG)) > 0)
+    {
+        int w = 0;
+        while(w < watchInfo->workers && watchInfo->pids[w] != pid)
+        {
+            w++;
+        }
+        if(w == watchInfo->workers)
+        {
+            continue;
+        }
+        watchInfo->running_workers--;
+        watchInfo->pids[w] = 0;
+        if(WIFEXITED(status) && WEXITSTATUS(status) == 0)
+        {
+            continue;
+        }
+
+        // The inputs of the lost job go to the failed directory, the output was never renamed
+        char *name = watchInfo->shared->current[w];
+        if(name[0])
+        {
+            printf("%-8s %12.3f %6d  %s\n", "CRASHED", 0.0, w, name);
+            move_watch_input(watchInfo, name, ".bmp", e_failure);
+            if(!watchInfo->decode)
+            {
+                move_watch_input(watchInfo, name, ".txt", e_failure);
+            }
+            watchInfo->crashed++;
+            remove_watch_entry(watchInfo, name);
+            name[0] = '\0';
+        }
+        if(restart && start_watch_worker(watchInfo, w) == e_success)
+        {
+            watchInfo->restarts++;
+        }
+    }
+}
+
+// Function to hand queued jobs to the workers, up to WATCH_PIPELINE_DEPTH per worker
+static void dispatch_watch_jobs(WatchInfo *watchInfo)
+{
+    char fname[PATH_MAX];
+
+    while(watchInfo->queue_head && watchInfo->in_flight < watchInfo->workers * WATCH_PIPELINE_DEPTH)
+    {
+        WatchEntry *entry = watchInfo->queue_head;
+        watchInfo->queue_head = entry->queue_next;
+        if(watchInfo->queue_head == NULL)
+        {
+            watchInfo->queue_tail = NULL;
+        }
+        if(write(watchInfo->job_pipe[1], entry->name, sizeof(entry->name)) != sizeof(entry->name))
+        {
+            perror("write");
+            return;
+        }
+        entry->state = WATCH_RUNNING;
+        watchInfo->queued--;
+        watchInfo->in_flight++;
+
+        // Start reading the inputs while the job waits in the pipe
+        for(int i = 0; i < (watchInfo->decode ? 1 : 2); i++)
+        {
+            snprintf(fname, sizeof(fname), "%s/%s%s", watchInfo->spool_dir, entry->name, i ? ".txt" : ".bmp");
+            int fd = open(fname, O_RDONLY);
+            if(fd >= 0)
+            {
+                posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+                close(fd);
+            }
+        }
+    }
+}
+
+// Function to print the backlog depth and the throughput since the last report
+static void print_watch_report(WatchInfo *watchInfo)
+{
+    double seconds = get_watch_elapsed_us(&watchInfo->last_report) / 1000000.0;
+
+    printf("INFO: Backlog %d (%d waiting for a pair, %d queued, %d in the workers), %d jobs in %.1f s, %.2f jobs/s, %.2f MB/s.\n",
+           watchInfo->waiting + watchInfo->queued + watchInfo->in_flight, watchInfo->waiting, watchInfo->queued,
+           watchInfo->in_flight, watchInfo->interval_jobs, seconds, watchInfo->interval_jobs / seconds,
+           watchInfo->interval_bytes / seconds / (1024 * 1024));
+    fflush(stdout);
+    clock_gettime(CLOCK_MONOTONIC, &watchInfo->last_report);
+    watchInfo->interval_jobs = 0;
+    watchInfo->interval_bytes = 0;
+}
+
+// Function to read the inotify events, every complete file is handed to add_watch_file()
+static void read_watch_events(WatchInfo *watchInfo)
+{
+    char buffer[64 * 1024] __attribute__((aligned(__alignof__(struct inotify_event))));
+    ssize_t size;
+
+    while((size = read(watchInfo->inotify_fd, buffer, sizeof(buffer))) > 0)
+    {
+        for(char *ptr = buffer; ptr < buffer + size; ptr += sizeof(struct inotify_event) + ((struct inotify_event *)ptr)->len)
+        {
+            struct inotify_event *event = (struct inotify_event *)ptr;
+            if(event->mask & IN_Q_OVERFLOW)
+            {
+                printf("INFO: The inotify queue overflowed, some files are only picked up at the next start!\n");
+            }
+            else if(event->len > 0 && !(event->mask & IN_ISDIR))
+            {
+                add_watch_file(watchInfo, event->name);
+            }
+        }
+    }
+}
+
+// Function to stop at the next loop
+static void handle_watch_signal(int signo)
+{
+    (void)signo;
+    watch_stop = 1;
+}
+
+// Function to watch the spool until SIGINT/SIGTERM
+Status do_watching(WatchInfo *watchInfo)
+{
+    char dname[PATH_MAX];
+    struct sigaction action;
+
+    // STEP1: done and failed directories for the inputs
+    for(int i = 0; i < 2; i++)
+    {
+        snprintf(dname, sizeof(dname), "%s/%s", watchInfo->spool_dir, i ? WATCH_FAILED_DIR : WATCH_DONE_DIR);
+        if(mkdir(dname, 0777) != 0 && errno != EEXIST)
+        {
+            perror("mkdir");
+            return e_failure;
+        }
+    }
+
+    // STEP2: Watch before the scan, a file landing in between is only seen twice
+    watchInfo->inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if(watchInfo->inotify_fd < 0 ||
+       inotify_add_watch(watchInfo->inotify_fd, watchInfo->spool_dir, IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+    {
+        perror("inotify");
+        return e_failure;
+    }
+    DIR *dir = opendir(watchInfo->spool_dir);
+    if(dir == NULL)
+    {
+        perror("opendir");
+        return e_failure;
+    }
+    for(struct dirent *dirent = readdir(dir); dirent; dirent = readdir(dir))
+    {
+        if(dirent->d_type == DT_REG || dirent->d_type == DT_UNKNOWN)
+        {
+            add_watch_file(watchInfo, dirent->d_name);
+        }
+    }
+    closedir(dir);
+
+    // STEP3: Job and result pipes, shared memory for the job of each worker
+    watchInfo->shared = mmap(NULL, sizeof(WatchShared), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if(watchInfo->shared == MAP_FAILED || pipe(watchInfo->job_pipe) != 0 || pipe(watchInfo->result_pipe) != 0)
+    {
+        perror("pipe");
+        return e_failure;
+    }
+    fcntl(watchInfo->result_pipe[0], F_SETFL, O_NONBLOCK);
+
+    // STEP4: Stop on SIGINT/SIGTERM, not restarted so poll() returns
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = handle_watch_signal;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+
+    // STEP5: Fork the workers
+    for(int w = 0; w < watchInfo->workers; w++)
+    {
+        start_watch_worker(watchInfo, w);
+    }
+    printf("INFO: Watching %s on %d workers, %s into %s.\n\n", watchInfo->spool_dir, watchInfo->workers,
+           watchInfo->decode ? "decoding" : "encoding", watchInfo->output_dir);
+    printf("%-8s %12s %6s  %s\n", "STATUS", "TIME_MS", "WORKER", "JOB");
+    clock_gettime(CLOCK_MONOTONIC, &watchInfo->last_report);
+
+    // STEP6: Events -> backlog -> job pipe, results back, a report every WATCH_REPORT_INTERVAL seconds with activity
+    while(!watch_stop && watchInfo->running_workers > 0)
+    {
+        struct pollfd fds[2] = { { watchInfo->inotify_fd, POLLIN, 0 }, { watchInfo->result_pipe[0], POLLIN, 0 } };
+        poll(fds, 2, 1000);
+        read_watch_events(watchInfo);
+        read_watch_results(watchInfo);
+        reap_watch_workers(watchInfo, 1);
+        dispatch_watch_jobs(watchInfo);
+        if(get_watch_elapsed_us(&watchInfo->last_report) >= WATCH_REPORT_INTERVAL * 1000000L &&
+           (watchInfo->interval_jobs || watchInfo->waiting || watchInfo->queued || watchInfo->in_flight))
+        {
+            print_watch_report(watchInfo);
+        }
+    }
+
+    // STEP7: No more jobs, the workers finish the pipe and exit
+    close(watchInfo->job_pipe[1]);
+    watchInfo->job_pipe[1] = -1;
+    printf("INFO: Stopping, %d jobs in the workers are finished first.\n", watchInfo->in_flight);
+    while(watchInfo->running_workers > 0)
+    {
+        struct pollfd fds = { watchInfo->result_pipe[0], POLLIN, 0 };
+        poll(&fds, 1, 100);
+        read_watch_results(watchInfo);
+        reap_watch_workers(watchInfo, 0);
+    }
+    read_watch_results(watchInfo);
+    print_watch_report(watchInfo);
+    printf("INFO: %d jobs succeeded, %d failed, %d crashed, %d workers restarted, %d jobs left in the spool.\n",
+           watchInfo->ok, watchInfo->failed, watchInfo->crashed, watchInfo->restarts, watchInfo->waiting + watchInfo->queued);
+    return watchInfo->failed + watchInfo->crashed == 0 ? e_success : e_failure;
+}
+
+// Function to free entries, close descriptors and unmap shared memory
+void clear_watch_info(WatchInfo *watchInfo)
+{
+    while(watchInfo->entries)
+    {
+        WatchEntry *next = watchInfo->entries->next;
+        free(watchInfo->entries);
+        watchInfo->entries = next;
+    }
+    if(watchInfo->inotify_fd > 0) close(watchInfo->inotify_fd);
+    for(int i = 0; i < 2; i++)
+    {
+        if(watchInfo->job_pipe[i] > 0) close(watchInfo->job_pipe[i]);
+        if(watchInfo->result_pipe[i] > 0) close(watchInfo->result_pipe[i]);
+    }
+    if(watchInfo->shared && watchInfo->shared != MAP_FAILED) munmap(watchInfo->shared, sizeof(WatchShared));
+}
@@ -0,0 +1,123 @@
+#ifndef WATCH_H
+#define WATCH_H
+
+#include <sys/types.h>
+#include <time.h>
+#include "types.h" // Contains user defined types
+
+/*
+ * Structure to store information required for
+ * watching a spool directory and encoding/decoding every file that lands in it
+ *
+ * Encode (default): a job is a carrier name.bmp and a secret name.txt,
+ * it starts once both are complete, the output is output_dir/name.bmp.
+ * Decode (--decode): a job is every name.bmp, the output is
+ * output_dir/name plus the decoded extension.
+ *
+ * A file is complete when inotify reports it closed after writing or
+ * moved into the spool, files already there at start count as complete
+ * and names starting with '.' are skipped (upstream temporaries).
+ *
+ * Pipeline: the coordinator turns events into jobs and keeps the backlog,
+ * a job pipe holds up to WATCH_PIPELINE_DEPTH jobs per worker so a worker
+ * never waits for the next one, and forked workers (same core and memory
+ * pool as the runner, see runner.h) write each output to a temporary
+ * name in output_dir and rename it into place. The inputs are then moved
+ * to spool_dir/done or spool_dir/failed. The coordinator prints a status
+ * line per job and every WATCH_REPORT_INTERVAL seconds the backlog depth
+ * and the throughput. SIGINT/SIGTERM stop taking files, the jobs already
+ * in the pipe are finished
+ */
+
+#define WATCH_MAX_WORKERS 64
+#define WATCH_MAX_NAME 256              // Longest name stem
+#define WATCH_PIPELINE_DEPTH 2          // Jobs in flight per worker: one running, one waiting in the pipe
+#define WATCH_REPORT_INTERVAL 10        // Seconds between backlog reports
+#define WATCH_DONE_DIR "done"
+#define WATCH_FAILED_DIR "failed"
+
+/* Job state */
+#define WATCH_WAITING 0                 // Waiting for the other file of the pair
+#define WATCH_QUEUED 1                  // In the backlog
+#define WATCH_RUNNING 2                 // In the job pipe or in a worker
+
+typedef struct _WatchEntry
+{
+    char name[WATCH_MAX_NAME];  // Name stem
+    int has_carrier;            // name.bmp complete
+    int has_secret;             // name.txt complete
+    int state;
+    struct _WatchEntry *next;           // All entries
+    struct _WatchEntry *queue_next;     // Backlog order
+
+} WatchEntry;
+
+/* Worker to coordinator, one per job */
+typedef struct _WatchResult
+{
+    int status;                 // e_success or e_failure
+    int worker;
+    long elapsed_us;            // Job wall time
+    long bytes;                 // Input bytes of the job
+    char name[WATCH_MAX_NAME];
+
+} WatchResult;
+
+/* Lives in shared memory, written by every worker */
+typedef struct _WatchShared
+{
+    char current[WATCH_MAX_WORKERS][WATCH_MAX_NAME];   // Job being run by each worker, "" if none
+
+} WatchShared;
+
+typedef struct _WatchInfo
+{
+    /* Directories */
+    char *spool_dir;
+    char *output_dir;
+    int decode;                 // --decode
+
+    /* Worker Info */
+    int workers;
+    pid_t pids[WATCH_MAX_WORKERS];
+    int running_workers;
+    int restarts;               // Workers forked again after a crash
+
+    /* Descriptors and shared memory */
+    int inotify_fd;
+    int job_pipe[2];            // Name stems to the workers
+    int result_pipe[2];         // WatchResult records back
+    WatchShared *shared;
+
+    /* Jobs */
+    WatchEntry *entries;
+    WatchEntry *queue_head, *queue_tail;
+    int waiting, queued, in_flight;
+    int ok, failed, crashed;
+
+    /* Throughput since the last report */
+    struct timespec last_report;
+    int interval_jobs;
+    long interval_bytes;
+
+} WatchInfo;  // Datatype of the structure
+
+
+/* Watch function prototype */
+
+/* Read and validate watch args from argv */
+Status read_and_validate_watch_args(int argc, char *argv[], WatchInfo *watchInfo);
+
+/* Note a complete file of the spool, queues the job once all its files are there */
+void add_watch_file(WatchInfo *watchInfo, const char *fname);
+
+/* Run one job with the encode/decode core, output renamed into place and inputs moved */
+Status run_watch_job(WatchInfo *watchInfo, const char *name, long *bytes);
+
+/* Watch the spool until SIGINT/SIGTERM */
+Status do_watching(WatchInfo *watchInfo);
+
+/* Free entries, close descriptors and unmap shared memory */
+void clear_watch_info(WatchInfo *watchInfo);
+
+#endif